@@ -0,0 +1,131 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_AFFINEACCESS_H
+#define BOOST_AFFINEACCESS_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "IR.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * sum(coef[l] * loop l) + constant over the loops enclosing a statement,
+ * affine is false when the subscript is not of that form (div, mod,
+ * products of indices, loads ...)
+ */ 
+struct AffineExpr {
+    bool affine = false;
+    std::vector<int64_t> coef;
+    int64_t constant = 0;
+};
+
+
+/**
+ * affine form of e over the named loops
+ */ 
+AffineExpr affine_form(const Expr &e, const std::vector<std::string> &loops);
+
+
+/**
+ * one Var access of a Move, its subscripts form the coefficient matrix
+ * (one row per dimension, one column per loop)
+ */ 
+struct Access {
+    Expr var;
+    bool is_write;
+    std::vector<AffineExpr> subscripts;
+
+    bool affine() const;
+
+    const std::string &name() const {
+        return var.as<Var>()->name;
+    }
+
+    /**
+     * distance in elements between consecutive iterations of loop l,
+     * row-major. Only meaningful for affine accesses
+     */ 
+    int64_t stride(size_t loop) const;
+
+    /**
+     * no subscript depends on loop l
+     */ 
+    bool invariant(size_t loop) const;
+};
+
+
+/**
+ * a Move with the loops around it, outermost first
+ */ 
+struct Loop {
+    std::string name;
+    Expr index;
+    int64_t begin;
+    int64_t extent;     /* -1 when not constant */
+    Stmt nest;          /* the LoopNest, indices are shared across nests */
+};
+
+
+struct StmtAccesses {
+    Stmt move;          /* a Move or a Reduce */
+    std::vector<Loop> loops;
+    std::vector<Access> accesses;
+
+    /**
+     * innermost loop with stride +-1 for the access, -1 if there is none
+     */ 
+    int unit_stride_loop(size_t access) const;
+
+    /**
+     * iterations of the statement between two uses of the same element
+     * carried by loop l, i.e. the trip count of the loops inside l;
+     * -1 when the access does not reuse across l or a trip count is unknown
+     */ 
+    int64_t reuse_distance(size_t access, size_t loop) const;
+
+    void dump(std::ostream &out) const;
+};
+
+
+/**
+ * collect the accesses of every Move and Reduce in the kernel, in program order
+ */ 
+std::vector<StmtAccesses> analyze_accesses(const Group &kernel);
+
+std::vector<StmtAccesses> analyze_accesses(const Stmt &stmt);
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_AFFINEACCESS_H
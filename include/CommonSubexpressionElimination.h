@@ -0,0 +1,79 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_COMMONSUBEXPRESSIONELIMINATION_H
+#define BOOST_COMMONSUBEXPRESSIONELIMINATION_H
+
+#include <set>
+#include <string>
+
+#include "IRMutator.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * evaluates each distinct subexpression of a statement once per
+ * iteration: value terms and subscript arithmetic that a Move or Reduce
+ * (its source and the subscripts of its destination) computes more than
+ * once are bound to locals declared right before it
+ * (MemToLocal moves). Add, Mul, And and Or match with their operands
+ * swapped, so dB * A + A * dB becomes `float cse0 = dB * A;` and
+ * cse0 + cse0. Only int and float values, scalars or vectors, are bound
+ */ 
+class CommonSubexpressionElimination : public IRMutator {
+ public:
+    const char *name() const override {
+        return "CommonSubexpressionElimination";
+    }
+
+    Group visit(Ref<const Kernel>) override;
+    Stmt visit(Ref<const LoopNest>) override;
+    Stmt visit(Ref<const If>) override;
+
+    /**
+     * a fresh local of type t
+     */ 
+    Expr make_temp(Type t);
+
+ private:
+    /* names in use, temporaries are named apart from them */
+    std::set<std::string> taken;
+    int next_temp = 0;
+
+    /**
+     * the statement with its temporaries first, stmt alone when nothing repeats
+     */ 
+    std::vector<Stmt> eliminate(const Stmt &stmt);
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_COMMONSUBEXPRESSIONELIMINATION_H
@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_COMPILECACHE_H
+#define BOOST_COMPILECACHE_H
+
+#include <string>
+
+#include "IR.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * write content to path only when the file does not already hold it,
+ * so that unchanged outputs keep their timestamps.
+ * return true when the file was (re)written
+ */ 
+bool write_if_changed(const std::string &path, const std::string &content);
+
+
+/**
+ * on-disk cache of generated kernel sources.
+ * 
+ * An entry is keyed by the structural hash of the kernel IR before any
+ * pass runs, the options string describing the passes and the code
+ * generator, and the cache format version. The entry also holds the
+ * options and the serialized IR, compared on a hit so that a key
+ * collision or a stale entry is a miss. Bump the options whenever the
+ * generated code of an unchanged kernel may change.
+ */ 
+class CompileCache {
+ public:
+    static const uint32_t format_version = 2;
+
+    explicit CompileCache(const std::string &_dir, const std::string &_options = "");
+
+    uint64_t key(const Group &kernel) const;
+
+    /**
+     * fill code and return true on a hit,
+     * kernel is the IR before any pass runs
+     */ 
+    bool lookup(const Group &kernel, std::string &code);
+
+    void store(const Group &kernel, const std::string &code);
+
+    /**
+     * drop an entry, return false if there was none
+     */ 
+    bool erase(uint64_t key);
+
+    /**
+     * note that path holds the cached code of kernel, see output_is_current
+     */ 
+    void record_output(const std::string &path, const Group &kernel);
+
+    /**
+     * whether path still holds what record_output noted, with these options
+     * and with the entry it came from still in the cache. A clean step
+     * leaves such a file alone, as the next run writes it unchanged
+     */ 
+    bool output_is_current(const std::string &path) const;
+
+    /**
+     * drop the record of an output, return false if there was none
+     */ 
+    bool erase_output(const std::string &path);
+
+    size_t hits() const {
+        return hits_;
+    }
+
+    size_t misses() const {
+        return misses_;
+    }
+
+    /**
+     * "kernel cache: h hits, m misses"
+     */ 
+    std::string report() const;
+
+ private:
+    std::string dir_;
+    std::string options_;
+    size_t hits_;
+    size_t misses_;
+
+    std::string entry_path(uint64_t key) const;
+    std::string output_path(const std::string &path) const;
+};
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_COMPILECACHE_H
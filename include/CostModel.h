@@ -0,0 +1,132 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_COSTMODEL_H
+#define BOOST_COSTMODEL_H
+
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "AffineAccess.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * a data (or unified) cache, level 1 is closest to the core
+ */ 
+struct CacheLevel {
+    int level;
+    int64_t size;
+    int64_t line;
+};
+
+
+/**
+ * data caches of cpu0 from /sys/devices/system/cpu, innermost first;
+ * 32K / 1M / 32M with 64 byte lines when it cannot be read
+ */ 
+std::vector<CacheLevel> host_caches();
+
+
+/**
+ * how a statement's loops are run: order[l] is the original loop at
+ * level l, outermost first. tiles[loop] > 0 strip-mines that loop; its
+ * tile loop stays at its place in order and its point loop goes inside
+ * all tile loops, in the same relative order
+ */ 
+struct LoopSchedule {
+    std::vector<size_t> order;
+    std::vector<int64_t> tiles;
+};
+
+
+/**
+ * nanoseconds charged per access and per miss of each cache level
+ * (the latency of the level behind it). Rough defaults for a desktop
+ * core, prefetching is not modelled
+ */ 
+struct CostParams {
+    double access_ns = 0.3;
+    std::vector<double> miss_ns = {1.5, 5.0, 20.0};
+};
+
+
+struct CostEstimate {
+    /* bytes touched by the loops from each level inward, footprint[0] is the whole nest */
+    std::vector<int64_t> footprint;
+    /* misses per cache level, innermost first */
+    std::vector<double> misses;
+    double iterations = 0;
+    double time_ns = 0;
+
+    void dump(std::ostream &out) const;
+};
+
+
+/**
+ * analytical working set model: the loops from level l inward touch, per
+ * access, the product over dimensions of the rows its subscript spans,
+ * the last dimension counted in cache lines. A cache keeps the data of
+ * the outermost level whose footprint fits, so every access misses once
+ * per line of that footprint and per iteration of the loops outside it.
+ * Non-affine dimensions count their whole extent.
+ */ 
+class CostModel {
+ public:
+    explicit CostModel(std::vector<CacheLevel> _caches = host_caches(), CostParams _params = CostParams()) :
+        caches(_caches), params(_params) {}
+
+    const std::vector<CacheLevel> &cache_levels() const {
+        return caches;
+    }
+
+    const CostParams &cost_params() const {
+        return params;
+    }
+
+    CostEstimate estimate(const StmtAccesses &stmt, const LoopSchedule &schedule) const;
+
+    /**
+     * the cheapest loop order (untiled) among the permutations legal
+     * accepts, the original order when none is cheaper
+     */ 
+    std::vector<size_t> best_order(const StmtAccesses &stmt,
+        std::function<bool(const std::vector<size_t>&)> legal = nullptr) const;
+
+ private:
+    std::vector<CacheLevel> caches;
+    CostParams params;
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_COSTMODEL_H
@@ -0,0 +1,127 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_DEPENDENCE_H
+#define BOOST_DEPENDENCE_H
+
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "AffineAccess.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * order of the source iteration relative to the sink iteration on a loop
+ */ 
+enum class Direction : uint8_t {
+    Less,       /* source runs in an earlier iteration */
+    Equal,
+    Greater,
+    Any         /* not refined, only used while testing */
+};
+
+
+enum class DependenceType : uint8_t {
+    Flow,       /* write then read */
+    Anti,       /* read then write */
+    Output      /* write then write */
+};
+
+
+/**
+ * the source access must run before the sink access.
+ * direction and distance have one entry per loop common to both
+ * statements, outermost first; distance is sink minus source iteration
+ */ 
+struct Dependence {
+    static const int64_t unknown_distance = std::numeric_limits<int64_t>::min();
+
+    size_t src_stmt;
+    size_t src_access;
+    size_t dst_stmt;
+    size_t dst_access;
+    DependenceType type;
+    std::vector<Direction> direction;
+    std::vector<int64_t> distance;
+
+    /**
+     * the common loop level carrying it, -1 when loop independent
+     */ 
+    int carrier() const;
+};
+
+
+/**
+ * dependences between all accesses of the statements, with at least one
+ * write and the same array. Subscripts are tested dimension by dimension
+ * with the GCD test and the Banerjee inequalities, evaluated on the
+ * vertices of the iteration region of each direction; direction vectors
+ * are refined loop by loop. Non-affine subscripts are assumed dependent.
+ */ 
+std::vector<Dependence> analyze_dependences(const std::vector<StmtAccesses> &stmts);
+
+
+/**
+ * whether a loop of statement stmt can run its iterations in parallel:
+ * no dependence between statements inside it is carried by it
+ */ 
+bool is_parallel(const std::vector<Dependence> &deps, const std::vector<StmtAccesses> &stmts,
+    size_t stmt, size_t loop);
+
+/**
+ * whether reordering the outermost perm.size() common loops of each
+ * dependence by perm (new level l runs old loop perm[l]) keeps every
+ * dependence lexicographically positive. The directions of common loops
+ * inside them follow in their order, so statements of loops nested in
+ * the permuted ones count; dependences with fewer common loops than
+ * perm permutes are not affected
+ */ 
+bool is_permutation_legal(const std::vector<Dependence> &deps, const std::vector<size_t> &perm);
+
+/**
+ * whether the outermost loop after the legal reordering perm, old loop
+ * perm[0], carries no dependence, so it can run its iterations in parallel
+ */ 
+bool is_outer_parallel(const std::vector<Dependence> &deps, const std::vector<size_t> &perm);
+
+/**
+ * no dependence between the two statements, so they can be reordered
+ * or their nests fused
+ */ 
+bool are_independent(const std::vector<Dependence> &deps, size_t stmt_a, size_t stmt_b);
+
+std::ostream &operator<<(std::ostream &out, const Dependence &dep);
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_DEPENDENCE_H
@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_FLATEXPR_H
+#define BOOST_FLATEXPR_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "IR.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+enum class FlatOp : uint8_t {
+    Const,  /* args[0] indexes the constant pool */
+    Index,  /* args[0] indexes the leaf table, an Index node */
+    Leaf,   /* args[0] indexes the leaf table, any other Expr kept opaque */
+    Neg,
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Mod,
+    And,
+    Or
+};
+
+
+/**
+ * contiguous post-order encoding of integer index expressions.
+ * 
+ * Slot s holds ops[s], flags[s] (Binary::bracket), type_ids[s] and two
+ * operands args[2 * s], args[2 * s + 1]. Operands of an operator are
+ * slots before it, so one forward pass over the arrays evaluates every
+ * expression. Subexpressions added twice share a slot.
+ * 
+ * Integer constants live in the constant pool; Index nodes and anything
+ * that is not integer arithmetic (Var, Call, Select, ...) go to the leaf
+ * table and come back unchanged from to_expr.
+ */ 
+class FlatExpr {
+ public:
+    std::vector<FlatOp> ops;
+    std::vector<uint8_t> flags;
+    std::vector<uint8_t> type_ids;
+    std::vector<uint32_t> args;
+    std::vector<int64_t> constants;
+    std::vector<Expr> leaves;
+    std::vector<Type> types;
+
+    FlatExpr() {}
+
+    explicit FlatExpr(const Expr &expr) {
+        add(expr);
+    }
+
+    size_t size() const {
+        return ops.size();
+    }
+
+    /**
+     * append expr, return the slot of its root
+     */ 
+    uint32_t add(const Expr &expr);
+
+    /**
+     * rebuild the expression rooted at slot
+     */ 
+    Expr to_expr(uint32_t slot) const;
+
+    /**
+     * evaluate every slot given one value per leaf, results go to values.
+     * Div and Mod truncate like the generated C code
+     */ 
+    void evaluate(const std::vector<int64_t> &leaf_values, std::vector<int64_t> &values) const;
+
+ private:
+    // keeps the added trees alive, slot_of is keyed by their addresses
+    std::vector<Expr> roots;
+    std::unordered_map<const ExprNode*, uint32_t> slot_of;
+
+    uint32_t push(FlatOp op, const Type &t, uint32_t a, uint32_t b, bool bracket = false);
+
+    uint32_t type_id(const Type &t);
+
+    uint32_t add_leaf(FlatOp op, const Expr &expr);
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_FLATEXPR_H
@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_GUARDELIMINATION_H
+#define BOOST_GUARDELIMINATION_H
+
+#include "IRMutator.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * removes the bounds guards Parse::buildIfStmt puts around a statement,
+ * `if (e0 < c0 && e1 < c1 ...)` as the only body of a LoopNest.
+ * 
+ * With the ranges from Arith::Bounds each conjunct is
+ * - dropped when it holds over the whole iteration space,
+ * - turned into a smaller loop extent (clamping) when past some value
+ *   of a loop index it never holds,
+ * - used to split the loop (index-set splitting) into a steady part
+ *   where it always holds and a peeled boundary part that keeps it.
+ * Only conjuncts affine in a loop index with a positive coefficient are
+ * clamped or split, everything else stays in the guard.
+ */ 
+class GuardElimination : public IRMutator {
+ public:
+    GuardElimination() : IRMutator(true) {}
+
+    const char *name() const override {
+        return "GuardElimination";
+    }
+
+    Stmt visit(Ref<const LoopNest>) override;
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_GUARDELIMINATION_H
@@ -71,7 +71,7 @@ class Ref {
     template<typename U, typename std::enable_if<std::is_base_of<T, U>::value>::type* = nullptr>
     Ref(std::shared_ptr<U> _ptr) : ptr(_ptr) {}
 
-    bool defined() { return ptr != nullptr; }
+    bool defined() const { return ptr != nullptr; }
 
     T *get() const { return ptr.get(); }
 
@@ -117,6 +117,7 @@ enum class IRNodeType : short {
     IfThenElse,
     If,
     Move,
+    Reduce,
     // Exprs
     Unary,
     Binary,
@@ -135,6 +136,16 @@ enum class IRNodeType : short {
 };
 
 
+/**
+ * node allocation hooks, the counters behind them are read through IRStats
+ */ 
+struct IRNodeCounter {
+    static bool enabled;
+    static void created(IRNodeType type);
+    static void destroyed(IRNodeType type);
+};
+
+
 /**
  * forward declaration
  */
@@ -150,7 +161,18 @@ class Group;
  */ 
 class IRNode {
  public:
-    IRNode(const IRNodeType _type) : _node_type(_type) {}
+    IRNode(const IRNodeType _type) : _node_type(_type), _counted(IRNodeCounter::enabled),
+        _hash(static_cast<uint64_t>(_type)) {
+        if (_counted) {
+            IRNodeCounter::created(_type);
+        }
+    }
+
+    ~IRNode() {
+        if (_counted) {
+            IRNodeCounter::destroyed(_node_type);
+        }
+    }
 
     IRNodeType node_type() const {
         return this->_node_type;
@@ -161,11 +183,43 @@ class IRNode {
      */ 
     virtual void visit_node(IRVisitor *visitor) const = 0;
 
+    /**
+     * structural hash, computed once from the fields and the children's
+     * hashes when the node is constructed, see IREquality.h
+     */ 
+    uint64_t structural_hash() const {
+        return this->_hash;
+    }
+
+ protected:
+    void mix_hash(uint64_t value) {
+        this->_hash = hash_combine(this->_hash, value);
+    }
+
+    template <typename T>
+    void mix_hash(const Ref<T> &child) {
+        mix_hash(child.get() == nullptr ? 0 : child.get()->structural_hash());
+    }
+
+    template <typename T>
+    void mix_hash(const std::vector<T> &children) {
+        mix_hash(static_cast<uint64_t>(children.size()));
+        for (auto &child : children) {
+            mix_hash(child);
+        }
+    }
+
  private:
     /**
      * indicate the concrete type of this IR node
      */ 
     IRNodeType _node_type;
+    /**
+     * whether the node was counted on creation, so that enabling the
+     * counters midway never makes a live count negative
+     */ 
+    bool _counted;
+    uint64_t _hash;
 };
 
 
@@ -176,13 +230,15 @@ class ExprNode : public IRNode {
  private:
     Type type_;
  public:
-    ExprNode(Type _type, const IRNodeType node_type) : IRNode(node_type), type_(_type) {} 
+    ExprNode(Type _type, const IRNodeType node_type) : IRNode(node_type), type_(_type) {
+        mix_hash(_type.hash());
+    }
 
     virtual ~ExprNode() = default;
 
     virtual Expr mutate_expr(IRMutator *mutator) const = 0;
 
-    Type type() const {
+    const Type &type() const {
         return type_;
     }
 };
@@ -225,7 +281,9 @@ class IntImm : public ExprNode, public std::enable_shared_from_this<IntImm> {
  private:
     int64_t value_;
  public:
-    IntImm(Type _type, const int64_t _value) : ExprNode(_type, IRNodeType::IntImm), value_(_value)  {}
+    IntImm(Type _type, const int64_t _value) : ExprNode(_type, IRNodeType::IntImm), value_(_value)  {
+        mix_hash(static_cast<uint64_t>(_value));
+    }
 
     /**
      * May need consider bits
@@ -237,9 +295,7 @@ class IntImm : public ExprNode, public std::enable_shared_from_this<IntImm> {
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
-    static Ref<const IntImm> make(Type t, const int64_t _value) {
-        return std::make_shared<const IntImm>(t, _value);
-    }
+    static Ref<const IntImm> make(Type t, const int64_t _value);
 
     static const IRNodeType node_type_ = IRNodeType::IntImm;
 };
@@ -252,7 +308,9 @@ class UIntImm : public ExprNode, public std::enable_shared_from_this<UIntImm> {
  private:
     uint64_t value_;
  public:
-    UIntImm(Type _type, const uint64_t _value) : ExprNode(_type, IRNodeType::UIntImm), value_(_value) {}
+    UIntImm(Type _type, const uint64_t _value) : ExprNode(_type, IRNodeType::UIntImm), value_(_value) {
+        mix_hash(_value);
+    }
 
     /**
      * May need consider bits
@@ -264,9 +322,7 @@ class UIntImm : public ExprNode, public std::enable_shared_from_this<UIntImm> {
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
-    static Ref<const UIntImm> make(Type t, const uint64_t _value) {
-        return std::make_shared<const UIntImm>(t, _value);
-    }
+    static Ref<const UIntImm> make(Type t, const uint64_t _value);
 
     static const IRNodeType node_type_ = IRNodeType::UIntImm;
 };
@@ -279,7 +335,9 @@ class FloatImm : public ExprNode, public std::enable_shared_from_this<FloatImm>
  private:
     double value_;
  public:
-    FloatImm(Type _type, const double _value) : ExprNode(_type, IRNodeType::FloatImm), value_(_value) {}
+    FloatImm(Type _type, const double _value) : ExprNode(_type, IRNodeType::FloatImm), value_(_value) {
+        mix_hash(hash_bytes(&_value, sizeof(_value)));
+    }
 
     /**
      * May need consider bits
@@ -291,9 +349,7 @@ class FloatImm : public ExprNode, public std::enable_shared_from_this<FloatImm>
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
-    static Ref<const FloatImm> make(Type t, const double _value) {
-        return std::make_shared<const FloatImm>(t, _value);
-    }
+    static Ref<const FloatImm> make(Type t, const double _value);
 
     static const IRNodeType node_type_ = IRNodeType::FloatImm;
 };
@@ -307,7 +363,9 @@ class StringImm : public ExprNode, public std::enable_shared_from_this<StringImm
     std::string value_;
  public:
     StringImm(Type _type, const std::string _value) :
-        ExprNode(_type, IRNodeType::StringImm), value_(_value) {}
+        ExprNode(_type, IRNodeType::StringImm), value_(_value) {
+        mix_hash(hash_string(_value));
+    }
 
     std::string value() const {
         return value_;
@@ -316,9 +374,7 @@ class StringImm : public ExprNode, public std::enable_shared_from_this<StringImm
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
-    static Ref<const StringImm> make(Type t, const std::string _value) {
-        return std::make_shared<const StringImm>(t, _value);
-    }
+    static Ref<const StringImm> make(Type t, const std::string _value);
 
     static const IRNodeType node_type_ = IRNodeType::StringImm;
 };
@@ -391,7 +447,7 @@ class Expr : public Ref<const ExprNode> {
         return this->get()->node_type();
     }
 
-    Type type() const {
+    const Type &type() const {
         return this->get()->type();
     }
 
@@ -535,14 +591,15 @@ class Unary : public ExprNode, public std::enable_shared_from_this<Unary> {
     Expr a;
 
     Unary(Type _type, UnaryOpType _op_type, Expr _a) : ExprNode(_type, IRNodeType::Unary),
-        op_type(_op_type), a(_a) {}
+        op_type(_op_type), a(_a) {
+        mix_hash(static_cast<uint64_t>(_op_type));
+        mix_hash(_a);
+    }
 
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
-    static Expr make(Type t, UnaryOpType _op_type, Expr _a) {
-        return std::make_shared<const Unary>(t, _op_type, _a);
-    }
+    static Expr make(Type t, UnaryOpType _op_type, Expr _a);
 
     static const IRNodeType node_type_ = IRNodeType::Unary;
 };
@@ -569,14 +626,17 @@ class Binary : public ExprNode, public std::enable_shared_from_this<Binary> {
     bool bracket; 
 
     Binary(Type _type, BinaryOpType _op_type, Expr _a, Expr _b,bool _bracket) : ExprNode(_type, IRNodeType::Binary),
-        op_type(_op_type), a(_a), b(_b) ,bracket(_bracket){}
+        op_type(_op_type), a(_a), b(_b) ,bracket(_bracket){
+        // bracket only guides printing, it is not part of the structure
+        mix_hash(static_cast<uint64_t>(_op_type));
+        mix_hash(_a);
+        mix_hash(_b);
+    }
 
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
-    static Expr make(Type t, BinaryOpType _op_type, Expr _a, Expr _b,bool _bracket=false) {
-        return std::make_shared<const Binary>(t, _op_type, _a, _b,_bracket);
-    }
+    static Expr make(Type t, BinaryOpType _op_type, Expr _a, Expr _b,bool _bracket=false);
 
     static const IRNodeType node_type_ = IRNodeType::Binary;
 };
@@ -601,14 +661,16 @@ class Compare : public ExprNode, public std::enable_shared_from_this<Compare> {
     Expr a, b;
 
     Compare(Type _type, CompareOpType _op_type, Expr _a, Expr _b) : ExprNode(_type, IRNodeType::Compare),
-        op_type(_op_type), a(_a), b(_b) {}
+        op_type(_op_type), a(_a), b(_b) {
+        mix_hash(static_cast<uint64_t>(_op_type));
+        mix_hash(_a);
+        mix_hash(_b);
+    }
 
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
-    static Expr make(Type t, CompareOpType _op_type, Expr _a, Expr _b) {
-        return std::make_shared<const Compare>(t, _op_type, _a, _b);
-    }
+    static Expr make(Type t, CompareOpType _op_type, Expr _a, Expr _b);
 
     static const IRNodeType node_type_ = IRNodeType::Compare;
 };
@@ -623,14 +685,16 @@ class Select : public ExprNode, public std::enable_shared_from_this<Select> {
     Expr true_value, false_value;
 
     Select(Type _type, Expr _cond, Expr _true_value, Expr _false_value) : ExprNode(_type, IRNodeType::Select),
-        cond(_cond), true_value(_true_value), false_value(_false_value) {}
+        cond(_cond), true_value(_true_value), false_value(_false_value) {
+        mix_hash(_cond);
+        mix_hash(_true_value);
+        mix_hash(_false_value);
+    }
 
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
-    static Expr make(Type t, Expr _cond, Expr _true_value, Expr _false_value) {
-        return std::make_shared<const Select>(t, _cond, _true_value, _false_value);
-    }
+    static Expr make(Type t, Expr _cond, Expr _true_value, Expr _false_value);
 
     static const IRNodeType node_type_ = IRNodeType::Select;
 };
@@ -652,14 +716,16 @@ class Call : public ExprNode, public std::enable_shared_from_this<Call> {
     CallType call_type;
 
     Call(Type _type, const std::vector<Expr> &_args, const std::string &_func_name, CallType _call_type) : ExprNode(_type, IRNodeType::Call),
-        args(_args), func_name(_func_name), call_type(_call_type) {}
+        args(_args), func_name(_func_name), call_type(_call_type) {
+        mix_hash(_args);
+        mix_hash(hash_string(_func_name));
+        mix_hash(static_cast<uint64_t>(_call_type));
+    }
 
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
     
-    static Expr make(Type t, const std::vector<Expr> &_args, const std::string &_func_name, CallType _call_type) {
-        return std::make_shared<const Call>(t, _args, _func_name, _call_type);
-    }
+    static Expr make(Type t, const std::vector<Expr> &_args, const std::string &_func_name, CallType _call_type);
 
     static const IRNodeType node_type_ = IRNodeType::Call;
 };
@@ -674,14 +740,15 @@ class Cast : public ExprNode, public std::enable_shared_from_this<Cast> {
     Expr val;
 
     Cast(Type _type, Type _new_type, Expr _val) : ExprNode(_type, IRNodeType::Cast),
-        new_type(_new_type), val(_val) {}
+        new_type(_new_type), val(_val) {
+        mix_hash(_new_type.hash());
+        mix_hash(_val);
+    }
 
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
-    static Expr make(Type t, Type _new_type, Expr _val) {
-        return std::make_shared<const Cast>(t, _new_type, _val);
-    }
+    static Expr make(Type t, Type _new_type, Expr _val);
 
     static const IRNodeType node_type_ = IRNodeType::Cast;
 };
@@ -698,14 +765,16 @@ class Ramp : public ExprNode, public std::enable_shared_from_this<Ramp> {
     uint16_t lanes;
 
     Ramp(Type _type, Expr _base, uint16_t _stride, uint16_t _lanes) : ExprNode(_type, IRNodeType::Ramp),
-        base(_base), stride(_stride), lanes(_lanes) {}
+        base(_base), stride(_stride), lanes(_lanes) {
+        mix_hash(_base);
+        mix_hash(_stride);
+        mix_hash(_lanes);
+    }
 
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
-    static Expr make(Type t, Expr _base, uint16_t _stride, uint16_t _lanes) {
-        return std::make_shared<const Ramp>(t, _base, _stride, _lanes);
-    }
+    static Expr make(Type t, Expr _base, uint16_t _stride, uint16_t _lanes);
 
     static const IRNodeType node_type_ = IRNodeType::Ramp;
 };
@@ -728,15 +797,19 @@ class Var : public ExprNode, public std::enable_shared_from_this<Var> {
     std::vector<size_t> shape;
     Var(Type _type, const std::string &_name, const std::vector<Expr> &_args,
         const std::vector<size_t> &_shape) : ExprNode(_type, IRNodeType::Var),
-        name(_name), args(_args), shape(_shape) {}
+        name(_name), args(_args), shape(_shape) {
+        mix_hash(hash_string(_name));
+        mix_hash(_args);
+        for (auto extent : _shape) {
+            mix_hash(static_cast<uint64_t>(extent));
+        }
+    }
 
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
     static Expr make(Type t, const std::string &_name, const std::vector<Expr> &_args,
-        const std::vector<size_t> &_shape) {
-        return std::make_shared<const Var>(t, _name, _args, _shape);
-    }
+        const std::vector<size_t> &_shape);
 
     static const IRNodeType node_type_ = IRNodeType::Var;
 };
@@ -750,14 +823,15 @@ class Dom : public ExprNode, public std::enable_shared_from_this<Dom> {
     Expr begin;
     Expr extent;
 
-    Dom(Type _type, Expr _begin, Expr _extent) : ExprNode(_type, IRNodeType::Dom), begin(_begin), extent(_extent) {}
+    Dom(Type _type, Expr _begin, Expr _extent) : ExprNode(_type, IRNodeType::Dom), begin(_begin), extent(_extent) {
+        mix_hash(_begin);
+        mix_hash(_extent);
+    }
 
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
     
-    static Expr make(Type t, Expr _begin, Expr _extent) {
-        return std::make_shared<const Dom>(t, _begin, _extent);
-    }
+    static Expr make(Type t, Expr _begin, Expr _extent);
 
     static const IRNodeType node_type_ = IRNodeType::Dom;
 };
@@ -769,7 +843,8 @@ enum class IndexType : uint8_t {
     Thread,
     Block,
     Vectorized,
-    Unrolled
+    Unrolled,
+    Parallel
 };
 
 
@@ -783,14 +858,16 @@ class Index : public ExprNode, public std::enable_shared_from_this<Index> {
     IndexType index_type;
 
     Index(Type _type, const std::string &_name, Expr _dom, IndexType _index_type) :
-        ExprNode(_type, IRNodeType::Index), name(_name), dom(_dom), index_type(_index_type) {}
+        ExprNode(_type, IRNodeType::Index), name(_name), dom(_dom), index_type(_index_type) {
+        mix_hash(hash_string(_name));
+        mix_hash(_dom);
+        mix_hash(static_cast<uint64_t>(_index_type));
+    }
 
     Expr mutate_expr(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
-    static Expr make(Type t, const std::string &_name, Expr _dom, IndexType _index_type) {
-        return std::make_shared<const Index>(t, _name, _dom, _index_type);
-    }
+    static Expr make(Type t, const std::string &_name, Expr _dom, IndexType _index_type);
 
     static const IRNodeType node_type_ = IRNodeType::Index;
 };
@@ -806,14 +883,15 @@ class LoopNest : public StmtNode, public std::enable_shared_from_this<LoopNest>
     std::vector<Stmt> body_list;
 
     LoopNest(const std::vector<Expr> &_index_list, const std::vector<Stmt> &_body_list) :
-        StmtNode(IRNodeType::LoopNest), index_list(_index_list), body_list(_body_list) {}
+        StmtNode(IRNodeType::LoopNest), index_list(_index_list), body_list(_body_list) {
+        mix_hash(_index_list);
+        mix_hash(_body_list);
+    }
 
     Stmt mutate_stmt(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
 
-    static Stmt make(const std::vector<Expr> &_index_list, const std::vector<Stmt> &_body_list) {
-        return std::make_shared<const LoopNest>(_index_list, _body_list);
-    }
+    static Stmt make(const std::vector<Expr> &_index_list, const std::vector<Stmt> &_body_list);
 
     static const IRNodeType node_type_ = IRNodeType::LoopNest;
 };
@@ -829,14 +907,16 @@ class IfThenElse : public StmtNode, public std::enable_shared_from_this<IfThenEl
     Stmt false_case;
 
     IfThenElse(Expr _cond, Stmt _true_case, Stmt _false_case) :
-        StmtNode(IRNodeType::IfThenElse), cond(_cond), true_case(_true_case), false_case(_false_case) {}
+        StmtNode(IRNodeType::IfThenElse), cond(_cond), true_case(_true_case), false_case(_false_case) {
+        mix_hash(_cond);
+        mix_hash(_true_case);
+        mix_hash(_false_case);
+    }
 
     Stmt mutate_stmt(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
     
-    static Stmt make(Expr _cond, Stmt _true_case, Stmt _false_case) {
-        return std::make_shared<const IfThenElse>(_cond, _true_case, _false_case);
-    }
+    static Stmt make(Expr _cond, Stmt _true_case, Stmt _false_case);
 
     static const IRNodeType node_type_ = IRNodeType::IfThenElse;
 };
@@ -847,14 +927,15 @@ class If : public StmtNode, public std::enable_shared_from_this<If> {
     Stmt true_case;
 
     If(Expr _cond, Stmt _true_case) :
-        StmtNode(IRNodeType::If), cond(_cond), true_case(_true_case) {}
+        StmtNode(IRNodeType::If), cond(_cond), true_case(_true_case) {
+        mix_hash(_cond);
+        mix_hash(_true_case);
+    }
 
     Stmt mutate_stmt(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
     
-    static Stmt make(Expr _cond, Stmt _true_case) {
-        return std::make_shared<const If>(_cond, _true_case);
-    }
+    static Stmt make(Expr _cond, Stmt _true_case);
 
     static const IRNodeType node_type_ = IRNodeType::If;
 };
@@ -879,6 +960,9 @@ enum class MoveType : uint8_t {
 /**
  * assign statement: load and store are put together
  * - evaluate: when dst is nullptr
+ * - MemToMem and the rest accumulate src into dst
+ * - MemToLocal declares the local scalar dst holding src
+ * - LocalToMem stores src to dst
  */ 
 class Move : public StmtNode, public std::enable_shared_from_this<Move> {
  public:
@@ -888,19 +972,57 @@ class Move : public StmtNode, public std::enable_shared_from_this<Move> {
     MoveType move_type;
 
     Move(Expr _dst, Expr _src, MoveType _move_type) :
-        StmtNode(IRNodeType::Move), dst(_dst), src(_src), move_type(_move_type) {}
+        StmtNode(IRNodeType::Move), dst(_dst), src(_src), move_type(_move_type) {
+        mix_hash(_dst);
+        mix_hash(_src);
+        mix_hash(static_cast<uint64_t>(_move_type));
+    }
 
     Stmt mutate_stmt(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
     
-    static Stmt make(Expr _dst, Expr _src, MoveType _move_type) {
-        return std::make_shared<const Move>(_dst, _src, _move_type);
-    }
+    static Stmt make(Expr _dst, Expr _src, MoveType _move_type);
 
     static const IRNodeType node_type_ = IRNodeType::Move;
 };
 
 
+/**
+ * reduction statement: dst = combiner(dst, value) for every iteration of
+ * the reduce axes. dst accumulates onto the value it holds before the
+ * reduction, nothing stores identity into it; identity is the neutral
+ * element of combiner, the starting value of any partial accumulator a
+ * pass splits the reduction into. combiner is Add, Mul, And or Or.
+ * Passes can parallelize or vectorize the axes only as a reduction
+ */ 
+class Reduce : public StmtNode, public std::enable_shared_from_this<Reduce> {
+ public:
+    Expr dst;
+    Expr value;
+    BinaryOpType combiner;
+    Expr identity;
+    std::vector<Expr> axes;
+
+    Reduce(Expr _dst, Expr _value, BinaryOpType _combiner, Expr _identity, const std::vector<Expr> &_axes) :
+        StmtNode(IRNodeType::Reduce), dst(_dst), value(_value), combiner(_combiner),
+        identity(_identity), axes(_axes) {
+        mix_hash(_dst);
+        mix_hash(_value);
+        mix_hash(static_cast<uint64_t>(_combiner));
+        mix_hash(_identity);
+        mix_hash(_axes);
+    }
+
+    Stmt mutate_stmt(IRMutator *mutator) const;
+    void visit_node(IRVisitor *visitor) const;
+
+    static Stmt make(Expr _dst, Expr _value, BinaryOpType _combiner, Expr _identity,
+        const std::vector<Expr> &_axes);
+
+    static const IRNodeType node_type_ = IRNodeType::Reduce;
+};
+
+
 enum class KernelType : uint8_t {
     CPU,
     GPU
@@ -918,15 +1040,19 @@ class Kernel : public GroupNode, public std::enable_shared_from_this<Kernel> {
     Kernel(const std::string &_name, const std::vector<Expr> &_inputs,
         const std::vector<Expr> &_outputs, const std::vector<Stmt> &_stmt_list, KernelType _kernel_type) :
         GroupNode(IRNodeType::Kernel), name(_name), inputs(_inputs), outputs(_outputs),
-        stmt_list(_stmt_list), kernel_type(_kernel_type) {}
+        stmt_list(_stmt_list), kernel_type(_kernel_type) {
+        mix_hash(hash_string(_name));
+        mix_hash(_inputs);
+        mix_hash(_outputs);
+        mix_hash(_stmt_list);
+        mix_hash(static_cast<uint64_t>(_kernel_type));
+    }
 
     Group mutate_group(IRMutator *mutator) const;
     void visit_node(IRVisitor *visitor) const;
     
     static Group make(const std::string &_name, const std::vector<Expr> &_inputs,
-        const std::vector<Expr> &_outputs, const std::vector<Stmt> &_stmt_list, KernelType _kernel_type) {
-        return std::make_shared<const Kernel>(_name, _inputs, _outputs, _stmt_list, _kernel_type);
-    }
+        const std::vector<Expr> &_outputs, const std::vector<Stmt> &_stmt_list, KernelType _kernel_type);
 
     static const IRNodeType node_type_ = IRNodeType::Kernel;
 };
@@ -0,0 +1,254 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_IRCONTEXT_H
+#define BOOST_IRCONTEXT_H
+
+#include <unordered_map>
+
+#include "IR.h"
+#include "IRStats.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * bump allocator, memory is only returned when the arena is destroyed
+ */ 
+class Arena {
+ public:
+    explicit Arena(size_t first_block_size = 4096) : next_block_size_(first_block_size) {}
+
+    Arena(const Arena &) = delete;
+
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t bytes, size_t align) {
+        size_t offset = (used_ + align - 1) & ~(align - 1);
+        if (blocks_.empty() || offset + bytes > capacity_) {
+            // blocks grow geometrically up to 64KB, small compilations stay small
+            capacity_ = bytes + align > next_block_size_ ? bytes + align : next_block_size_;
+            next_block_size_ = next_block_size_ < 64 * 1024 ? next_block_size_ * 2 : next_block_size_;
+            blocks_.emplace_back(new char[capacity_]);
+            reserved_ += capacity_;
+            uintptr_t base = reinterpret_cast<uintptr_t>(blocks_.back().get());
+            offset = ((base + align - 1) & ~(uintptr_t)(align - 1)) - base;
+        }
+        used_ = offset + bytes;
+        live_ += 1;
+        return blocks_.back().get() + offset;
+    }
+
+    void deallocate() {
+        live_ -= 1;
+    }
+
+    /**
+     * allocations not yet handed back by their owners
+     */ 
+    size_t live() const {
+        return live_;
+    }
+
+    size_t reserved_bytes() const {
+        return reserved_;
+    }
+
+ private:
+    size_t next_block_size_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+    size_t live_ = 0;
+    size_t reserved_ = 0;
+};
+
+
+/**
+ * std allocator adaptor, lets std::allocate_shared put a node
+ * and its control block into one arena chunk
+ */ 
+template <typename T>
+class ArenaAllocator {
+ public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena *_arena) : arena(_arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t n) {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, size_t) {
+        arena->deallocate();
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const {
+        return arena == other.arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const {
+        return arena != other.arena;
+    }
+
+    Arena *arena;
+};
+
+
+/**
+ * per-compilation context used by the node factories
+ * - hash consing: structurally equal expressions are built only once,
+ *   so two Exprs made in the same context are equal iff their pointers are
+ * - the context owns every interned node until it is destroyed
+ * - arena: nodes are bump allocated and released together with the context,
+ *   no node built in an arena context may outlive it
+ *
+ * a context is opt-in, factories only consult it while it is entered:
+ *     IRContext ctx;
+ *     {
+ *         IRContext::Scope scope(ctx);
+ *         ... build IR ...
+ *     }
+ */ 
+class IRContext {
+ public:
+    explicit IRContext(bool hash_cons = true, bool use_arena = false) : hash_cons_(hash_cons) {
+        if (use_arena) {
+            arena_.reset(new Arena());
+        }
+    }
+
+    IRContext(const IRContext &) = delete;
+
+    IRContext &operator=(const IRContext &) = delete;
+
+    ~IRContext();
+
+    /**
+     * the context entered by this thread, nullptr if none
+     */ 
+    static IRContext *current();
+
+    class Scope {
+     public:
+        explicit Scope(IRContext &ctx);
+        ~Scope();
+     private:
+        IRContext *prev;
+    };
+
+    /**
+     * find a node structurally equal to the one `build` would create,
+     * `match` compares the fields of a candidate with the factory arguments
+     */ 
+    template <typename T, typename Match, typename Build>
+    std::shared_ptr<const T> intern(uint64_t hash, Match match, Build build) {
+        auto range = table_.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.node_type() == T::node_type_) {
+                std::shared_ptr<const T> node = it->second.as<T>();
+                if (match(*node)) {
+                    reused_nodes_ += 1;
+                    return node;
+                }
+            }
+        }
+        std::shared_ptr<const T> node = build();
+        table_.emplace(hash, Expr(node));
+        return node;
+    }
+
+    void count_allocation(size_t bytes) {
+        allocated_nodes_ += 1;
+        allocated_bytes_ += bytes;
+    }
+
+    bool hash_cons() const {
+        return hash_cons_;
+    }
+
+    Arena *arena() const {
+        return arena_.get();
+    }
+
+    /**
+     * statistics: `allocated` counts nodes created in this context, `reused`
+     * counts factory calls answered from the table. Bytes are sizeof the node,
+     * out-of-line payload (names, arg vectors) is not included
+     */ 
+    size_t reused_nodes() const {
+        return reused_nodes_;
+    }
+
+    size_t allocated_nodes() const {
+        return allocated_nodes_;
+    }
+
+    size_t allocated_bytes() const {
+        return allocated_bytes_;
+    }
+
+ private:
+    bool hash_cons_;
+    std::unique_ptr<Arena> arena_;
+    std::unordered_multimap<uint64_t, Expr> table_;
+    size_t reused_nodes_ = 0;
+    size_t allocated_nodes_ = 0;
+    size_t allocated_bytes_ = 0;
+};
+
+
+
+/**
+ * allocate a node from the arena of the entered context, if there is one
+ */ 
+template <typename T, typename... Args>
+std::shared_ptr<const T> make_node(Args&&... args) {
+    if (IRStats::enabled()) {
+        IRStats::count_bytes(sizeof(T));
+    }
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr) {
+        return std::make_shared<const T>(std::forward<Args>(args)...);
+    }
+    ctx->count_allocation(sizeof(T));
+    if (ctx->arena() != nullptr) {
+        return std::allocate_shared<T>(ArenaAllocator<T>(ctx->arena()), std::forward<Args>(args)...);
+    }
+    return std::make_shared<const T>(std::forward<Args>(args)...);
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_IRCONTEXT_H
@@ -0,0 +1,84 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_IREQUALITY_H
+#define BOOST_IREQUALITY_H
+
+#include "IR.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * structural comparison of two IR trees, two trees are equal when they
+ * have the same node types, fields and types all the way down,
+ * no matter whether they share nodes or not.
+ * Binary::bracket is ignored since it only guides printing
+ */ 
+bool deep_equal(const IRNode *a, const IRNode *b);
+
+inline bool deep_equal(const Expr &a, const Expr &b) {
+    return deep_equal(a.get(), b.get());
+}
+
+inline bool deep_equal(const Stmt &a, const Stmt &b) {
+    return deep_equal(a.get(), b.get());
+}
+
+inline bool deep_equal(const Group &a, const Group &b) {
+    return deep_equal(a.get(), b.get());
+}
+
+
+/**
+ * hash functor for unordered containers keyed by IR,
+ * O(1) since the hash is cached in the node
+ */ 
+struct StructuralHash {
+    template <typename T>
+    size_t operator()(const Ref<T> &ref) const {
+        return ref.get() == nullptr ? 0 : static_cast<size_t>(ref.get()->structural_hash());
+    }
+};
+
+
+/**
+ * equality functor to pair with StructuralHash
+ */ 
+struct StructuralEqual {
+    template <typename T>
+    bool operator()(const Ref<T> &a, const Ref<T> &b) const {
+        return deep_equal(a.get(), b.get());
+    }
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_IREQUALITY_H
@@ -0,0 +1,277 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_IRFUNCTOR_H
+#define BOOST_IRFUNCTOR_H
+
+#include <vector>
+#include <utility>
+
+#include "IR.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * call f(const IRNode*) on each child of node, in the order
+ * IRVisitor visits them
+ */ 
+template <typename F>
+void for_each_child(const IRNode *node, F &&f) {
+    switch (node->node_type()) {
+        case IRNodeType::Kernel: {
+            const Kernel *op = static_cast<const Kernel*>(node);
+            for (auto &expr : op->inputs) f(expr.get());
+            for (auto &expr : op->outputs) f(expr.get());
+            for (auto &stmt : op->stmt_list) f(stmt.get());
+            break;
+        }
+        case IRNodeType::LoopNest: {
+            const LoopNest *op = static_cast<const LoopNest*>(node);
+            for (auto &index : op->index_list) f(index.get());
+            for (auto &body : op->body_list) f(body.get());
+            break;
+        }
+        case IRNodeType::IfThenElse: {
+            const IfThenElse *op = static_cast<const IfThenElse*>(node);
+            f(op->cond.get());
+            f(op->true_case.get());
+            if (op->false_case.get() != nullptr) f(op->false_case.get());
+            break;
+        }
+        case IRNodeType::If: {
+            const If *op = static_cast<const If*>(node);
+            f(op->cond.get());
+            f(op->true_case.get());
+            break;
+        }
+        case IRNodeType::Move: {
+            const Move *op = static_cast<const Move*>(node);
+            f(op->dst.get());
+            f(op->src.get());
+            break;
+        }
+        case IRNodeType::Reduce: {
+            const Reduce *op = static_cast<const Reduce*>(node);
+            f(op->dst.get());
+            f(op->value.get());
+            f(op->identity.get());
+            for (auto &axis : op->axes) f(axis.get());
+            break;
+        }
+        case IRNodeType::Unary:
+            f(static_cast<const Unary*>(node)->a.get());
+            break;
+        case IRNodeType::Binary:
+            f(static_cast<const Binary*>(node)->a.get());
+            f(static_cast<const Binary*>(node)->b.get());
+            break;
+        case IRNodeType::Select: {
+            const Select *op = static_cast<const Select*>(node);
+            f(op->cond.get());
+            f(op->true_value.get());
+            f(op->false_value.get());
+            break;
+        }
+        case IRNodeType::Compare:
+            f(static_cast<const Compare*>(node)->a.get());
+            f(static_cast<const Compare*>(node)->b.get());
+            break;
+        case IRNodeType::Call:
+            for (auto &arg : static_cast<const Call*>(node)->args) f(arg.get());
+            break;
+        case IRNodeType::Var:
+            for (auto &arg : static_cast<const Var*>(node)->args) f(arg.get());
+            break;
+        case IRNodeType::Cast:
+            f(static_cast<const Cast*>(node)->val.get());
+            break;
+        case IRNodeType::Ramp:
+            f(static_cast<const Ramp*>(node)->base.get());
+            break;
+        case IRNodeType::Index:
+            f(static_cast<const Index*>(node)->dom.get());
+            break;
+        case IRNodeType::Dom:
+            f(static_cast<const Dom*>(node)->begin.get());
+            f(static_cast<const Dom*>(node)->extent.get());
+            break;
+        case IRNodeType::IntImm:
+        case IRNodeType::UIntImm:
+        case IRNodeType::FloatImm:
+        case IRNodeType::StringImm:
+            break;
+    }
+}
+
+
+/**
+ * statically dispatched functor, one switch and no refcount traffic per node:
+ *
+ *     class Counter : public IRFunctor<Counter, int> {
+ *      public:
+ *         using IRFunctor<Counter, int>::visit;
+ *         int visit(const Binary &op) { return 1 + (*this)(op.a) + (*this)(op.b); }
+ *         int visit_default(const IRNode &) { return 1; }
+ *     };
+ *
+ * node kinds the derived class does not handle go to visit_default,
+ * the `using` keeps those fallbacks visible next to the derived overloads
+ */ 
+template <typename Derived, typename R>
+class IRFunctor {
+ public:
+    R operator()(const Expr &expr) {
+        return dispatch(expr.get());
+    }
+
+    R operator()(const Stmt &stmt) {
+        return dispatch(stmt.get());
+    }
+
+    R operator()(const Group &group) {
+        return dispatch(group.get());
+    }
+
+    R dispatch(const IRNode *node) {
+        Derived *self = static_cast<Derived*>(this);
+        switch (node->node_type()) {
+            case IRNodeType::Kernel: return self->visit(*static_cast<const Kernel*>(node));
+            case IRNodeType::LoopNest: return self->visit(*static_cast<const LoopNest*>(node));
+            case IRNodeType::IfThenElse: return self->visit(*static_cast<const IfThenElse*>(node));
+            case IRNodeType::If: return self->visit(*static_cast<const If*>(node));
+            case IRNodeType::Move: return self->visit(*static_cast<const Move*>(node));
+            case IRNodeType::Reduce: return self->visit(*static_cast<const Reduce*>(node));
+            case IRNodeType::Unary: return self->visit(*static_cast<const Unary*>(node));
+            case IRNodeType::Binary: return self->visit(*static_cast<const Binary*>(node));
+            case IRNodeType::Select: return self->visit(*static_cast<const Select*>(node));
+            case IRNodeType::Compare: return self->visit(*static_cast<const Compare*>(node));
+            case IRNodeType::Call: return self->visit(*static_cast<const Call*>(node));
+            case IRNodeType::Var: return self->visit(*static_cast<const Var*>(node));
+            case IRNodeType::Cast: return self->visit(*static_cast<const Cast*>(node));
+            case IRNodeType::Ramp: return self->visit(*static_cast<const Ramp*>(node));
+            case IRNodeType::Index: return self->visit(*static_cast<const Index*>(node));
+            case IRNodeType::IntImm: return self->visit(*static_cast<const IntImm*>(node));
+            case IRNodeType::UIntImm: return self->visit(*static_cast<const UIntImm*>(node));
+            case IRNodeType::FloatImm: return self->visit(*static_cast<const FloatImm*>(node));
+            case IRNodeType::StringImm: return self->visit(*static_cast<const StringImm*>(node));
+            case IRNodeType::Dom: return self->visit(*static_cast<const Dom*>(node));
+        }
+        return self->visit_default(*node);
+    }
+
+    R visit(const Kernel &op) { return derived().visit_default(op); }
+    R visit(const LoopNest &op) { return derived().visit_default(op); }
+    R visit(const IfThenElse &op) { return derived().visit_default(op); }
+    R visit(const If &op) { return derived().visit_default(op); }
+    R visit(const Move &op) { return derived().visit_default(op); }
+    R visit(const Reduce &op) { return derived().visit_default(op); }
+    R visit(const Unary &op) { return derived().visit_default(op); }
+    R visit(const Binary &op) { return derived().visit_default(op); }
+    R visit(const Select &op) { return derived().visit_default(op); }
+    R visit(const Compare &op) { return derived().visit_default(op); }
+    R visit(const Call &op) { return derived().visit_default(op); }
+    R visit(const Var &op) { return derived().visit_default(op); }
+    R visit(const Cast &op) { return derived().visit_default(op); }
+    R visit(const Ramp &op) { return derived().visit_default(op); }
+    R visit(const Index &op) { return derived().visit_default(op); }
+    R visit(const IntImm &op) { return derived().visit_default(op); }
+    R visit(const UIntImm &op) { return derived().visit_default(op); }
+    R visit(const FloatImm &op) { return derived().visit_default(op); }
+    R visit(const StringImm &op) { return derived().visit_default(op); }
+    R visit(const Dom &op) { return derived().visit_default(op); }
+
+    R visit_default(const IRNode &node) {
+        CHECK(false, "IRFunctor: unhandled node kind %d\n", static_cast<int>(node.node_type()));
+        return R();
+    }
+
+ protected:
+    Derived &derived() {
+        return *static_cast<Derived*>(this);
+    }
+};
+
+
+/**
+ * static counterpart of IRVisitor: by default every node visits its children,
+ * a pass overrides only the kinds it cares about
+ */ 
+template <typename Derived>
+class IRTreeVisitor : public IRFunctor<Derived, void> {
+ public:
+    void visit_default(const IRNode &node) {
+        for_each_child(&node, [this](const IRNode *child) { this->dispatch(child); });
+    }
+};
+
+
+/**
+ * explicit-stack traversals, safe on arbitrarily deep trees.
+ * A DAG node reached through several parents is visited once per path.
+ */ 
+template <typename F>
+void pre_order_visit(const IRNode *root, F &&f) {
+    std::vector<const IRNode*> stack{root};
+    std::vector<const IRNode*> children;
+    while (!stack.empty()) {
+        const IRNode *node = stack.back();
+        stack.pop_back();
+        f(node);
+        children.clear();
+        for_each_child(node, [&children](const IRNode *child) { children.push_back(child); });
+        stack.insert(stack.end(), children.rbegin(), children.rend());
+    }
+}
+
+
+template <typename F>
+void post_order_visit(const IRNode *root, F &&f) {
+    // second: whether the children are already on the stack
+    std::vector<std::pair<const IRNode*, bool>> stack{{root, false}};
+    std::vector<const IRNode*> children;
+    while (!stack.empty()) {
+        if (stack.back().second) {
+            const IRNode *node = stack.back().first;
+            stack.pop_back();
+            f(node);
+            continue;
+        }
+        stack.back().second = true;
+        children.clear();
+        for_each_child(stack.back().first, [&children](const IRNode *child) { children.push_back(child); });
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            stack.emplace_back(*it, false);
+        }
+    }
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_IRFUNCTOR_H
@@ -25,15 +25,41 @@
 #ifndef BOOST_IRMUTATOR_H
 #define BOOST_IRMUTATOR_H
 
+#include <chrono>
+#include <unordered_map>
+
 #include "IR.h"
+#include "IRStats.h"
 
 
 namespace Boost {
 
 namespace Internal {
 
+/**
+ * base mutator
+ * - a node whose children all come back unchanged is returned as is
+ * - with memoize, within one pass (an outermost mutate call) each input
+ *   node is mutated only once, shared subexpressions map to one shared
+ *   result. Only mutators whose result depends on nothing but the visited
+ *   node may pass memoize = true; anything that reads state (enclosing
+ *   loops, names taken so far, ...) would reuse a result built for
+ *   another context
+ */ 
 class IRMutator {
  public:
+    explicit IRMutator(bool _memoize = false) : memoize(_memoize), depth(0),
+        pass_visited(0), pass_rebuilt(0) {}
+
+    virtual ~IRMutator() = default;
+
+    /**
+     * pass name reported by IRStats
+     */ 
+    virtual const char *name() const {
+        return "IRMutator";
+    }
+
     Expr mutate(const Expr&);
     Stmt mutate(const Stmt&);
     Group mutate(const Group&);
@@ -56,8 +82,48 @@ class IRMutator {
     virtual Stmt visit(Ref<const IfThenElse>);
     virtual Stmt visit(Ref<const If>);
     virtual Stmt visit(Ref<const Move>);
+    virtual Stmt visit(Ref<const Reduce>);
     virtual Group visit(Ref<const Kernel>);
  private:
+    bool memoize;
+    int depth;
+    /**
+     * input nodes are kept alive as keys, so a freed temporary
+     * can never alias a later node
+     */ 
+    std::unordered_map<const ExprNode*, std::pair<Expr, Expr>> expr_memo;
+    std::unordered_map<const StmtNode*, std::pair<Stmt, Stmt>> stmt_memo;
+    /**
+     * per-pass counters for IRStats
+     */ 
+    size_t pass_visited;
+    size_t pass_rebuilt;
+    std::chrono::steady_clock::time_point pass_start;
+
+    void begin_node() {
+        if (depth++ == 0 && IRStats::enabled()) {
+            pass_visited = 0;
+            pass_rebuilt = 0;
+            pass_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    void end_node(bool rebuilt) {
+        --depth;
+        pass_visited += 1;
+        pass_rebuilt += rebuilt ? 1 : 0;
+    }
+
+    void end_pass() {
+        if (depth == 0) {
+            expr_memo.clear();
+            stmt_memo.clear();
+            if (IRStats::enabled()) {
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - pass_start;
+                IRStats::record_pass(name(), pass_visited, pass_rebuilt, elapsed.count());
+            }
+        }
+    }
 };
 
 }  // namespace Internal
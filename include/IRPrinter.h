@@ -77,9 +77,21 @@ class IRPrinter : public IRVisitor {
     void visit(Ref<const IfThenElse>) override;
     void visit(Ref<const If>) override;
     void visit(Ref<const Move>) override;
+    void visit(Ref<const Reduce>) override;
     void visit(Ref<const Kernel>) override;
  private:
     std::ostringstream oss;
+
+    /**
+     * &name[...] of the first element a Var accesses
+     */ 
+    void print_address(Ref<const Var> op);
+
+    /**
+     * typedef of vector type t for the GCC and Clang vector extensions,
+     * with load_t, store_t and broadcast_t, which do not assume alignment
+     */ 
+    void print_vector_helpers(Type t);
     int indent;
     std::string now_index;
     bool print_range;
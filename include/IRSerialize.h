@@ -0,0 +1,131 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_IRSERIALIZE_H
+#define BOOST_IRSERIALIZE_H
+
+#include <string>
+#include <vector>
+
+#include "IR.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * binary encoding of a set of kernels.
+ * 
+ * layout (native byte order, every section 8-byte aligned):
+ *   header
+ *   string table: uint32 offsets[num_strings + 1], then the characters
+ *   type table:   TypeRecord[num_types]
+ *   node array:   NodeRecord[num_nodes], children before parents
+ *   operands:     uint32 node ids[num_operands]
+ *   shapes:       uint64 extents[num_shapes]
+ *   roots:        uint32 node ids[num_roots]
+ * 
+ * shared subtrees are written once, so the loaded IR has the same sharing.
+ */ 
+namespace serialize {
+
+const uint32_t magic = 0x52494F42;   // "BOIR"
+const uint32_t version = 2;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_strings;
+    uint32_t string_bytes;
+    uint32_t num_types;
+    uint32_t num_nodes;
+    uint32_t num_operands;
+    uint32_t num_shapes;
+    uint32_t num_roots;
+    uint32_t reserved;
+};
+
+struct TypeRecord {
+    uint8_t code;
+    uint8_t num_lanes;
+    uint16_t bits;
+    uint16_t lanes[LanesList::max_dims];
+};
+
+/**
+ * one fixed-size record per node.
+ * op:      op_type / move_type / call_type / index_type / kernel_type
+ * flags:   Binary::bracket, or whether IfThenElse has a false case
+ * aux:     string id for names and StringImm, type id of Cast::new_type
+ * first, count: range of children in the operand array
+ * extra:   LoopNest: size of index_list; Var: number of shape extents;
+ *          Kernel: number of inputs
+ * payload: immediate value; Ramp: stride << 16 | lanes;
+ *          Var: first shape extent; Kernel: number of outputs
+ */ 
+struct NodeRecord {
+    uint8_t node_type;
+    uint8_t op;
+    uint8_t flags;
+    uint8_t reserved;
+    uint32_t type;
+    uint32_t aux;
+    uint32_t first;
+    uint32_t count;
+    uint32_t extra;
+    uint64_t payload;
+};
+
+}  // namespace serialize
+
+
+/**
+ * encode groups into a byte buffer
+ */ 
+std::string serialize_ir(const std::vector<Group> &groups);
+
+/**
+ * decode a buffer written by serialize_ir,
+ * the nodes are rebuilt with the factories, so an entered IRContext applies
+ */ 
+std::vector<Group> deserialize_ir(const char *data, size_t size);
+
+/**
+ * write the encoding to path, return false on I/O failure
+ */ 
+bool save_ir(const std::string &path, const std::vector<Group> &groups);
+
+/**
+ * map the file at path and decode it, CHECK-fails on a malformed file
+ */ 
+std::vector<Group> load_ir(const std::string &path);
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_IRSERIALIZE_H
@@ -0,0 +1,90 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_IRSTATS_H
+#define BOOST_IRSTATS_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "IR.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+const int ir_node_type_count = static_cast<int>(IRNodeType::Dom) + 1;
+
+
+/**
+ * process-wide counters of the IR layer, off by default.
+ * Only nodes created while the counters are on are tracked
+ */ 
+class IRStats {
+ public:
+    struct Pass {
+        std::string name;
+        size_t visited;     /* nodes mutated, memoized hits excluded */
+        size_t rebuilt;     /* of which came back as a new node */
+        double ms;
+    };
+
+    static void enable(bool on = true);
+
+    static bool enabled() {
+        return IRNodeCounter::enabled;
+    }
+
+    /**
+     * zero everything but the live counts
+     */ 
+    static void reset();
+
+    static int64_t live_nodes(IRNodeType type);
+    static int64_t peak_nodes(IRNodeType type);
+    static int64_t live_nodes();
+    static int64_t peak_nodes();
+    static uint64_t allocated_bytes();
+    static uint64_t shared_from_this_calls();
+    static std::vector<Pass> passes();
+
+    static void count_bytes(size_t bytes);
+    static void count_shared_from_this();
+    static void record_pass(const std::string &name, size_t visited, size_t rebuilt, double ms);
+
+    /**
+     * human readable table of all counters
+     */ 
+    static void dump(std::ostream &out);
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_IRSTATS_H
@@ -0,0 +1,116 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_IRUTIL_H
+#define BOOST_IRUTIL_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "IR.h"
+#include "IRMutator.h"
+#include "IRVisitor.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * the names of the Vars and Indices a node uses,
+ * loads is set when it reads any Var
+ */ 
+class NameCollector : public IRVisitor {
+ public:
+    std::set<std::string> names;
+    bool loads = false;
+
+    void visit(Ref<const Var> op) override;
+    void visit(Ref<const Index> op) override;
+};
+
+
+/**
+ * whether a node holds a LoopNest
+ */ 
+class LoopFinder : public IRVisitor {
+ public:
+    bool found = false;
+
+    void visit(Ref<const LoopNest> op) override;
+};
+
+
+/**
+ * the loads of an expression, not descending into their subscripts
+ */ 
+class LoadCollector : public IRVisitor {
+ public:
+    std::vector<Expr> loads;
+
+    void visit(Ref<const Var> op) override;
+};
+
+
+/**
+ * replaces indices by name
+ */ 
+class Substitute : public IRMutator {
+ public:
+    std::map<std::string, Expr> values;
+
+    Substitute() : IRMutator(true) {}
+
+    Expr visit(Ref<const Index> op) override;
+};
+
+
+/**
+ * replaces the loads deep equal to a key
+ */ 
+class ReplaceLoads : public IRMutator {
+ public:
+    std::vector<std::pair<Expr, Expr> > replacements;
+
+    ReplaceLoads() : IRMutator(true) {}
+
+    Expr visit(Ref<const Var> op) override;
+};
+
+
+/**
+ * the nest with the LoopNests that are its only body merged into it
+ */ 
+Ref<const LoopNest> flatten(Ref<const LoopNest> op);
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_IRUTIL_H
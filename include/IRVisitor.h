@@ -52,6 +52,7 @@ class IRVisitor {
     virtual void visit(Ref<const IfThenElse>);
     virtual void visit(Ref<const If>);
     virtual void visit(Ref<const Move>);
+    virtual void visit(Ref<const Reduce>);
     virtual void visit(Ref<const Kernel>);
     //new
  private:
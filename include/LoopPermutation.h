@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef BOOST_LOOPPERMUTATION_H
+#define BOOST_LOOPPERMUTATION_H
+
+#include <vector>
+
+#include "CostModel.h"
+#include "IRMutator.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * reorders the loops of each perfect nest with no loops in its body
+ * (nested LoopNests that are the only body count as one nest) to the
+ * legal order the cost model finds cheapest:
+ * - legal: every dependence stays lexicographically positive and a loop
+ *   whose bounds use another loop stays inside it;
+ * - cost: the CostModel estimate summed over the statements, less the
+ *   accesses invariant in the innermost loop, which ScalarReplacement
+ *   then keeps in registers (accumulators and hoisted loads);
+ * - among the orders costing at most slack more than the cheapest, the
+ *   one with the fewest accesses not stride 1 or invariant in the
+ *   innermost loop (which the model, counting cache misses only, does
+ *   not tell apart once data fits a cache) is taken, then one whose
+ *   outermost loop carries no dependence, then the cheapest.
+ * Ties keep the original order. Nests deeper than max_loops are left alone
+ */ 
+class LoopPermutation : public IRMutator {
+ public:
+    static const size_t max_loops = 8;
+
+    explicit LoopPermutation(CostModel _model = CostModel(), double _slack = 0.01) :
+        IRMutator(true), model(_model), slack(_slack) {}
+
+    const char *name() const override {
+        return "LoopPermutation";
+    }
+
+    Stmt visit(Ref<const LoopNest>) override;
+
+    /**
+     * order[l] is the loop of the nest to run at level l, outermost first
+     */ 
+    std::vector<size_t> choose(Ref<const LoopNest> nest) const;
+
+ private:
+    CostModel model;
+    double slack;
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_LOOPPERMUTATION_H
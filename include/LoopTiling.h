@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef BOOST_LOOPTILING_H
+#define BOOST_LOOPTILING_H
+
+#include <vector>
+
+#include "CostModel.h"
+#include "IRMutator.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * blocks perfect innermost nests of up to max_loops loops for each
+ * cache level their data does not fit in (GEMM and other contractions):
+ * - the nest must be fully permutable, every dependence Less or Equal
+ *   on every loop, and its bounds and subscripts constant and affine;
+ * - from the last level cache inward, the tile sizes (powers of two or
+ *   the whole extent, within the tile of the level outside) are those
+ *   with the most iterations per byte of the CostModel footprint of one
+ *   tile, among the tiles filling at most fill of the cache. When the
+ *   innermost loop has stride 1 it keeps the tile of the level outside
+ *   if any tile of the other loops then fits: long unit stride runs
+ *   vectorize and prefetch better than a cube tile;
+ * - a level whose tile is the one outside it adds no loops.
+ * Every level keeps the loop order of the nest, tile loops outermost.
+ * Loops are named <loop>_L<level> for tiles and <loop>_p for points;
+ * remainder tiles are peeled into their own loops by GuardElimination
+ */ 
+class LoopTiling : public IRMutator {
+ public:
+    static const size_t max_loops = 4;
+
+    explicit LoopTiling(CostModel _model = CostModel(), double _fill = 0.5) :
+        IRMutator(true), model(_model), fill(_fill) {}
+
+    const char *name() const override {
+        return "LoopTiling";
+    }
+
+    Stmt visit(Ref<const LoopNest>) override;
+
+    /**
+     * the tiles for one cache level, sizes[l] for loop l of the nest
+     */ 
+    struct Tiling {
+        int cache_level;
+        std::vector<int64_t> sizes;
+    };
+
+    /**
+     * tilings from the outermost cache level in, empty when the nest is not tiled
+     */ 
+    std::vector<Tiling> choose(Ref<const LoopNest> nest) const;
+
+ private:
+    CostModel model;
+    double fill;
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_LOOPTILING_H
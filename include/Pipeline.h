@@ -0,0 +1,60 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_PIPELINE_H
+#define BOOST_PIPELINE_H
+
+#include <string>
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * the passes the solutions run on each kernel, in order
+ */ 
+extern const char *const pipeline_passes;
+
+/**
+ * the kernel cache of a project, relative to the directory
+ * its solution and clean step run in
+ */ 
+extern const char *const kernel_cache_dir;
+
+/**
+ * everything the generated code depends on besides the kernel: the passes,
+ * a hash of the generator sources taken at configure time, and the host
+ * registers, vector width and caches the passes read.
+ * The options of the kernel cache
+ */ 
+std::string pipeline_options();
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_PIPELINE_H
@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_REDUCTIONDETECTION_H
+#define BOOST_REDUCTIONDETECTION_H
+
+#include <vector>
+
+#include "IRMutator.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * classifies loop indices: Parse makes every index Spatial, this marks
+ * the indices of a LoopNest that no destination in its body uses as
+ * IndexType::Reduce (k in C[i, j] = C[i, j] + A[i, k] * B[k, j]).
+ * Every accumulating Move (MemToMem, LocalToLocal) under such indices
+ * becomes a Reduce over them with combiner Add, so the printed code is
+ * unchanged. Local loads and stores stay Moves, and a nest that assigns
+ * to memory (LocalToMem) or accumulates nothing gets no new reduce index
+ */ 
+class ReductionDetection : public IRMutator {
+ public:
+    // a Move is rewritten by the nests around it
+    ReductionDetection() : IRMutator(false) {}
+
+    const char *name() const override {
+        return "ReductionDetection";
+    }
+
+    Stmt visit(Ref<const LoopNest>) override;
+    Stmt visit(Ref<const Move>) override;
+
+ private:
+    /* the reduce indices of the enclosing nests */
+    std::vector<Expr> axes;
+};
+
+
+/**
+ * the value x with combiner(x, y) == y for every y of type t
+ */ 
+Expr reduction_identity(Type t, BinaryOpType combiner);
+
+
+/**
+ * whether a Move of this type adds its source to its destination
+ */ 
+bool is_accumulation(MoveType t);
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_REDUCTIONDETECTION_H
@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_SCALARREPLACEMENT_H
+#define BOOST_SCALARREPLACEMENT_H
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "IRMutator.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * keeps values in local scalars instead of memory inside perfect nests
+ * with a single Move or Reduce:
+ * - a destination that does not depend on the innermost loops becomes
+ *   an accumulator, loaded before those loops (MemToLocal), updated in
+ *   the local and stored once after them (LocalToMem);
+ * - loads in the source that do not depend on them (alpha, B[i][k] in
+ *   a j loop) are loaded once before them.
+ * Arrays with different names are assumed not to alias, the destination
+ * array must not be read at any other element inside the loops.
+ */ 
+class ScalarReplacement : public IRMutator {
+ public:
+    // new locals are named from the names taken so far, not only from the node
+    ScalarReplacement() : IRMutator(false) {}
+
+    const char *name() const override {
+        return "ScalarReplacement";
+    }
+
+    Group visit(Ref<const Kernel>) override;
+    Stmt visit(Ref<const LoopNest>) override;
+
+ private:
+    /* names in use, new locals are named apart from them */
+    std::set<std::string> taken;
+    /* locals this pass created */
+    std::set<std::string> locals;
+
+    Expr make_local(const Expr &var, const std::string &suffix);
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_SCALARREPLACEMENT_H
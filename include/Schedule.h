@@ -0,0 +1,124 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef BOOST_SCHEDULE_H
+#define BOOST_SCHEDULE_H
+
+#include <string>
+#include <vector>
+
+#include "IR.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * loop transformations of a kernel, by loop name, in the spirit of
+ * Halide schedules:
+ * 
+ *     Schedule s(kernel);
+ *     s.split("i", 8, "i_o", "i_i").reorder({"k", "i_i", "j"});
+ *     kernel = s.kernel();
+ * 
+ * Each primitive rewrites the kernel right away, so later ones see the
+ * loops earlier ones made. A primitive applies to every loop with the
+ * name, perfectly nested LoopNests are merged first so that loops of
+ * one nest can be reordered and fused across them. Misuse (unknown
+ * loops, a reorder or parallel loop that breaks a dependence, see
+ * Dependence.h) fails a CHECK. Schedule the kernel before the passes
+ * that declare locals (ScalarReplacement, CSE): unrolling copies them.
+ */ 
+class Schedule {
+ public:
+    explicit Schedule(const Group &_kernel) : current(_kernel) {}
+
+    /**
+     * loop = outer * factor + inner; when factor does not divide the
+     * extent the body is guarded, GuardElimination then peels the
+     * remainder iterations into their own loop
+     */ 
+    Schedule &split(const std::string &loop, int64_t factor, const std::string &outer, const std::string &inner);
+
+    /**
+     * puts the loops, all in one nest, in this order (outermost first)
+     * in the places they take
+     */ 
+    Schedule &reorder(const std::vector<std::string> &loops);
+
+    /**
+     * merges adjacent loops into one over the product of their extents
+     */ 
+    Schedule &fuse(const std::string &outer, const std::string &inner, const std::string &fused);
+
+    /**
+     * splits x and y and moves both inner loops inside both outer loops
+     */ 
+    Schedule &tile(const std::string &x, const std::string &y,
+        const std::string &x_outer, const std::string &y_outer,
+        const std::string &x_inner, const std::string &y_inner, int64_t x_factor, int64_t y_factor);
+
+    /**
+     * replaces a loop with constant bounds by one copy of its body per
+     * iteration
+     */ 
+    Schedule &unroll(const std::string &loop);
+
+    /**
+     * marks the innermost loop of a nest IndexType::Vectorized, it must
+     * carry no dependence
+     */ 
+    Schedule &vectorize(const std::string &loop);
+
+    /**
+     * marks a loop IndexType::Parallel, it must carry no dependence
+     */ 
+    Schedule &parallel(const std::string &loop);
+
+    /**
+     * moves the statement computing producer (the last one writing the
+     * array before the nest of loop) into that nest, inside loop. Its
+     * outer loops must have the same bounds as the loops down to loop,
+     * and the consumer must not read values it computes in later
+     * iterations
+     */ 
+    Schedule &compute_at(const std::string &producer, const std::string &loop);
+
+    const Group &kernel() const {
+        return current;
+    }
+
+ private:
+    Group current;
+
+    Schedule &mark(const std::string &loop, IndexType index_type, bool innermost);
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_SCHEDULE_H
@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#ifndef BOOST_SIMPLIFIER_H
+#define BOOST_SIMPLIFIER_H
+
+#include "IRMutator.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * rule based algebraic simplifier, one bottom-up pass per mutate call:
+ * - folds constant IntImm / FloatImm subtrees with C semantics (int
+ *   division truncates, float literals are doubles); a float result is
+ *   kept only when the printer writes it back exactly
+ * - puts commutative operands in canonical order: compound operands,
+ *   then loads, then indices (by name), then constants
+ * - integer identities: x + 0, x * 1, x * 0, x / 1, x % 1, x - x,
+ *   (x * c) / c, (x * c) % c, and chains of constants
+ *   ((x + 2) + 3 to x + 5, (x * 2) * 4 to x * 8)
+ * - float rules that are exact (x * 1, x / 1, x - 0); the others,
+ *   x + 0, x * 0 and constant chains, only with reassociate_floats
+ * simplify() repeats the pass to a fixpoint and then recomputes the
+ * Binary::bracket flags from operator precedence, so only needed
+ * parentheses are printed. Results are memoized per node, so shared
+ * subtrees are simplified once and deep trees stay linear
+ */ 
+class Simplifier : public IRMutator {
+ public:
+    explicit Simplifier(bool _reassociate_floats = false) :
+        IRMutator(true), reassociate_floats(_reassociate_floats) {}
+
+    const char *name() const override {
+        return "Simplifier";
+    }
+
+    Expr visit(Ref<const Unary>) override;
+    Expr visit(Ref<const Binary>) override;
+
+    Expr simplify(const Expr &expr);
+    Stmt simplify(const Stmt &stmt);
+    Group simplify(const Group &group);
+
+ private:
+    bool reassociate_floats;
+
+    Expr rewrite(const Expr &e);
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_SIMPLIFIER_H
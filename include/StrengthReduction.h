@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef BOOST_STRENGTHREDUCTION_H
+#define BOOST_STRENGTHREDUCTION_H
+
+#include <set>
+#include <string>
+
+#include "IRMutator.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * turns the subscript arithmetic of innermost loop nests into induction
+ * variables updated with adds:
+ * - an affine subscript that is not a single index plus an invariant
+ *   (2 * i + j, p + r) gets an int local per loop it depends on, set
+ *   from the enclosing one before that loop (MemToLocal) and incremented
+ *   by its coefficient at the end of each iteration;
+ * - e / c and e % c, with c a positive constant and e a non-negative
+ *   affine expression with non-negative coefficients (i / 16, i % 16),
+ *   keep the quotient and remainder, and carry into the quotient when
+ *   the remainder reaches c.
+ * Loops whose begin is not invariant in the nest, subscripts with loads
+ * and other divisions are left alone. The nest is split where the locals
+ * are declared or updated
+ */ 
+class StrengthReduction : public IRMutator {
+ public:
+    /* results depend on the names taken so far, not only on the node */
+    StrengthReduction() : IRMutator(false) {}
+
+    const char *name() const override {
+        return "StrengthReduction";
+    }
+
+    Group visit(Ref<const Kernel>) override;
+    Stmt visit(Ref<const LoopNest>) override;
+
+ private:
+    /* names in use, induction variables are named apart from them */
+    std::set<std::string> taken;
+
+    Expr make_local(Type t, const std::string &base);
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_STRENGTHREDUCTION_H
@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef BOOST_UNROLLANDJAM_H
+#define BOOST_UNROLLANDJAM_H
+
+#include <set>
+#include <string>
+
+#include "IRMutator.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * register blocking of contractions by unroll-and-jam. In a perfect
+ * innermost nest whose body is one accumulation (a MemToMem Move or an
+ * Add Reduce) into a destination invariant in a loop r:
+ * - r moves innermost (when the dependences allow it) and two loops m, n
+ *   of the destination are unrolled by MR and NR and jammed into it, so
+ *   each r iteration updates an MR x NR tile of local accumulators,
+ *   loaded before the r loop and stored after it;
+ * - r itself is unrolled by the largest power of two up to max_step
+ *   dividing its extent;
+ * - each r step loads every element it reads once into a local, the
+ *   updates then only read locals.
+ * m and n are among the two innermost loops of the destination, so the
+ * tile stays inside a cache tiling, and MR x NR is the tile with the most
+ * updates per load whose accumulators and loads fit in the registers.
+ * Iterations of m and n past a multiple of MR and NR are left in
+ * remainder loops, and the loads of those count against the tile. Loops
+ * left with a single iteration are dropped
+ */ 
+class UnrollAndJam : public IRMutator {
+ public:
+    /**
+     * floating point registers of the ISA this is compiled for
+     */ 
+    static int host_registers();
+
+    explicit UnrollAndJam(int _registers = host_registers(), int64_t _max_step = 4) :
+        IRMutator(false), registers(_registers), max_step(_max_step) {}
+
+    const char *name() const override {
+        return "UnrollAndJam";
+    }
+
+    Group visit(Ref<const Kernel>) override;
+    Stmt visit(Ref<const LoopNest>) override;
+
+    /**
+     * the register tile of a nest, loops by position; n == m when only
+     * one loop is unrolled
+     */ 
+    struct Tile {
+        size_t m, n, r;
+        int64_t mr, nr;
+    };
+
+    /**
+     * false when the nest is not a contraction or no tile beats 1 x 1
+     */ 
+    bool choose(Ref<const LoopNest> nest, Tile &tile) const;
+
+ private:
+    int registers;
+    int64_t max_step;
+    /* names in use, locals are named apart from them */
+    std::set<std::string> taken;
+
+    Expr make_local(Type t, const std::string &base);
+    Stmt lower(Ref<const LoopNest> nest, const Tile &tile);
+    Stmt jam(Ref<const LoopNest> nest, const Tile &tile);
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_UNROLLANDJAM_H
@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef BOOST_VECTORIZATION_H
+#define BOOST_VECTORIZATION_H
+
+#include <vector>
+
+#include "IRMutator.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * turns the innermost loop of a nest into vector code when it can run
+ * its iterations in parallel and every statement of its body is a store
+ * or an accumulation (MemToMem, LocalToMem or Add Reduce):
+ * - the destination and the loads depending on the loop must have it
+ *   in their last subscript only, with coefficient 1; they become
+ *   Vars of the vector type indexed by a Ramp of stride 1;
+ * - operands not depending on the loop are broadcast (a Ramp of
+ *   stride 0);
+ * - every value has the element type of the destination.
+ * The loop then steps by whole vectors as <loop>_v, the iterations past
+ * the last whole vector are peeled into a scalar loop. The vector holds
+ * vector_bytes bytes, the native width of the ISA this is compiled for.
+ * Loops marked Vectorized by a Schedule lose the mark, vectorized or not
+ */ 
+class Vectorization : public IRMutator {
+ public:
+    static int host_vector_bytes();
+
+    // choose() depends on the loops around a nest
+    explicit Vectorization(int _vector_bytes = host_vector_bytes()) :
+        IRMutator(false), vector_bytes(_vector_bytes) {}
+
+    const char *name() const override {
+        return "Vectorization";
+    }
+
+    Stmt visit(Ref<const LoopNest>) override;
+
+    /**
+     * lanes of the vectors for the innermost loop of the nest, 0 when it
+     * is not vectorized. enclosing are the loops around the nest
+     */ 
+    int choose(Ref<const LoopNest> nest, const std::vector<Expr> &enclosing = {}) const;
+
+ private:
+    int vector_bytes;
+    /* loops around the nest being visited */
+    std::vector<Expr> enclosing;
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_VECTORIZATION_H
@@ -25,19 +25,124 @@
 #ifndef BOOST_ARITH_H
 #define BOOST_ARITH_H
 
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
 namespace Boost {
 
+namespace Internal {
+
+class Expr;
+
+}  // namespace Internal
+
 namespace Arith {
 
+/**
+ * a set of integers: every x with min <= x <= max and
+ * x = remainder (mod stride).
+ * stride 0 means a single value, stride 1 a dense range.
+ * min/max saturate at the int64 limits, which stand for unbounded
+ */ 
+class Interval {
+ public:
+    static const int64_t neg_inf = std::numeric_limits<int64_t>::min();
+    static const int64_t pos_inf = std::numeric_limits<int64_t>::max();
+
+    int64_t min;
+    int64_t max;
+    int64_t stride;
+    int64_t remainder;
+
+    Interval() : min(neg_inf), max(pos_inf), stride(1), remainder(0) {}
+
+    Interval(int64_t _min, int64_t _max, int64_t _stride = 1, int64_t _remainder = 0);
+
+    static Interval point(int64_t value) {
+        return Interval(value, value, 0, value);
+    }
+
+    static Interval everything() {
+        return Interval();
+    }
+
+    bool is_point() const {
+        return min == max;
+    }
+
+    bool is_bounded() const {
+        return min != neg_inf && max != pos_inf;
+    }
+
+    bool is_empty() const {
+        return min > max;
+    }
+
+    bool contains(int64_t value) const;
+
+    /**
+     * smallest interval holding both
+     */ 
+    static Interval union_of(const Interval &a, const Interval &b);
+
+    static Interval intersect(const Interval &a, const Interval &b);
+
+    friend Interval operator-(const Interval &a);
+    friend Interval operator+(const Interval &a, const Interval &b);
+    friend Interval operator-(const Interval &a, const Interval &b);
+    friend Interval operator*(const Interval &a, const Interval &b);
+    /**
+     * truncating division and remainder, like the generated C code
+     */ 
+    friend Interval operator/(const Interval &a, const Interval &b);
+    friend Interval operator%(const Interval &a, const Interval &b);
+
+    bool operator==(const Interval &other) const {
+        return min == other.min && max == other.max && stride == other.stride && remainder == other.remainder;
+    }
+
+    bool operator!=(const Interval &other) const {
+        return !((*this) == other);
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, const Interval &interval);
+};
+
+
+/**
+ * ranges of index expressions.
+ * Each loop index takes the range of its Dom, [begin, begin + extent),
+ * unless a narrower range is bound to its name
+ */ 
 class Bounds {
  private:
-    std::vector<std::pair<size_t, size_t>> bounds;
+    std::map<std::string, Interval> bounds;
  public:
     Bounds() {}
 
     Bounds(const Bounds &other) : bounds(other.bounds) {}
 
     Bounds(const Bounds &&other) : bounds(other.bounds) {}
+
+    Bounds &operator=(const Bounds &other) = default;
+
+    void bind(const std::string &index_name, const Interval &range) {
+        bounds[index_name] = range;
+    }
+
+    void unbind(const std::string &index_name) {
+        bounds.erase(index_name);
+    }
+
+    /**
+     * range of expr, everything() for what it can't analyse
+     * (loads, calls, floating point)
+     */ 
+    Interval operator()(const Internal::Expr &expr) const;
 };
 
 }  // namespace Arith
@@ -45,4 +150,4 @@ class Bounds {
 }  // namespace Boost
 
 
-#endif  // BOOST_ARITH_H
\ No newline at end of file
+#endif  // BOOST_ARITH_H
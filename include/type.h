@@ -27,8 +27,11 @@
 
 #include <vector>
 #include <sstream>
+#include <initializer_list>
+#include <type_traits>
 
 #include "debug.h"
+#include "hash.h"
 
 
 namespace Boost {
@@ -44,57 +47,56 @@ enum class TypeCode : uint8_t {
 };
 
 /**
- * This maybe a heavy implementation
+ * lanes of each vector dimension, stored inline so that
+ * copying a Type never touches the heap
  */ 
 class LanesList {
+ public:
+    static const size_t max_dims = 4;
  private:
-    std::vector<uint16_t> lanes_list;
+    uint16_t lanes_list[max_dims];
+    uint8_t size_;
  public:
-    LanesList() {}
-
-    LanesList(const LanesList &other) : lanes_list(other.lanes_list) {}
-
-    LanesList(const LanesList &&other) : lanes_list(std::move(other.lanes_list)) {}
+    LanesList() : size_(0) {}
 
-    LanesList(const std::vector<uint16_t> &_lanes_list) : lanes_list(_lanes_list) {};
+    LanesList(std::initializer_list<uint16_t> _lanes_list) : size_(0) {
+        for (auto lanes : _lanes_list) {
+            push_back(lanes);
+        }
+    }
 
-    LanesList(const std::vector<uint16_t> &&_lanes_list) {
-        lanes_list = std::move(_lanes_list);
+    LanesList(const std::vector<uint16_t> &_lanes_list) : size_(0) {
+        for (auto lanes : _lanes_list) {
+            push_back(lanes);
+        }
     }
 
     LanesList &push_back(uint16_t v) {
-        lanes_list.push_back(v);
+        CHECK(size_ < max_dims, "too many lanes dimensions: %d\n", static_cast<int>(size_) + 1);
+        lanes_list[size_++] = v;
         return *this;
     }
 
     uint16_t pop_back() {
-        uint16_t ret = lanes_list.back();
-        lanes_list.pop_back();
-        return ret;
+        return lanes_list[--size_];
     }
 
-    size_t size() {
-        return lanes_list.size();
+    size_t size() const {
+        return size_;
     }
 
     uint16_t &operator[](size_t pos) {
         return lanes_list[pos];
     }
 
-    LanesList &operator=(const LanesList &other) {
-        this->lanes_list = other.lanes_list;
-        return *this;
-    }
-
-    LanesList &operator=(const LanesList &&other) {
-        this->lanes_list = std::move(other.lanes_list);
-        return *this;
+    uint16_t operator[](size_t pos) const {
+        return lanes_list[pos];
     }
 
     bool operator==(const LanesList &other) const {
-        if (this->lanes_list.size() != other.lanes_list.size())
+        if (this->size_ != other.size_)
             return false;
-        for (size_t i = 0; i < lanes_list.size(); ++i) {
+        for (size_t i = 0; i < size_; ++i) {
             if (this->lanes_list[i] != other.lanes_list[i]) {
                 return false;
             }
@@ -104,8 +106,8 @@ class LanesList {
 
     friend std::ostream &operator<<(std::ostream& out, const LanesList &l) {
         out << "<";
-        for (size_t i = 0; i < l.lanes_list.size(); ++i) {
-            if (i == l.lanes_list.size() - 1) {
+        for (size_t i = 0; i < l.size_; ++i) {
+            if (i == l.size_ - 1u) {
                 out << l.lanes_list[i];
             } else {
                 out << l.lanes_list[i] << ", ";
@@ -118,42 +120,31 @@ class LanesList {
     bool operator!=(const LanesList &other) const {
         return !((*this) == other);
     }
+
+    uint64_t hash() const {
+        uint64_t h = size_;
+        for (size_t i = 0; i < size_; ++i) {
+            h = hash_combine(h, lanes_list[i]);
+        }
+        return h;
+    }
 };
 
 
+/**
+ * value type, trivially copyable: pass and return it freely
+ */ 
 class Type {
  public:
     TypeCode code;
     uint16_t bits;
     LanesList lanes_list;
 
-    Type() : lanes_list() {};
+    Type() : code(TypeCode::Int), bits(0), lanes_list() {}
 
     Type(TypeCode _code, uint16_t _bits, LanesList _lanes_list) : code(_code),
         bits(_bits), lanes_list(_lanes_list) {}
 
-    Type(Type &other) : code(other.code), bits(other.bits), lanes_list(other.lanes_list) {}
-
-    Type(Type &&other) : code(other.code), bits(other.bits), lanes_list(std::move(other.lanes_list)) {}
-
-    Type(const Type &other) : code(other.code), bits(other.bits), lanes_list(other.lanes_list) {}
-
-    Type(const Type &&other) : code(other.code), bits(other.bits), lanes_list(std::move(other.lanes_list)) {}
-
-    Type &operator=(const Type &other) {
-        this->code = other.code;
-        this->bits = other.bits;
-        this->lanes_list = other.lanes_list;
-        return *this;
-    }
-
-    Type &operator=(const Type &&other) {
-        this->code = other.code;
-        this->bits = other.bits;
-        this->lanes_list = std::move(other.lanes_list);
-        return *this;
-    }
-
     bool is_int() const {
         return this->code == TypeCode::Int;
     }
@@ -174,6 +165,11 @@ class Type {
         return !((*this) == other);
     }
 
+    uint64_t hash() const {
+        uint64_t h = hash_combine(static_cast<uint64_t>(code), bits);
+        return hash_combine(h, lanes_list.hash());
+    }
+
     friend std::ostream &operator<<(std::ostream& out, const Type &t) {
         if (t.code == TypeCode::Int) {
             out << "int";
@@ -186,13 +182,34 @@ class Type {
         } else if (t.code == TypeCode::Handle) {
             out << "handle";
         }
+        if (t.lanes() > 1) {
+            out << "x" << t.lanes();
+        }
         return out;
     }
 
-    size_t dim() {
+    size_t dim() const {
         return lanes_list.size();
     }
 
+    /**
+     * elements in a value, 1 for scalars
+     */ 
+    int lanes() const {
+        int n = 1;
+        for (size_t i = 0; i < lanes_list.size(); ++i) {
+            n *= lanes_list[i];
+        }
+        return n;
+    }
+
+    /**
+     * the type of a vector of _lanes elements of this type
+     */ 
+    Type with_lanes(uint16_t _lanes) const {
+        return Type(code, bits, LanesList({_lanes}));
+    }
+
     static Type int_scalar(int bits) {
         CHECK(bits > 0 && bits < INT16_MAX, "bits too large: %d", bits);
         return Type(
@@ -218,6 +235,8 @@ class Type {
     }
 };
 
+static_assert(std::is_trivially_copyable<Type>::value, "Type must stay trivially copyable");
+
 }  // namespace Internal
 
 }  // namespace Boost
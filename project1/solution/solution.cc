@@ -10,8 +10,21 @@
 #include "IR.h"
 #include "parse.h"
 #include "IRMutator.h"
+#include "Simplifier.h"
+#include "GuardElimination.h"
+#include "ReductionDetection.h"
+#include "LoopPermutation.h"
+#include "LoopTiling.h"
+#include "UnrollAndJam.h"
+#include "ScalarReplacement.h"
+#include "Vectorization.h"
+#include "StrengthReduction.h"
+#include "CommonSubexpressionElimination.h"
 #include "IRVisitor.h"
 #include "IRPrinter.h"
+#include "CompileCache.h"
+#include "Pipeline.h"
+#include "IRStats.h"
 #include "type.h"
 
 using namespace std;
@@ -131,6 +144,8 @@ namespace Project1 {
 void solveProject1() {
 	using namespace Project1;
 	getFiles();
+	// update pipeline_passes whenever the passes below change
+	Boost::Internal::CompileCache cache(Boost::Internal::kernel_cache_dir, Boost::Internal::pipeline_options());
 	
     for(int i = 0; i < infiles.size();i++){
     	int cas = i + 1;
@@ -146,26 +161,74 @@ void solveProject1() {
         } 
         Boost::Internal::Parse p = Boost::Internal::Parse(name,type,in,out,kernel1);
         Boost::Internal::Group kernel = p.P();
-        Boost::Internal::IRVisitor visitor;
-        kernel.visit_group(&visitor);
 
-        // mutator
-        Boost::Internal::IRMutator mutator;
-        kernel = mutator.mutate(kernel);
+        Boost::Internal::Group source = kernel;
+        std::string code;
+        if (!cache.lookup(source, code)) {
+            Boost::Internal::IRVisitor visitor;
+            kernel.visit_group(&visitor);
 
-        // printer
-        Boost::Internal::IRPrinter printer;
-        std::string code = printer.print(kernel);
+            // mutator
+            Boost::Internal::IRMutator mutator;
+            kernel = mutator.mutate(kernel);
+
+            // fold constants and identities, keep only the needed parentheses
+            Boost::Internal::Simplifier simplifier;
+            kernel = simplifier.simplify(kernel);
+
+            // drop the bounds guards Parse puts around each statement where ranges allow
+            Boost::Internal::GuardElimination guard_elimination;
+            kernel = guard_elimination.mutate(kernel);
+
+            // mark the indices missing from the left hand side as reduce axes
+            Boost::Internal::ReductionDetection reduction_detection;
+            kernel = reduction_detection.mutate(kernel);
+
+            // run each nest in the cheapest legal loop order
+            Boost::Internal::LoopPermutation loop_permutation;
+            kernel = loop_permutation.mutate(kernel);
+
+            // block nests whose data does not fit in the caches
+            Boost::Internal::LoopTiling loop_tiling;
+            kernel = loop_tiling.mutate(kernel);
+
+            // keep a register tile of accumulators in contractions
+            Boost::Internal::UnrollAndJam unroll_and_jam;
+            kernel = unroll_and_jam.mutate(kernel);
+
+            // accumulate in registers and load loop invariants once
+            Boost::Internal::ScalarReplacement scalar_replacement;
+            kernel = scalar_replacement.mutate(kernel);
+
+            // run unit stride innermost loops on whole vectors
+            Boost::Internal::Vectorization vectorization;
+            kernel = vectorization.mutate(kernel);
+
+            // update index arithmetic with adds instead of recomputing it
+            Boost::Internal::StrengthReduction strength_reduction;
+            kernel = strength_reduction.mutate(kernel);
+
+            // compute repeated subexpressions once per iteration
+            Boost::Internal::CommonSubexpressionElimination cse;
+            kernel = cse.mutate(kernel);
+
+            // printer
+            Boost::Internal::IRPrinter printer;
+            code = printer.print(kernel);
+            cache.store(source, code);
+        }
 
         infile.close(); 
         //std::cout << code;
         //std::cout << code;
-        std::ofstream ofile(outpath+outfiles[i], std::ios::out);
-        ofile << code;
-        ofile.close();
+        // unchanged kernels keep their timestamps
+        Boost::Internal::write_if_changed(outpath+outfiles[i], code);
+        // and the clean step leaves them alone
+        cache.record_output(outpath+outfiles[i], source);
         name = "",type="";
         in.clear();out.clear();
     }
+    cerr << cache.report() << endl;
 }
 
 namespace Project2 {
@@ -584,7 +647,10 @@ void solveProject2() {
 }
 
 
-int main() {
+int main(int argc, char *argv[]) {
+	// --ir-stats: dump IR allocation and pass counters to stderr
+	bool ir_stats = argc > 1 && string(argv[1]) == "--ir-stats";
+	Boost::Internal::IRStats::enable(ir_stats);
 	/*
 	cerr << "--main0--" << endl;
 	solveProject2();
@@ -592,6 +658,7 @@ int main() {
 	solveProject1();
 	cerr << "--main2--" << endl;
 	*/
+	if (ir_stats) Boost::Internal::IRStats::dump(cerr);
 
 	return 0;
 }
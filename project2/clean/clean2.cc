@@ -1,11 +1,17 @@
-#include <fstream>
 #include <string>
 
+#include "CompileCache.h"
+#include "Pipeline.h"
+
 
 void clean_write(std::string dst, std::string src) {
-    std::ofstream out(dst, std::ios::out);
-    out << src;
-    out.close();
+    static Boost::Internal::CompileCache cache(Boost::Internal::kernel_cache_dir, Boost::Internal::pipeline_options());
+    // the solution writes a kernel with a current cache entry back unchanged,
+    // resetting it would only touch its timestamp
+    if (cache.output_is_current(dst)) {
+        return;
+    }
+    Boost::Internal::write_if_changed(dst, src);
 }
 
 
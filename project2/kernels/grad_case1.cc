@@ -1,8 +1,24 @@
 #include "../run2.h"
+#ifndef BOOST_VECTOR_floatx4
+#define BOOST_VECTOR_floatx4
+typedef float floatx4 __attribute__((vector_size(16)));
+static inline floatx4 load_floatx4(const float *p) {
+  floatx4 v;
+  __builtin_memcpy(&v, p, sizeof(v));
+  return v;
+}
+static inline void store_floatx4(float *p, floatx4 v) {
+  __builtin_memcpy(p, &v, sizeof(v));
+}
+static inline floatx4 broadcast_floatx4(float x) {
+  floatx4 v = {};
+  return v + x;
+}
+#endif
 void grad_case1(float (&B)[4][16], float (&dC)[4][16], float (&dA)[4][16]) {
   for(int i = 0; i < 4; ++i){
-    for(int j = 0; j < 16; ++j){
-      dA[i][j] += dC[i][j] * B[i][j];
+    for(int j_v = 0; j_v < 4; ++j_v){
+      store_floatx4(&dA[i][j_v * 4], load_floatx4(&dA[i][j_v * 4]) + load_floatx4(&B[i][j_v * 4]) * load_floatx4(&dC[i][j_v * 4]));
     }
   }
 }
@@ -1,8 +1,25 @@
 #include "../run2.h"
+#ifndef BOOST_VECTOR_floatx4
+#define BOOST_VECTOR_floatx4
+typedef float floatx4 __attribute__((vector_size(16)));
+static inline floatx4 load_floatx4(const float *p) {
+  floatx4 v;
+  __builtin_memcpy(&v, p, sizeof(v));
+  return v;
+}
+static inline void store_floatx4(float *p, floatx4 v) {
+  __builtin_memcpy(p, &v, sizeof(v));
+}
+static inline floatx4 broadcast_floatx4(float x) {
+  floatx4 v = {};
+  return v + x;
+}
+#endif
 void grad_case2(float (&A)[4][16], float (&dB)[4][16], float (&dA)[4][16]) {
   for(int i = 0; i < 4; ++i){
-    for(int j = 0; j < 16; ++j){
-      dA[i][j] += dB[i][j] * A[i][j] + A[i][j] * dB[i][j];
+    for(int j_v = 0; j_v < 4; ++j_v){
+      floatx4 cse0 = load_floatx4(&A[i][j_v * 4]) * load_floatx4(&dB[i][j_v * 4]);
+      store_floatx4(&dA[i][j_v * 4], load_floatx4(&dA[i][j_v * 4]) + (cse0 + cse0));
     }
   }
 }
@@ -1,10 +1,89 @@
 #include "../run2.h"
 void grad_case3(float (&B)[16][16], float (&dC)[4][16], float (&dA)[4][16]) {
-  for(int i = 0; i < 4; ++i){
-    for(int k = 0; k < 16; ++k){
-      for(int j = 0; j < 16; ++j){
-        dA[i][k] += dC[i][j] * B[k][j];
+  for(int i_o = 0; i_o < 2; ++i_o){
+    for(int k_o = 0; k_o < 4; ++k_o){
+      float dA_acc0_0 = dA[i_o * 2][k_o * 4];
+      float dA_acc0_1 = dA[i_o * 2][k_o * 4 + 1];
+      float dA_acc0_2 = dA[i_o * 2][k_o * 4 + 2];
+      float dA_acc0_3 = dA[i_o * 2][k_o * 4 + 3];
+      float dA_acc1_0 = dA[i_o * 2 + 1][k_o * 4];
+      float dA_acc1_1 = dA[i_o * 2 + 1][k_o * 4 + 1];
+      float dA_acc1_2 = dA[i_o * 2 + 1][k_o * 4 + 2];
+      float dA_acc1_3 = dA[i_o * 2 + 1][k_o * 4 + 3];
+      int iv0_j_o = 0;
+      int iv1_j_o = 1;
+      int iv2_j_o = 2;
+      int iv3_j_o = 3;
+      for(int j_o = 0; j_o < 4; ++j_o){
+        float B_reg = B[k_o * 4][iv0_j_o];
+        float dC_reg = dC[i_o * 2][iv0_j_o];
+        float B_reg1 = B[k_o * 4 + 1][iv0_j_o];
+        float B_reg2 = B[k_o * 4 + 2][iv0_j_o];
+        float B_reg3 = B[k_o * 4 + 3][iv0_j_o];
+        float dC_reg1 = dC[i_o * 2 + 1][iv0_j_o];
+        dA_acc0_0 += B_reg * dC_reg;
+        dA_acc0_1 += B_reg1 * dC_reg;
+        dA_acc0_2 += B_reg2 * dC_reg;
+        dA_acc0_3 += B_reg3 * dC_reg;
+        dA_acc1_0 += B_reg * dC_reg1;
+        dA_acc1_1 += B_reg1 * dC_reg1;
+        dA_acc1_2 += B_reg2 * dC_reg1;
+        dA_acc1_3 += B_reg3 * dC_reg1;
+        float B_reg4 = B[k_o * 4][iv1_j_o];
+        float dC_reg2 = dC[i_o * 2][iv1_j_o];
+        float B_reg5 = B[k_o * 4 + 1][iv1_j_o];
+        float B_reg6 = B[k_o * 4 + 2][iv1_j_o];
+        float B_reg7 = B[k_o * 4 + 3][iv1_j_o];
+        float dC_reg3 = dC[i_o * 2 + 1][iv1_j_o];
+        dA_acc0_0 += B_reg4 * dC_reg2;
+        dA_acc0_1 += B_reg5 * dC_reg2;
+        dA_acc0_2 += B_reg6 * dC_reg2;
+        dA_acc0_3 += B_reg7 * dC_reg2;
+        dA_acc1_0 += B_reg4 * dC_reg3;
+        dA_acc1_1 += B_reg5 * dC_reg3;
+        dA_acc1_2 += B_reg6 * dC_reg3;
+        dA_acc1_3 += B_reg7 * dC_reg3;
+        float B_reg8 = B[k_o * 4][iv2_j_o];
+        float dC_reg4 = dC[i_o * 2][iv2_j_o];
+        float B_reg9 = B[k_o * 4 + 1][iv2_j_o];
+        float B_reg10 = B[k_o * 4 + 2][iv2_j_o];
+        float B_reg11 = B[k_o * 4 + 3][iv2_j_o];
+        float dC_reg5 = dC[i_o * 2 + 1][iv2_j_o];
+        dA_acc0_0 += B_reg8 * dC_reg4;
+        dA_acc0_1 += B_reg9 * dC_reg4;
+        dA_acc0_2 += B_reg10 * dC_reg4;
+        dA_acc0_3 += B_reg11 * dC_reg4;
+        dA_acc1_0 += B_reg8 * dC_reg5;
+        dA_acc1_1 += B_reg9 * dC_reg5;
+        dA_acc1_2 += B_reg10 * dC_reg5;
+        dA_acc1_3 += B_reg11 * dC_reg5;
+        float B_reg12 = B[k_o * 4][iv3_j_o];
+        float dC_reg6 = dC[i_o * 2][iv3_j_o];
+        float B_reg13 = B[k_o * 4 + 1][iv3_j_o];
+        float B_reg14 = B[k_o * 4 + 2][iv3_j_o];
+        float B_reg15 = B[k_o * 4 + 3][iv3_j_o];
+        float dC_reg7 = dC[i_o * 2 + 1][iv3_j_o];
+        dA_acc0_0 += B_reg12 * dC_reg6;
+        dA_acc0_1 += B_reg13 * dC_reg6;
+        dA_acc0_2 += B_reg14 * dC_reg6;
+        dA_acc0_3 += B_reg15 * dC_reg6;
+        dA_acc1_0 += B_reg12 * dC_reg7;
+        dA_acc1_1 += B_reg13 * dC_reg7;
+        dA_acc1_2 += B_reg14 * dC_reg7;
+        dA_acc1_3 += B_reg15 * dC_reg7;
+        iv0_j_o += 4;
+        iv1_j_o += 4;
+        iv2_j_o += 4;
+        iv3_j_o += 4;
       }
+      dA[i_o * 2][k_o * 4] = dA_acc0_0;
+      dA[i_o * 2][k_o * 4 + 1] = dA_acc0_1;
+      dA[i_o * 2][k_o * 4 + 2] = dA_acc0_2;
+      dA[i_o * 2][k_o * 4 + 3] = dA_acc0_3;
+      dA[i_o * 2 + 1][k_o * 4] = dA_acc1_0;
+      dA[i_o * 2 + 1][k_o * 4 + 1] = dA_acc1_1;
+      dA[i_o * 2 + 1][k_o * 4 + 2] = dA_acc1_2;
+      dA[i_o * 2 + 1][k_o * 4 + 3] = dA_acc1_3;
     }
   }
 }
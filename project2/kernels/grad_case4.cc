@@ -1,17 +1,175 @@
 #include "../run2.h"
 void grad_case4(float (&B)[16][32], float (&C)[32][32], float (&dA)[16][32], float (&dB)[16][32], float (&dC)[32][32]) {
-  for(int i = 0; i < 16; ++i){
-    for(int k = 0; k < 32; ++k){
-      for(int j = 0; j < 32; ++j){
-        dB[i][k] += dA[i][j] * C[k][j];
+  for(int i_o = 0; i_o < 8; ++i_o){
+    for(int k_o = 0; k_o < 8; ++k_o){
+      float dB_acc0_0 = dB[i_o * 2][k_o * 4];
+      float dB_acc0_1 = dB[i_o * 2][k_o * 4 + 1];
+      float dB_acc0_2 = dB[i_o * 2][k_o * 4 + 2];
+      float dB_acc0_3 = dB[i_o * 2][k_o * 4 + 3];
+      float dB_acc1_0 = dB[i_o * 2 + 1][k_o * 4];
+      float dB_acc1_1 = dB[i_o * 2 + 1][k_o * 4 + 1];
+      float dB_acc1_2 = dB[i_o * 2 + 1][k_o * 4 + 2];
+      float dB_acc1_3 = dB[i_o * 2 + 1][k_o * 4 + 3];
+      int iv0_j_o = 0;
+      int iv1_j_o = 1;
+      int iv2_j_o = 2;
+      int iv3_j_o = 3;
+      for(int j_o = 0; j_o < 8; ++j_o){
+        float C_reg = C[k_o * 4][iv0_j_o];
+        float dA_reg = dA[i_o * 2][iv0_j_o];
+        float C_reg1 = C[k_o * 4 + 1][iv0_j_o];
+        float C_reg2 = C[k_o * 4 + 2][iv0_j_o];
+        float C_reg3 = C[k_o * 4 + 3][iv0_j_o];
+        float dA_reg1 = dA[i_o * 2 + 1][iv0_j_o];
+        dB_acc0_0 += C_reg * dA_reg;
+        dB_acc0_1 += C_reg1 * dA_reg;
+        dB_acc0_2 += C_reg2 * dA_reg;
+        dB_acc0_3 += C_reg3 * dA_reg;
+        dB_acc1_0 += C_reg * dA_reg1;
+        dB_acc1_1 += C_reg1 * dA_reg1;
+        dB_acc1_2 += C_reg2 * dA_reg1;
+        dB_acc1_3 += C_reg3 * dA_reg1;
+        float C_reg4 = C[k_o * 4][iv1_j_o];
+        float dA_reg2 = dA[i_o * 2][iv1_j_o];
+        float C_reg5 = C[k_o * 4 + 1][iv1_j_o];
+        float C_reg6 = C[k_o * 4 + 2][iv1_j_o];
+        float C_reg7 = C[k_o * 4 + 3][iv1_j_o];
+        float dA_reg3 = dA[i_o * 2 + 1][iv1_j_o];
+        dB_acc0_0 += C_reg4 * dA_reg2;
+        dB_acc0_1 += C_reg5 * dA_reg2;
+        dB_acc0_2 += C_reg6 * dA_reg2;
+        dB_acc0_3 += C_reg7 * dA_reg2;
+        dB_acc1_0 += C_reg4 * dA_reg3;
+        dB_acc1_1 += C_reg5 * dA_reg3;
+        dB_acc1_2 += C_reg6 * dA_reg3;
+        dB_acc1_3 += C_reg7 * dA_reg3;
+        float C_reg8 = C[k_o * 4][iv2_j_o];
+        float dA_reg4 = dA[i_o * 2][iv2_j_o];
+        float C_reg9 = C[k_o * 4 + 1][iv2_j_o];
+        float C_reg10 = C[k_o * 4 + 2][iv2_j_o];
+        float C_reg11 = C[k_o * 4 + 3][iv2_j_o];
+        float dA_reg5 = dA[i_o * 2 + 1][iv2_j_o];
+        dB_acc0_0 += C_reg8 * dA_reg4;
+        dB_acc0_1 += C_reg9 * dA_reg4;
+        dB_acc0_2 += C_reg10 * dA_reg4;
+        dB_acc0_3 += C_reg11 * dA_reg4;
+        dB_acc1_0 += C_reg8 * dA_reg5;
+        dB_acc1_1 += C_reg9 * dA_reg5;
+        dB_acc1_2 += C_reg10 * dA_reg5;
+        dB_acc1_3 += C_reg11 * dA_reg5;
+        float C_reg12 = C[k_o * 4][iv3_j_o];
+        float dA_reg6 = dA[i_o * 2][iv3_j_o];
+        float C_reg13 = C[k_o * 4 + 1][iv3_j_o];
+        float C_reg14 = C[k_o * 4 + 2][iv3_j_o];
+        float C_reg15 = C[k_o * 4 + 3][iv3_j_o];
+        float dA_reg7 = dA[i_o * 2 + 1][iv3_j_o];
+        dB_acc0_0 += C_reg12 * dA_reg6;
+        dB_acc0_1 += C_reg13 * dA_reg6;
+        dB_acc0_2 += C_reg14 * dA_reg6;
+        dB_acc0_3 += C_reg15 * dA_reg6;
+        dB_acc1_0 += C_reg12 * dA_reg7;
+        dB_acc1_1 += C_reg13 * dA_reg7;
+        dB_acc1_2 += C_reg14 * dA_reg7;
+        dB_acc1_3 += C_reg15 * dA_reg7;
+        iv0_j_o += 4;
+        iv1_j_o += 4;
+        iv2_j_o += 4;
+        iv3_j_o += 4;
       }
+      dB[i_o * 2][k_o * 4] = dB_acc0_0;
+      dB[i_o * 2][k_o * 4 + 1] = dB_acc0_1;
+      dB[i_o * 2][k_o * 4 + 2] = dB_acc0_2;
+      dB[i_o * 2][k_o * 4 + 3] = dB_acc0_3;
+      dB[i_o * 2 + 1][k_o * 4] = dB_acc1_0;
+      dB[i_o * 2 + 1][k_o * 4 + 1] = dB_acc1_1;
+      dB[i_o * 2 + 1][k_o * 4 + 2] = dB_acc1_2;
+      dB[i_o * 2 + 1][k_o * 4 + 3] = dB_acc1_3;
     }
   }
-  for(int k = 0; k < 32; ++k){
-    for(int j = 0; j < 32; ++j){
-      for(int i = 0; i < 16; ++i){
-        dC[k][j] += B[i][k] * dA[i][j];
+  for(int k_o = 0; k_o < 16; ++k_o){
+    for(int j_o = 0; j_o < 8; ++j_o){
+      float dC_acc0_0 = dC[k_o * 2][j_o * 4];
+      float dC_acc0_1 = dC[k_o * 2][j_o * 4 + 1];
+      float dC_acc0_2 = dC[k_o * 2][j_o * 4 + 2];
+      float dC_acc0_3 = dC[k_o * 2][j_o * 4 + 3];
+      float dC_acc1_0 = dC[k_o * 2 + 1][j_o * 4];
+      float dC_acc1_1 = dC[k_o * 2 + 1][j_o * 4 + 1];
+      float dC_acc1_2 = dC[k_o * 2 + 1][j_o * 4 + 2];
+      float dC_acc1_3 = dC[k_o * 2 + 1][j_o * 4 + 3];
+      int iv0_i_o = 0;
+      int iv1_i_o = 1;
+      int iv2_i_o = 2;
+      int iv3_i_o = 3;
+      for(int i_o = 0; i_o < 4; ++i_o){
+        float B_reg = B[iv0_i_o][k_o * 2];
+        float dA_reg8 = dA[iv0_i_o][j_o * 4];
+        float dA_reg9 = dA[iv0_i_o][j_o * 4 + 1];
+        float dA_reg10 = dA[iv0_i_o][j_o * 4 + 2];
+        float dA_reg11 = dA[iv0_i_o][j_o * 4 + 3];
+        float B_reg1 = B[iv0_i_o][k_o * 2 + 1];
+        dC_acc0_0 += B_reg * dA_reg8;
+        dC_acc0_1 += B_reg * dA_reg9;
+        dC_acc0_2 += B_reg * dA_reg10;
+        dC_acc0_3 += B_reg * dA_reg11;
+        dC_acc1_0 += B_reg1 * dA_reg8;
+        dC_acc1_1 += B_reg1 * dA_reg9;
+        dC_acc1_2 += B_reg1 * dA_reg10;
+        dC_acc1_3 += B_reg1 * dA_reg11;
+        float B_reg2 = B[iv1_i_o][k_o * 2];
+        float dA_reg12 = dA[iv1_i_o][j_o * 4];
+        float dA_reg13 = dA[iv1_i_o][j_o * 4 + 1];
+        float dA_reg14 = dA[iv1_i_o][j_o * 4 + 2];
+        float dA_reg15 = dA[iv1_i_o][j_o * 4 + 3];
+        float B_reg3 = B[iv1_i_o][k_o * 2 + 1];
+        dC_acc0_0 += B_reg2 * dA_reg12;
+        dC_acc0_1 += B_reg2 * dA_reg13;
+        dC_acc0_2 += B_reg2 * dA_reg14;
+        dC_acc0_3 += B_reg2 * dA_reg15;
+        dC_acc1_0 += B_reg3 * dA_reg12;
+        dC_acc1_1 += B_reg3 * dA_reg13;
+        dC_acc1_2 += B_reg3 * dA_reg14;
+        dC_acc1_3 += B_reg3 * dA_reg15;
+        float B_reg4 = B[iv2_i_o][k_o * 2];
+        float dA_reg16 = dA[iv2_i_o][j_o * 4];
+        float dA_reg17 = dA[iv2_i_o][j_o * 4 + 1];
+        float dA_reg18 = dA[iv2_i_o][j_o * 4 + 2];
+        float dA_reg19 = dA[iv2_i_o][j_o * 4 + 3];
+        float B_reg5 = B[iv2_i_o][k_o * 2 + 1];
+        dC_acc0_0 += B_reg4 * dA_reg16;
+        dC_acc0_1 += B_reg4 * dA_reg17;
+        dC_acc0_2 += B_reg4 * dA_reg18;
+        dC_acc0_3 += B_reg4 * dA_reg19;
+        dC_acc1_0 += B_reg5 * dA_reg16;
+        dC_acc1_1 += B_reg5 * dA_reg17;
+        dC_acc1_2 += B_reg5 * dA_reg18;
+        dC_acc1_3 += B_reg5 * dA_reg19;
+        float B_reg6 = B[iv3_i_o][k_o * 2];
+        float dA_reg20 = dA[iv3_i_o][j_o * 4];
+        float dA_reg21 = dA[iv3_i_o][j_o * 4 + 1];
+        float dA_reg22 = dA[iv3_i_o][j_o * 4 + 2];
+        float dA_reg23 = dA[iv3_i_o][j_o * 4 + 3];
+        float B_reg7 = B[iv3_i_o][k_o * 2 + 1];
+        dC_acc0_0 += B_reg6 * dA_reg20;
+        dC_acc0_1 += B_reg6 * dA_reg21;
+        dC_acc0_2 += B_reg6 * dA_reg22;
+        dC_acc0_3 += B_reg6 * dA_reg23;
+        dC_acc1_0 += B_reg7 * dA_reg20;
+        dC_acc1_1 += B_reg7 * dA_reg21;
+        dC_acc1_2 += B_reg7 * dA_reg22;
+        dC_acc1_3 += B_reg7 * dA_reg23;
+        iv0_i_o += 4;
+        iv1_i_o += 4;
+        iv2_i_o += 4;
+        iv3_i_o += 4;
       }
+      dC[k_o * 2][j_o * 4] = dC_acc0_0;
+      dC[k_o * 2][j_o * 4 + 1] = dC_acc0_1;
+      dC[k_o * 2][j_o * 4 + 2] = dC_acc0_2;
+      dC[k_o * 2][j_o * 4 + 3] = dC_acc0_3;
+      dC[k_o * 2 + 1][j_o * 4] = dC_acc1_0;
+      dC[k_o * 2 + 1][j_o * 4 + 1] = dC_acc1_1;
+      dC[k_o * 2 + 1][j_o * 4 + 2] = dC_acc1_2;
+      dC[k_o * 2 + 1][j_o * 4 + 3] = dC_acc1_3;
     }
   }
 }
@@ -1,11 +1,94 @@
 #include "../run2.h"
 void grad_case5(float (&C)[32][32], float (&D)[4][32], float (&dA)[16][32], float (&dB)[16][32][4]) {
-  for(int i = 0; i < 16; ++i){
-    for(int k = 0; k < 32; ++k){
-      for(int l = 0; l < 4; ++l){
-        for(int j = 0; j < 32; ++j){
-          dB[i][k][l] += dA[i][j] * C[k][j] * D[l][j];
+  for(int k_L1 = 0; k_L1 < 2; ++k_L1){
+    for(int i = 0; i < 16; ++i){
+      for(int k_p_o = 0; k_p_o < 8; ++k_p_o){
+        float dB_acc0_0 = dB[i][k_L1 * 16 + k_p_o * 2][0];
+        float dB_acc0_1 = dB[i][k_L1 * 16 + k_p_o * 2][1];
+        float dB_acc0_2 = dB[i][k_L1 * 16 + k_p_o * 2][2];
+        float dB_acc0_3 = dB[i][k_L1 * 16 + k_p_o * 2][3];
+        float dB_acc1_0 = dB[i][k_L1 * 16 + (k_p_o * 2 + 1)][0];
+        float dB_acc1_1 = dB[i][k_L1 * 16 + (k_p_o * 2 + 1)][1];
+        float dB_acc1_2 = dB[i][k_L1 * 16 + (k_p_o * 2 + 1)][2];
+        float dB_acc1_3 = dB[i][k_L1 * 16 + (k_p_o * 2 + 1)][3];
+        int iv0_j_o = 0;
+        int iv1_j_o = 1;
+        int iv2_j_o = 2;
+        int iv3_j_o = 3;
+        for(int j_o = 0; j_o < 8; ++j_o){
+          float C_reg = C[k_L1 * 16 + k_p_o * 2][iv0_j_o];
+          float dA_reg = dA[i][iv0_j_o];
+          float D_reg = D[0][iv0_j_o];
+          float D_reg1 = D[1][iv0_j_o];
+          float D_reg2 = D[2][iv0_j_o];
+          float D_reg3 = D[3][iv0_j_o];
+          float C_reg1 = C[k_L1 * 16 + (k_p_o * 2 + 1)][iv0_j_o];
+          dB_acc0_0 += C_reg * dA_reg * D_reg;
+          dB_acc0_1 += C_reg * dA_reg * D_reg1;
+          dB_acc0_2 += C_reg * dA_reg * D_reg2;
+          dB_acc0_3 += C_reg * dA_reg * D_reg3;
+          dB_acc1_0 += C_reg1 * dA_reg * D_reg;
+          dB_acc1_1 += C_reg1 * dA_reg * D_reg1;
+          dB_acc1_2 += C_reg1 * dA_reg * D_reg2;
+          dB_acc1_3 += C_reg1 * dA_reg * D_reg3;
+          float C_reg2 = C[k_L1 * 16 + k_p_o * 2][iv1_j_o];
+          float dA_reg1 = dA[i][iv1_j_o];
+          float D_reg4 = D[0][iv1_j_o];
+          float D_reg5 = D[1][iv1_j_o];
+          float D_reg6 = D[2][iv1_j_o];
+          float D_reg7 = D[3][iv1_j_o];
+          float C_reg3 = C[k_L1 * 16 + (k_p_o * 2 + 1)][iv1_j_o];
+          dB_acc0_0 += C_reg2 * dA_reg1 * D_reg4;
+          dB_acc0_1 += C_reg2 * dA_reg1 * D_reg5;
+          dB_acc0_2 += C_reg2 * dA_reg1 * D_reg6;
+          dB_acc0_3 += C_reg2 * dA_reg1 * D_reg7;
+          dB_acc1_0 += C_reg3 * dA_reg1 * D_reg4;
+          dB_acc1_1 += C_reg3 * dA_reg1 * D_reg5;
+          dB_acc1_2 += C_reg3 * dA_reg1 * D_reg6;
+          dB_acc1_3 += C_reg3 * dA_reg1 * D_reg7;
+          float C_reg4 = C[k_L1 * 16 + k_p_o * 2][iv2_j_o];
+          float dA_reg2 = dA[i][iv2_j_o];
+          float D_reg8 = D[0][iv2_j_o];
+          float D_reg9 = D[1][iv2_j_o];
+          float D_reg10 = D[2][iv2_j_o];
+          float D_reg11 = D[3][iv2_j_o];
+          float C_reg5 = C[k_L1 * 16 + (k_p_o * 2 + 1)][iv2_j_o];
+          dB_acc0_0 += C_reg4 * dA_reg2 * D_reg8;
+          dB_acc0_1 += C_reg4 * dA_reg2 * D_reg9;
+          dB_acc0_2 += C_reg4 * dA_reg2 * D_reg10;
+          dB_acc0_3 += C_reg4 * dA_reg2 * D_reg11;
+          dB_acc1_0 += C_reg5 * dA_reg2 * D_reg8;
+          dB_acc1_1 += C_reg5 * dA_reg2 * D_reg9;
+          dB_acc1_2 += C_reg5 * dA_reg2 * D_reg10;
+          dB_acc1_3 += C_reg5 * dA_reg2 * D_reg11;
+          float C_reg6 = C[k_L1 * 16 + k_p_o * 2][iv3_j_o];
+          float dA_reg3 = dA[i][iv3_j_o];
+          float D_reg12 = D[0][iv3_j_o];
+          float D_reg13 = D[1][iv3_j_o];
+          float D_reg14 = D[2][iv3_j_o];
+          float D_reg15 = D[3][iv3_j_o];
+          float C_reg7 = C[k_L1 * 16 + (k_p_o * 2 + 1)][iv3_j_o];
+          dB_acc0_0 += C_reg6 * dA_reg3 * D_reg12;
+          dB_acc0_1 += C_reg6 * dA_reg3 * D_reg13;
+          dB_acc0_2 += C_reg6 * dA_reg3 * D_reg14;
+          dB_acc0_3 += C_reg6 * dA_reg3 * D_reg15;
+          dB_acc1_0 += C_reg7 * dA_reg3 * D_reg12;
+          dB_acc1_1 += C_reg7 * dA_reg3 * D_reg13;
+          dB_acc1_2 += C_reg7 * dA_reg3 * D_reg14;
+          dB_acc1_3 += C_reg7 * dA_reg3 * D_reg15;
+          iv0_j_o += 4;
+          iv1_j_o += 4;
+          iv2_j_o += 4;
+          iv3_j_o += 4;
         }
+        dB[i][k_L1 * 16 + k_p_o * 2][0] = dB_acc0_0;
+        dB[i][k_L1 * 16 + k_p_o * 2][1] = dB_acc0_1;
+        dB[i][k_L1 * 16 + k_p_o * 2][2] = dB_acc0_2;
+        dB[i][k_L1 * 16 + k_p_o * 2][3] = dB_acc0_3;
+        dB[i][k_L1 * 16 + (k_p_o * 2 + 1)][0] = dB_acc1_0;
+        dB[i][k_L1 * 16 + (k_p_o * 2 + 1)][1] = dB_acc1_1;
+        dB[i][k_L1 * 16 + (k_p_o * 2 + 1)][2] = dB_acc1_2;
+        dB[i][k_L1 * 16 + (k_p_o * 2 + 1)][3] = dB_acc1_3;
       }
     }
   }
@@ -1,8 +1,33 @@
 #include "../run2.h"
 void grad_case9(float (&dB)[4][6], float (&dA)[4]) {
-  for(int i = 0; i < 4; ++i){
-    for(int j = 0; j < 6; ++j){
-      dA[i] += dB[i][j];
-    }
+  float dA_acc0_0 = dA[0];
+  float dA_acc1_0 = dA[1];
+  float dA_acc2_0 = dA[2];
+  float dA_acc3_0 = dA[3];
+  int iv0_j_o = 0;
+  int iv1_j_o = 1;
+  for(int j_o = 0; j_o < 3; ++j_o){
+    float dB_reg = dB[0][iv0_j_o];
+    float dB_reg1 = dB[1][iv0_j_o];
+    float dB_reg2 = dB[2][iv0_j_o];
+    float dB_reg3 = dB[3][iv0_j_o];
+    dA_acc0_0 += dB_reg;
+    dA_acc1_0 += dB_reg1;
+    dA_acc2_0 += dB_reg2;
+    dA_acc3_0 += dB_reg3;
+    float dB_reg4 = dB[0][iv1_j_o];
+    float dB_reg5 = dB[1][iv1_j_o];
+    float dB_reg6 = dB[2][iv1_j_o];
+    float dB_reg7 = dB[3][iv1_j_o];
+    dA_acc0_0 += dB_reg4;
+    dA_acc1_0 += dB_reg5;
+    dA_acc2_0 += dB_reg6;
+    dA_acc3_0 += dB_reg7;
+    iv0_j_o += 2;
+    iv1_j_o += 2;
   }
+  dA[0] = dA_acc0_0;
+  dA[1] = dA_acc1_0;
+  dA[2] = dA_acc2_0;
+  dA[3] = dA_acc3_0;
 }
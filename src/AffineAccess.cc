@@ -0,0 +1,332 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <iomanip>
+
+#include "AffineAccess.h"
+#include "IRVisitor.h"
+#include "arith.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+AffineExpr non_affine() {
+    return AffineExpr();
+}
+
+
+AffineExpr constant_form(size_t num_loops, int64_t value) {
+    AffineExpr form;
+    form.affine = true;
+    form.coef.assign(num_loops, 0);
+    form.constant = value;
+    return form;
+}
+
+
+bool is_constant(const AffineExpr &form) {
+    for (auto c : form.coef) {
+        if (c != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+AffineExpr combine(const AffineExpr &a, const AffineExpr &b, int64_t scale_b) {
+    AffineExpr form = a;
+    for (size_t l = 0; l < form.coef.size(); ++l) {
+        form.coef[l] += scale_b * b.coef[l];
+    }
+    form.constant += scale_b * b.constant;
+    return form;
+}
+
+
+AffineExpr scale(const AffineExpr &a, int64_t factor) {
+    AffineExpr form = constant_form(a.coef.size(), 0);
+    return combine(form, a, factor);
+}
+
+
+/**
+ * collects the Var nodes of an expression, loads inside subscripts included
+ */ 
+class VarCollector : public IRVisitor {
+ public:
+    std::vector<Expr> vars;
+
+    void visit(Ref<const Var> op) override {
+        vars.push_back(op);
+        IRVisitor::visit(op);
+    }
+};
+
+
+class AccessCollector : public IRVisitor {
+ public:
+    std::vector<StmtAccesses> result;
+
+    void visit(Ref<const LoopNest> op) override {
+        size_t depth = loops.size();
+        Arith::Bounds bounds;
+        for (auto &index : op->index_list) {
+            auto idx = index.as<Index>();
+            auto dom = idx->dom.as<Dom>();
+            Arith::Interval begin = bounds(dom->begin);
+            Arith::Interval extent = bounds(dom->extent);
+            loops.push_back(Loop{idx->name, index, begin.is_point() ? begin.min : 0,
+                extent.is_point() ? extent.min : -1, op});
+        }
+        for (auto &body : op->body_list) {
+            body.visit_stmt(this);
+        }
+        loops.resize(depth);
+    }
+
+    void visit(Ref<const Move> op) override {
+        add_statement(op, op->dst, op->src);
+    }
+
+    void visit(Ref<const Reduce> op) override {
+        add_statement(op, op->dst, op->value);
+    }
+
+ private:
+    std::vector<Loop> loops;
+
+    void add_statement(const Stmt &move, const Expr &dst_expr, const Expr &src_expr) {
+        StmtAccesses stmt;
+        stmt.move = move;
+        stmt.loops = loops;
+        std::vector<std::string> names;
+        for (auto &loop : loops) {
+            names.push_back(loop.name);
+        }
+        VarCollector dst, src;
+        dst_expr.visit_expr(&dst);
+        src_expr.visit_expr(&src);
+        for (size_t i = 0; i < dst.vars.size(); ++i) {
+            // loads inside the destination subscripts are reads
+            stmt.accesses.push_back(make_access(dst.vars[i], i == 0, names));
+        }
+        for (auto &var : src.vars) {
+            stmt.accesses.push_back(make_access(var, false, names));
+        }
+        result.push_back(stmt);
+    }
+
+    static Access make_access(const Expr &var, bool is_write, const std::vector<std::string> &names) {
+        Access access;
+        access.var = var;
+        access.is_write = is_write;
+        for (auto &arg : var.as<Var>()->args) {
+            access.subscripts.push_back(affine_form(arg, names));
+        }
+        return access;
+    }
+};
+
+}  // anonymous namespace
+
+
+AffineExpr affine_form(const Expr &e, const std::vector<std::string> &loops) {
+    switch (e->node_type()) {
+        case IRNodeType::IntImm:
+            return constant_form(loops.size(), e.as<IntImm>()->value());
+        case IRNodeType::Index: {
+            const std::string &name = e.as<Index>()->name;
+            for (size_t l = 0; l < loops.size(); ++l) {
+                if (loops[l] == name) {
+                    AffineExpr form = constant_form(loops.size(), 0);
+                    form.coef[l] = 1;
+                    return form;
+                }
+            }
+            return non_affine();
+        }
+        case IRNodeType::Unary: {
+            auto op = e.as<Unary>();
+            if (op->op_type != UnaryOpType::Neg) {
+                return non_affine();
+            }
+            AffineExpr a = affine_form(op->a, loops);
+            return a.affine ? scale(a, -1) : a;
+        }
+        case IRNodeType::Binary: {
+            auto op = e.as<Binary>();
+            AffineExpr a = affine_form(op->a, loops);
+            AffineExpr b = affine_form(op->b, loops);
+            if (!a.affine || !b.affine) {
+                return non_affine();
+            }
+            switch (op->op_type) {
+                case BinaryOpType::Add:
+                    return combine(a, b, 1);
+                case BinaryOpType::Sub:
+                    return combine(a, b, -1);
+                case BinaryOpType::Mul:
+                    if (is_constant(a)) {
+                        return scale(b, a.constant);
+                    }
+                    if (is_constant(b)) {
+                        return scale(a, b.constant);
+                    }
+                    return non_affine();
+                default:
+                    // a constant divided by a constant is still a constant
+                    if (is_constant(a) && is_constant(b) && b.constant != 0) {
+                        if (op->op_type == BinaryOpType::Div) {
+                            return constant_form(loops.size(), a.constant / b.constant);
+                        }
+                        if (op->op_type == BinaryOpType::Mod) {
+                            return constant_form(loops.size(), a.constant % b.constant);
+                        }
+                    }
+                    return non_affine();
+            }
+        }
+        default:
+            return non_affine();
+    }
+}
+
+
+bool Access::affine() const {
+    for (auto &subscript : subscripts) {
+        if (!subscript.affine) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int64_t Access::stride(size_t loop) const {
+    const std::vector<size_t> &shape = var.as<Var>()->shape;
+    int64_t dim_stride = 1;
+    int64_t result = 0;
+    for (size_t d = subscripts.size(); d-- > 0;) {
+        if (subscripts[d].affine) {
+            result += subscripts[d].coef[loop] * dim_stride;
+        }
+        dim_stride *= d < shape.size() ? static_cast<int64_t>(shape[d]) : 1;
+    }
+    return result;
+}
+
+
+bool Access::invariant(size_t loop) const {
+    for (auto &subscript : subscripts) {
+        if (!subscript.affine || subscript.coef[loop] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int StmtAccesses::unit_stride_loop(size_t access) const {
+    const Access &a = accesses[access];
+    if (!a.affine()) {
+        return -1;
+    }
+    for (size_t l = loops.size(); l-- > 0;) {
+        int64_t s = a.stride(l);
+        if (s == 1 || s == -1) {
+            return static_cast<int>(l);
+        }
+    }
+    return -1;
+}
+
+
+int64_t StmtAccesses::reuse_distance(size_t access, size_t loop) const {
+    if (!accesses[access].invariant(loop)) {
+        return -1;
+    }
+    int64_t distance = 1;
+    for (size_t l = loop + 1; l < loops.size(); ++l) {
+        if (loops[l].extent < 0) {
+            return -1;
+        }
+        distance *= loops[l].extent;
+    }
+    return distance;
+}
+
+
+void StmtAccesses::dump(std::ostream &out) const {
+    out << "loops:";
+    for (auto &loop : loops) {
+        out << " " << loop.name << "[" << loop.begin << ", +" << loop.extent << ")";
+    }
+    out << "\n";
+    for (size_t a = 0; a < accesses.size(); ++a) {
+        const Access &access = accesses[a];
+        out << "  " << (access.is_write ? "write " : "read  ") << std::left << std::setw(8) << access.name()
+            << std::right;
+        if (!access.affine()) {
+            out << " not affine\n";
+            continue;
+        }
+        out << " strides";
+        for (size_t l = 0; l < loops.size(); ++l) {
+            out << " " << loops[l].name << ":" << access.stride(l);
+        }
+        int unit = unit_stride_loop(a);
+        out << ", unit stride " << (unit < 0 ? std::string("none") : loops[unit].name);
+        out << ", reuse";
+        for (size_t l = 0; l < loops.size(); ++l) {
+            int64_t distance = reuse_distance(a, l);
+            if (distance >= 0) {
+                out << " " << loops[l].name << ":" << distance;
+            }
+        }
+        out << "\n";
+    }
+}
+
+
+std::vector<StmtAccesses> analyze_accesses(const Group &kernel) {
+    AccessCollector collector;
+    kernel.visit_group(&collector);
+    return collector.result;
+}
+
+
+std::vector<StmtAccesses> analyze_accesses(const Stmt &stmt) {
+    AccessCollector collector;
+    stmt.visit_stmt(&collector);
+    return collector.result;
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
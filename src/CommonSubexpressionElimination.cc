@@ -0,0 +1,352 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+#include "CommonSubexpressionElimination.h"
+#include "IRFunctor.h"
+#include "IRUtil.h"
+#include "IRVisitor.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+bool is_commutative(BinaryOpType op) {
+    return op == BinaryOpType::Add || op == BinaryOpType::Mul
+        || op == BinaryOpType::And || op == BinaryOpType::Or;
+}
+
+
+/**
+ * And and Or, whose right operand runs only for some left operands
+ */ 
+bool is_short_circuit(const IRNode *node) {
+    if (node->node_type() != IRNodeType::Binary) {
+        return false;
+    }
+    BinaryOpType op = static_cast<const Binary*>(node)->op_type;
+    return op == BinaryOpType::And || op == BinaryOpType::Or;
+}
+
+
+/**
+ * numbers the subexpressions of a statement so that equal ones,
+ * commutative operands swapped included, share a class, and counts the
+ * uses of each class. A repeated subexpression is counted once inside:
+ * its parts are computed only by its first occurrence. Only the parts
+ * that always run are counted: not the values of a Select nor the right
+ * operand of And and Or, which binding would run unconditionally
+ */ 
+class ValueNumbering {
+ public:
+    std::unordered_map<const IRNode*, int> classes;
+    std::vector<int> uses;
+    std::vector<bool> bindable;
+
+    int number(const IRNode *node) {
+        auto found = classes.find(node);
+        if (found != classes.end()) {
+            return found->second;
+        }
+        std::vector<int> children;
+        if (node->node_type() != IRNodeType::Index) {
+            for_each_child(node, [&](const IRNode *child) { children.push_back(number(child)); });
+        }
+        const ExprNode *expr = static_cast<const ExprNode*>(node);
+        std::ostringstream key;
+        key << static_cast<int>(node->node_type()) << ":" << expr->type().hash() << ":";
+        bool bind = false;
+        switch (node->node_type()) {
+            case IRNodeType::Binary: {
+                BinaryOpType op = static_cast<const Binary*>(node)->op_type;
+                if (is_commutative(op)) {
+                    std::sort(children.begin(), children.end());
+                }
+                key << static_cast<int>(op);
+                bind = true;
+                break;
+            }
+            case IRNodeType::Unary:
+                key << static_cast<int>(static_cast<const Unary*>(node)->op_type);
+                bind = true;
+                break;
+            case IRNodeType::Compare:
+                key << static_cast<int>(static_cast<const Compare*>(node)->op_type);
+                bind = true;
+                break;
+            case IRNodeType::Select:
+                bind = true;
+                break;
+            case IRNodeType::Cast:
+                key << static_cast<const Cast*>(node)->new_type.hash();
+                bind = true;
+                break;
+            case IRNodeType::Var:
+                // a load, scalars are already as cheap as a temporary
+                key << static_cast<const Var*>(node)->name;
+                bind = !static_cast<const Var*>(node)->args.empty();
+                break;
+            case IRNodeType::Index:
+                key << static_cast<const Index*>(node)->name;
+                break;
+            case IRNodeType::Ramp:
+                // vector subscripts and broadcasts, shared with the loads they are part of
+                key << static_cast<const Ramp*>(node)->stride << ":" << static_cast<const Ramp*>(node)->lanes;
+                break;
+            case IRNodeType::IntImm:
+                key << static_cast<const IntImm*>(node)->value();
+                break;
+            case IRNodeType::UIntImm:
+                key << static_cast<const UIntImm*>(node)->value();
+                break;
+            case IRNodeType::FloatImm: {
+                double value = static_cast<const FloatImm*>(node)->value();
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                key << bits;
+                break;
+            }
+            default:
+                // never shared
+                key << node;
+                break;
+        }
+        for (auto child : children) {
+            key << "," << child;
+        }
+        const Type &t = expr->type();
+        bind = bind && t.dim() == 1 && (t.is_int() || t.is_float());
+
+        auto inserted = ids.emplace(key.str(), static_cast<int>(uses.size()));
+        if (inserted.second) {
+            uses.push_back(0);
+            bindable.push_back(bind);
+        }
+        classes[node] = inserted.first->second;
+        return inserted.first->second;
+    }
+
+    void count(const IRNode *node) {
+        if (++uses[number(node)] > 1 || node->node_type() == IRNodeType::Index) {
+            return;
+        }
+        if (node->node_type() == IRNodeType::Select) {
+            count(static_cast<const Select*>(node)->cond.get());
+        } else if (is_short_circuit(node)) {
+            count(static_cast<const Binary*>(node)->a.get());
+        } else {
+            for_each_child(node, [this](const IRNode *child) { count(child); });
+        }
+    }
+
+    bool shared(const IRNode *node) const {
+        int id = classes.at(node);
+        return bindable[id] && uses[id] > 1;
+    }
+
+ private:
+    std::map<std::string, int> ids;
+};
+
+
+/**
+ * replaces repeated subexpressions by temporaries, collecting their
+ * definitions in dependence order
+ */ 
+class Binder : public IRMutator {
+ public:
+    std::vector<Stmt> lets;
+
+    Binder(CommonSubexpressionElimination &_pass, const ValueNumbering &_numbering) :
+        IRMutator(false), pass(_pass), numbering(_numbering) {}
+
+    Expr visit(Ref<const Unary> op) override {
+        return bind(op);
+    }
+
+    Expr visit(Ref<const Binary> op) override {
+        if (!is_short_circuit(op.get())) {
+            return bind(op);
+        }
+        // the right operand is left as it is, see ValueNumbering
+        return bind(op, [&]() {
+            Expr a = mutate(op->a);
+            return a.get() == op->a.get() ? Expr(op) : Binary::make(op->type(), op->op_type, a, op->b);
+        });
+    }
+
+    Expr visit(Ref<const Select> op) override {
+        return bind(op, [&]() {
+            Expr cond = mutate(op->cond);
+            return cond.get() == op->cond.get() ? Expr(op)
+                : Select::make(op->type(), cond, op->true_value, op->false_value);
+        });
+    }
+
+    Expr visit(Ref<const Compare> op) override {
+        return bind(op);
+    }
+
+    Expr visit(Ref<const Cast> op) override {
+        return bind(op);
+    }
+
+    Expr visit(Ref<const Var> op) override {
+        return bind(op);
+    }
+
+    /**
+     * the destination stays a store, only its subscripts are rewritten
+     */ 
+    Expr store(const Expr &dst) {
+        auto var = dst.as<Var>();
+        if (var == nullptr) {
+            return mutate(dst);
+        }
+        return IRMutator::visit(var);
+    }
+
+ private:
+    CommonSubexpressionElimination &pass;
+    const ValueNumbering &numbering;
+    std::map<int, Expr> temps;
+
+    template <typename T>
+    Expr bind(Ref<const T> op) {
+        return bind(op, [&]() { return IRMutator::visit(op); });
+    }
+
+    /**
+     * rebuild makes the node from its rewritten children
+     */ 
+    template <typename T, typename Rebuild>
+    Expr bind(Ref<const T> op, Rebuild rebuild) {
+        int id = numbering.classes.at(op.get());
+        auto found = temps.find(id);
+        if (found != temps.end()) {
+            return found->second;
+        }
+        Expr result = rebuild();
+        if (!numbering.shared(op.get())) {
+            return result;
+        }
+        Expr temp = pass.make_temp(op->type());
+        lets.push_back(Move::make(temp, result, MoveType::MemToLocal));
+        temps[id] = temp;
+        return temp;
+    }
+};
+
+
+bool is_compute(const Stmt &stmt) {
+    auto move = stmt.as<Move>();
+    return stmt.as<Reduce>() != nullptr || (move != nullptr && move->move_type == MoveType::MemToMem);
+}
+
+}  // anonymous namespace
+
+
+Group CommonSubexpressionElimination::visit(Ref<const Kernel> op) {
+    NameCollector names;
+    Group(op).visit_group(&names);
+    taken.insert(names.names.begin(), names.names.end());
+    return IRMutator::visit(op);
+}
+
+
+Expr CommonSubexpressionElimination::make_temp(Type t) {
+    std::string name;
+    do {
+        name = "cse" + std::to_string(next_temp++);
+    } while (taken.count(name));
+    taken.insert(name);
+    return Var::make(t, name, {}, {1});
+}
+
+
+std::vector<Stmt> CommonSubexpressionElimination::eliminate(const Stmt &stmt) {
+    auto move = stmt.as<Move>();
+    auto reduce = stmt.as<Reduce>();
+    Expr dst = move != nullptr ? move->dst : reduce->dst;
+    Expr src = move != nullptr ? move->src : reduce->value;
+
+    ValueNumbering numbering;
+    if (auto var = dst.as<Var>()) {
+        for (auto &arg : var->args) {
+            numbering.count(arg.get());
+        }
+    }
+    numbering.count(src.get());
+
+    Binder binder(*this, numbering);
+    Expr new_dst = binder.store(dst);
+    Expr new_src = binder.mutate(src);
+    if (binder.lets.empty()) {
+        return {stmt};
+    }
+    std::vector<Stmt> result = binder.lets;
+    result.push_back(move != nullptr ? Move::make(new_dst, new_src, move->move_type)
+        : Reduce::make(new_dst, new_src, reduce->combiner, reduce->identity, reduce->axes));
+    return result;
+}
+
+
+Stmt CommonSubexpressionElimination::visit(Ref<const LoopNest> op) {
+    std::vector<Stmt> new_body_list;
+    bool changed = false;
+    for (auto &body : op->body_list) {
+        std::vector<Stmt> stmts = is_compute(body) ? eliminate(body) : std::vector<Stmt>{mutate(body)};
+        changed = changed || stmts.size() != 1 || stmts[0].get() != body.get();
+        new_body_list.insert(new_body_list.end(), stmts.begin(), stmts.end());
+    }
+    if (!changed) {
+        return op;
+    }
+    return LoopNest::make(op->index_list, new_body_list);
+}
+
+
+Stmt CommonSubexpressionElimination::visit(Ref<const If> op) {
+    if (!is_compute(op->true_case)) {
+        return IRMutator::visit(op);
+    }
+    std::vector<Stmt> stmts = eliminate(op->true_case);
+    if (stmts.size() == 1) {
+        return op;
+    }
+    // a nest without loops is a block
+    return If::make(op->cond, LoopNest::make({}, stmts));
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
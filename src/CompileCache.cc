@@ -0,0 +1,197 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#include "CompileCache.h"
+#include "IRSerialize.h"
+#include "hash.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+bool read_file(const std::string &path, std::string &content) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::ostringstream oss;
+    oss << in.rdbuf();
+    content = oss.str();
+    return true;
+}
+
+
+// write aside and rename, so a concurrent reader never sees half a file
+void write_atomic(const std::string &path, const std::string &content) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return;
+        }
+        out << content;
+    }
+    std::rename(tmp.c_str(), path.c_str());
+}
+
+
+// an entry is "<options>\n<IR size>\n<serialized IR><code>"
+bool split_entry(const std::string &entry, std::string &options, std::string &ir, std::string &code) {
+    size_t options_end = entry.find('\n');
+    if (options_end == std::string::npos) {
+        return false;
+    }
+    size_t size_end = entry.find('\n', options_end + 1);
+    if (size_end == std::string::npos) {
+        return false;
+    }
+    size_t ir_size = std::strtoull(entry.c_str() + options_end + 1, nullptr, 10);
+    if (ir_size > entry.size() - size_end - 1) {
+        return false;
+    }
+    options = entry.substr(0, options_end);
+    ir = entry.substr(size_end + 1, ir_size);
+    code = entry.substr(size_end + 1 + ir_size);
+    return true;
+}
+
+}  // anonymous namespace
+
+
+bool write_if_changed(const std::string &path, const std::string &content) {
+    std::string old;
+    if (read_file(path, old) && old == content) {
+        return false;
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    CHECK(out, "can't write %s\n", path.c_str());
+    out << content;
+    return true;
+}
+
+
+CompileCache::CompileCache(const std::string &_dir, const std::string &_options) :
+    dir_(_dir), options_(_options), hits_(0), misses_(0) {
+    // an existing directory is fine, a failure shows up as misses and failed stores
+#ifdef _WIN32
+    _mkdir(dir_.c_str());
+#else
+    mkdir(dir_.c_str(), 0755);
+#endif
+}
+
+
+uint64_t CompileCache::key(const Group &kernel) const {
+    uint64_t h = hash_combine(kernel->structural_hash(), hash_string(options_));
+    return hash_combine(h, format_version);
+}
+
+
+bool CompileCache::lookup(const Group &kernel, std::string &code) {
+    std::string entry, options, ir;
+    if (read_file(entry_path(key(kernel)), entry) && split_entry(entry, options, ir, code)
+        && options == options_ && ir == serialize_ir({kernel})) {
+        hits_ += 1;
+        return true;
+    }
+    misses_ += 1;
+    return false;
+}
+
+
+void CompileCache::store(const Group &kernel, const std::string &code) {
+    std::string ir = serialize_ir({kernel});
+    write_atomic(entry_path(key(kernel)), options_ + "\n" + std::to_string(ir.size()) + "\n" + ir + code);
+}
+
+
+bool CompileCache::erase(uint64_t key) {
+    return std::remove(entry_path(key).c_str()) == 0;
+}
+
+
+// a record is "<options>\n<entry key>\n"
+void CompileCache::record_output(const std::string &path, const Group &kernel) {
+    char line[32];
+    snprintf(line, sizeof(line), "%016llx\n", static_cast<unsigned long long>(key(kernel)));
+    write_atomic(output_path(path), options_ + "\n" + line);
+}
+
+
+bool CompileCache::output_is_current(const std::string &path) const {
+    std::string record;
+    if (!read_file(output_path(path), record) || record.compare(0, options_.size() + 1, options_ + "\n") != 0) {
+        return false;
+    }
+    uint64_t key = std::strtoull(record.c_str() + options_.size() + 1, nullptr, 16);
+    std::string entry, options, ir, code, output;
+    return read_file(entry_path(key), entry) && split_entry(entry, options, ir, code)
+        && options == options_ && read_file(path, output) && output == code;
+}
+
+
+bool CompileCache::erase_output(const std::string &path) {
+    return std::remove(output_path(path).c_str()) == 0;
+}
+
+
+std::string CompileCache::report() const {
+    std::ostringstream oss;
+    oss << "kernel cache: " << hits_ << " hits, " << misses_ << " misses";
+    return oss.str();
+}
+
+
+std::string CompileCache::entry_path(uint64_t key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.cc", static_cast<unsigned long long>(key));
+    return dir_ + "/" + name;
+}
+
+
+std::string CompileCache::output_path(const std::string &path) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.out", static_cast<unsigned long long>(hash_string(path)));
+    return dir_ + "/" + name;
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
+
@@ -0,0 +1,283 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "CostModel.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+/* trip count assumed for loops whose extent is not constant */
+const int64_t assumed_extent = 64;
+
+
+bool read_line(const std::string &path, std::string &value) {
+    std::ifstream in(path);
+    return static_cast<bool>(std::getline(in, value));
+}
+
+
+/**
+ * "48K", "2048K", "32M"
+ */ 
+int64_t parse_size(const std::string &text) {
+    char *end = nullptr;
+    int64_t value = std::strtoll(text.c_str(), &end, 10);
+    if (*end == 'K') {
+        value <<= 10;
+    } else if (*end == 'M') {
+        value <<= 20;
+    } else if (*end == 'G') {
+        value <<= 30;
+    }
+    return value;
+}
+
+
+/**
+ * one loop of the schedule after strip-mining, running original loop
+ * `loop` in steps of `step`
+ */ 
+struct VirtualLoop {
+    size_t loop;
+    int64_t step;
+    int64_t extent;
+};
+
+
+std::vector<VirtualLoop> schedule_loops(const StmtAccesses &stmt, const LoopSchedule &schedule) {
+    std::vector<VirtualLoop> result;
+    auto extent_of = [&](size_t loop) {
+        int64_t extent = stmt.loops[loop].extent;
+        return extent < 0 ? assumed_extent : extent;
+    };
+    auto tile_of = [&](size_t loop) -> int64_t {
+        if (loop >= schedule.tiles.size() || schedule.tiles[loop] <= 0) {
+            return 0;
+        }
+        return schedule.tiles[loop] < extent_of(loop) ? schedule.tiles[loop] : 0;
+    };
+    for (auto loop : schedule.order) {
+        int64_t tile = tile_of(loop);
+        if (tile > 0) {
+            result.push_back(VirtualLoop{loop, tile, (extent_of(loop) + tile - 1) / tile});
+        }
+    }
+    for (auto loop : schedule.order) {
+        int64_t tile = tile_of(loop);
+        result.push_back(VirtualLoop{loop, 1, tile > 0 ? tile : extent_of(loop)});
+    }
+    return result;
+}
+
+
+class Footprint {
+ public:
+    Footprint(const StmtAccesses &stmt, const std::vector<VirtualLoop> &_loops, int64_t _line) :
+        loops(_loops), line(_line) {
+        for (auto &access : stmt.accesses) {
+            bool duplicate = false;
+            for (auto other : accesses) {
+                duplicate = duplicate || (other->name() == access.name() && same_subscripts(*other, access));
+            }
+            if (!duplicate) {
+                accesses.push_back(&access);
+            }
+        }
+    }
+
+    size_t num_accesses() const {
+        return accesses.size();
+    }
+
+    /**
+     * cache lines access a touches while the loops from level inward run
+     */ 
+    int64_t lines(size_t a, size_t level) const {
+        const Access &access = *accesses[a];
+        auto var = access.var.as<Var>();
+        int64_t elem_bytes = std::max(1, var->type().bits / 8);
+        int64_t result = 1;
+        size_t dims = var->shape.size();
+        for (size_t d = 0; d < dims; ++d) {
+            int64_t extent = static_cast<int64_t>(var->shape[d]);
+            int64_t span = extent;
+            int64_t count = extent;
+            if (d < access.subscripts.size() && access.subscripts[d].affine) {
+                span = 1;
+                count = 1;
+                for (size_t v = level; v < loops.size(); ++v) {
+                    int64_t c = access.subscripts[d].coef[loops[v].loop];
+                    if (c != 0) {
+                        span += std::abs(c) * loops[v].step * (loops[v].extent - 1);
+                        count *= loops[v].extent;
+                    }
+                }
+                span = std::min(span, extent);
+                count = std::min(count, extent);
+            }
+            if (d + 1 < dims) {
+                result *= std::min(span, count);
+            } else {
+                result *= std::min(count, (span * elem_bytes + line - 1) / line);
+            }
+        }
+        return result;
+    }
+
+    int64_t bytes(size_t level) const {
+        int64_t total = 0;
+        for (size_t a = 0; a < accesses.size(); ++a) {
+            total += lines(a, level) * line;
+        }
+        return total;
+    }
+
+ private:
+    const std::vector<VirtualLoop> &loops;
+    int64_t line;
+    std::vector<const Access*> accesses;
+
+    static bool same_subscripts(const Access &a, const Access &b) {
+        if (!a.affine() || !b.affine() || a.subscripts.size() != b.subscripts.size()) {
+            return false;
+        }
+        for (size_t d = 0; d < a.subscripts.size(); ++d) {
+            if (a.subscripts[d].coef != b.subscripts[d].coef || a.subscripts[d].constant != b.subscripts[d].constant) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+}  // anonymous namespace
+
+
+std::vector<CacheLevel> host_caches() {
+    std::vector<CacheLevel> result;
+    for (int index = 0; ; ++index) {
+        std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+        std::string level, type, size, line;
+        if (!read_line(dir + "level", level)) {
+            break;
+        }
+        if (!read_line(dir + "type", type) || type == "Instruction" || !read_line(dir + "size", size)) {
+            continue;
+        }
+        if (!read_line(dir + "coherency_line_size", line)) {
+            line = "64";
+        }
+        result.push_back(CacheLevel{std::atoi(level.c_str()), parse_size(size), parse_size(line)});
+    }
+    if (result.empty()) {
+        result = {CacheLevel{1, 32 << 10, 64}, CacheLevel{2, 1 << 20, 64}, CacheLevel{3, 32 << 20, 64}};
+    }
+    std::sort(result.begin(), result.end(), [](const CacheLevel &a, const CacheLevel &b) {
+        return a.level < b.level;
+    });
+    return result;
+}
+
+
+void CostEstimate::dump(std::ostream &out) const {
+    out << "footprint bytes per level:";
+    for (auto bytes : footprint) {
+        out << " " << bytes;
+    }
+    out << "\nmisses per cache:";
+    for (auto m : misses) {
+        out << " " << m;
+    }
+    out << "\niterations " << iterations << ", predicted " << time_ns / 1e6 << " ms\n";
+}
+
+
+CostEstimate CostModel::estimate(const StmtAccesses &stmt, const LoopSchedule &schedule) const {
+    std::vector<VirtualLoop> loops = schedule_loops(stmt, schedule);
+    int64_t line = caches.empty() ? 64 : caches[0].line;
+    Footprint footprint(stmt, loops, line);
+
+    CostEstimate result;
+    for (size_t level = 0; level <= loops.size(); ++level) {
+        result.footprint.push_back(footprint.bytes(level));
+    }
+    std::vector<double> trips(1, 1.0);
+    for (auto &loop : loops) {
+        trips.push_back(trips.back() * loop.extent);
+    }
+    result.iterations = trips.back();
+    result.time_ns = result.iterations * footprint.num_accesses() * params.access_ns;
+
+    for (size_t c = 0; c < caches.size(); ++c) {
+        // outermost level whose data stays in this cache
+        size_t level = 0;
+        while (level < loops.size() && result.footprint[level] > caches[c].size) {
+            ++level;
+        }
+        double misses = 0;
+        for (size_t a = 0; a < footprint.num_accesses(); ++a) {
+            misses += static_cast<double>(footprint.lines(a, level)) * trips[level];
+        }
+        result.misses.push_back(misses);
+        if (!params.miss_ns.empty()) {
+            result.time_ns += misses * params.miss_ns[std::min(c, params.miss_ns.size() - 1)];
+        }
+    }
+    return result;
+}
+
+
+std::vector<size_t> CostModel::best_order(const StmtAccesses &stmt,
+    std::function<bool(const std::vector<size_t>&)> legal) const {
+    std::vector<size_t> order(stmt.loops.size());
+    for (size_t l = 0; l < order.size(); ++l) {
+        order[l] = l;
+    }
+    std::vector<size_t> best = order;
+    double best_time = estimate(stmt, LoopSchedule{order, {}}).time_ns;
+    while (std::next_permutation(order.begin(), order.end())) {
+        if (legal && !legal(order)) {
+            continue;
+        }
+        double time = estimate(stmt, LoopSchedule{order, {}}).time_ns;
+        if (time < best_time) {
+            best_time = time;
+            best = order;
+        }
+    }
+    return best;
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
@@ -0,0 +1,382 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <algorithm>
+
+#include "Dependence.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+const int64_t unknown = Dependence::unknown_distance;
+
+
+int64_t gcd(int64_t a, int64_t b) {
+    a = a < 0 ? -a : a;
+    b = b < 0 ? -b : b;
+    while (b != 0) {
+        int64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+
+/**
+ * [lo, hi] of a linear function, accumulated term by term
+ */ 
+struct Range {
+    int64_t lo = 0;
+    int64_t hi = 0;
+    bool bounded = true;
+
+    void add(int64_t a, int64_t b) {
+        lo += std::min(a, b);
+        hi += std::max(a, b);
+    }
+
+    void add(std::initializer_list<int64_t> vertices) {
+        add(*std::min_element(vertices.begin(), vertices.end()), *std::max_element(vertices.begin(), vertices.end()));
+    }
+};
+
+
+class Tester {
+ public:
+    Tester(const StmtAccesses &_s1, const Access &_a, const StmtAccesses &_s2, const Access &_b, size_t _common) :
+        s1(_s1), a(_a), s2(_s2), b(_b), common(_common) {}
+
+    /**
+     * whether some pair of iterations with directions dirs touches the same element
+     */ 
+    bool feasible(const std::vector<Direction> &dirs) const {
+        if (!a.affine() || !b.affine() || a.subscripts.size() != b.subscripts.size()) {
+            return true;
+        }
+        for (size_t d = 0; d < a.subscripts.size(); ++d) {
+            if (!feasible_dim(a.subscripts[d], b.subscripts[d], dirs)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * y - x on loop l when every equation pins it, unknown otherwise
+     */ 
+    int64_t distance(size_t l) const {
+        if (!a.affine() || !b.affine()) {
+            return unknown;
+        }
+        int64_t result = unknown;
+        for (size_t d = 0; d < a.subscripts.size(); ++d) {
+            const AffineExpr &fa = a.subscripts[d];
+            const AffineExpr &fb = b.subscripts[d];
+            // a uniform subscript in loop l alone: a_l * (x - y) = cb - ca
+            if (fa.coef[l] == 0 || fa.coef[l] != fb.coef[l] || !only_loop(fa, l) || !only_loop(fb, l)) {
+                continue;
+            }
+            int64_t diff = fa.constant - fb.constant;
+            if (diff % fa.coef[l] != 0) {
+                continue;
+            }
+            int64_t dist = diff / fa.coef[l];
+            if (result != unknown && result != dist) {
+                return unknown;
+            }
+            result = dist;
+        }
+        return result;
+    }
+
+ private:
+    const StmtAccesses &s1;
+    const Access &a;
+    const StmtAccesses &s2;
+    const Access &b;
+    size_t common;
+
+    static bool only_loop(const AffineExpr &f, size_t l) {
+        for (size_t k = 0; k < f.coef.size(); ++k) {
+            if (k != l && f.coef[k] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * fa(x) - fb(y) = 0 for some x, y within the loop bounds and dirs
+     */ 
+    bool feasible_dim(const AffineExpr &fa, const AffineExpr &fb, const std::vector<Direction> &dirs) const {
+        int64_t constant = fa.constant - fb.constant;
+        int64_t g = 0;
+        Range range;
+        for (size_t l = 0; l < common; ++l) {
+            int64_t ca = fa.coef[l];
+            int64_t cb = fb.coef[l];
+            const Loop &loop = s1.loops[l];
+            if (loop.extent < 0) {
+                range.bounded = false;
+            }
+            int64_t lo = loop.begin;
+            int64_t hi = loop.begin + loop.extent - 1;
+            Direction dir = l < dirs.size() ? dirs[l] : Direction::Any;
+            if (dir == Direction::Equal) {
+                g = gcd(g, ca - cb);
+                range.add((ca - cb) * lo, (ca - cb) * hi);
+                continue;
+            }
+            g = gcd(gcd(g, ca), cb);
+            if (dir == Direction::Any) {
+                range.add(ca * lo, ca * hi);
+                range.add(-cb * lo, -cb * hi);
+            } else if (loop.extent < 0) {
+                continue;
+            } else if (hi - lo < 1) {
+                // no two distinct iterations
+                return false;
+            } else if (dir == Direction::Less) {
+                // x < y: the vertices of the triangle lo <= x < y <= hi
+                range.add({ca * lo - cb * (lo + 1), ca * lo - cb * hi, ca * (hi - 1) - cb * hi});
+            } else {
+                range.add({ca * (lo + 1) - cb * lo, ca * hi - cb * lo, ca * hi - cb * (hi - 1)});
+            }
+        }
+        // loops of one statement only iterate independently
+        add_private(fa.coef, s1.loops, 1, g, range);
+        add_private(fb.coef, s2.loops, -1, g, range);
+
+        if (g == 0 ? constant != 0 : constant % g != 0) {
+            return false;
+        }
+        return !range.bounded || (range.lo + constant <= 0 && range.hi + constant >= 0);
+    }
+
+    void add_private(const std::vector<int64_t> &coef, const std::vector<Loop> &loops, int64_t sign,
+        int64_t &g, Range &range) const {
+        for (size_t l = common; l < coef.size(); ++l) {
+            if (coef[l] == 0) {
+                continue;
+            }
+            g = gcd(g, coef[l]);
+            if (loops[l].extent < 0) {
+                range.bounded = false;
+                continue;
+            }
+            int64_t c = sign * coef[l];
+            range.add(c * loops[l].begin, c * (loops[l].begin + loops[l].extent - 1));
+        }
+    }
+};
+
+
+bool same_loop(const Loop &a, const Loop &b) {
+    return a.nest.get() == b.nest.get() && a.index.get() == b.index.get();
+}
+
+
+size_t common_loops(const StmtAccesses &s1, const StmtAccesses &s2) {
+    size_t n = 0;
+    while (n < s1.loops.size() && n < s2.loops.size() && same_loop(s1.loops[n], s2.loops[n])) {
+        ++n;
+    }
+    return n;
+}
+
+
+/**
+ * -1, 0, 1: the source runs after, at the same time as, before the sink
+ */ 
+int lexicographic_sign(const std::vector<Direction> &dirs) {
+    for (auto dir : dirs) {
+        if (dir == Direction::Less) {
+            return 1;
+        }
+        if (dir == Direction::Greater) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+void refine(const Tester &tester, std::vector<Direction> &dirs, size_t level,
+    std::vector<std::vector<Direction> > &found) {
+    if (!tester.feasible(dirs)) {
+        return;
+    }
+    if (level == dirs.size()) {
+        found.push_back(dirs);
+        return;
+    }
+    for (auto dir : {Direction::Less, Direction::Equal, Direction::Greater}) {
+        dirs[level] = dir;
+        refine(tester, dirs, level + 1, found);
+    }
+    dirs[level] = Direction::Any;
+}
+
+}  // anonymous namespace
+
+
+int Dependence::carrier() const {
+    for (size_t l = 0; l < direction.size(); ++l) {
+        if (direction[l] != Direction::Equal) {
+            return static_cast<int>(l);
+        }
+    }
+    return -1;
+}
+
+
+std::vector<Dependence> analyze_dependences(const std::vector<StmtAccesses> &stmts) {
+    std::vector<Dependence> deps;
+    for (size_t s1 = 0; s1 < stmts.size(); ++s1) {
+        for (size_t s2 = 0; s2 < stmts.size(); ++s2) {
+            size_t common = common_loops(stmts[s1], stmts[s2]);
+            for (size_t i = 0; i < stmts[s1].accesses.size(); ++i) {
+                for (size_t j = 0; j < stmts[s2].accesses.size(); ++j) {
+                    const Access &a = stmts[s1].accesses[i];
+                    const Access &b = stmts[s2].accesses[j];
+                    if ((!a.is_write && !b.is_write) || a.name() != b.name()) {
+                        continue;
+                    }
+                    Tester tester(stmts[s1], a, stmts[s2], b, common);
+                    std::vector<Direction> dirs(common, Direction::Any);
+                    std::vector<std::vector<Direction> > found;
+                    refine(tester, dirs, 0, found);
+                    for (auto &dir : found) {
+                        int sign = lexicographic_sign(dir);
+                        // same iterations: textual order, inside one Move the reads come first
+                        bool before = sign > 0 || (sign == 0 && (s1 < s2 || (s1 == s2 && !a.is_write && b.is_write)));
+                        if (!before) {
+                            continue;
+                        }
+                        Dependence dep;
+                        dep.src_stmt = s1;
+                        dep.src_access = i;
+                        dep.dst_stmt = s2;
+                        dep.dst_access = j;
+                        dep.type = a.is_write ? (b.is_write ? DependenceType::Output : DependenceType::Flow)
+                            : DependenceType::Anti;
+                        dep.direction = dir;
+                        for (size_t l = 0; l < common; ++l) {
+                            dep.distance.push_back(dir[l] == Direction::Equal ? 0 : tester.distance(l));
+                        }
+                        deps.push_back(dep);
+                    }
+                }
+            }
+        }
+    }
+    return deps;
+}
+
+
+bool is_parallel(const std::vector<Dependence> &deps, const std::vector<StmtAccesses> &stmts,
+    size_t stmt, size_t loop) {
+    for (auto &dep : deps) {
+        if (dep.carrier() == static_cast<int>(loop)
+            && same_loop(stmts[dep.src_stmt].loops[loop], stmts[stmt].loops[loop])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool is_permutation_legal(const std::vector<Dependence> &deps, const std::vector<size_t> &perm) {
+    for (auto &dep : deps) {
+        if (dep.direction.size() < perm.size()) {
+            continue;
+        }
+        // the loops inside the permuted ones keep their order
+        std::vector<Direction> permuted;
+        for (auto l : perm) {
+            permuted.push_back(dep.direction[l]);
+        }
+        permuted.insert(permuted.end(), dep.direction.begin() + perm.size(), dep.direction.end());
+        if (lexicographic_sign(permuted) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool is_outer_parallel(const std::vector<Dependence> &deps, const std::vector<size_t> &perm) {
+    for (auto &dep : deps) {
+        if (perm.empty() || dep.direction.size() < perm.size()) {
+            continue;
+        }
+        // perm is legal, so the permuted vector is positive or all Equal:
+        // any other first direction is carried by the new outer loop
+        if (dep.direction[perm[0]] != Direction::Equal) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool are_independent(const std::vector<Dependence> &deps, size_t stmt_a, size_t stmt_b) {
+    for (auto &dep : deps) {
+        if ((dep.src_stmt == stmt_a && dep.dst_stmt == stmt_b) || (dep.src_stmt == stmt_b && dep.dst_stmt == stmt_a)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+std::ostream &operator<<(std::ostream &out, const Dependence &dep) {
+    static const char *types[] = {"flow", "anti", "output"};
+    static const char *dirs[] = {"<", "=", ">", "*"};
+    out << types[static_cast<int>(dep.type)] << " S" << dep.src_stmt << "." << dep.src_access
+        << " -> S" << dep.dst_stmt << "." << dep.dst_access << " (";
+    for (size_t l = 0; l < dep.direction.size(); ++l) {
+        out << (l ? ", " : "") << dirs[static_cast<int>(dep.direction[l])];
+    }
+    out << ") distance (";
+    for (size_t l = 0; l < dep.distance.size(); ++l) {
+        out << (l ? ", " : "");
+        if (dep.distance[l] == Dependence::unknown_distance) {
+            out << "?";
+        } else {
+            out << dep.distance[l];
+        }
+    }
+    out << ")";
+    return out;
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
@@ -0,0 +1,235 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <utility>
+
+#include "FlatExpr.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+bool flattened_binary(BinaryOpType op_type, FlatOp &op) {
+    switch (op_type) {
+        case BinaryOpType::Add: op = FlatOp::Add; return true;
+        case BinaryOpType::Sub: op = FlatOp::Sub; return true;
+        case BinaryOpType::Mul: op = FlatOp::Mul; return true;
+        case BinaryOpType::Div: op = FlatOp::Div; return true;
+        case BinaryOpType::Mod: op = FlatOp::Mod; return true;
+        case BinaryOpType::And: op = FlatOp::And; return true;
+        case BinaryOpType::Or: op = FlatOp::Or; return true;
+    }
+    return false;
+}
+
+
+BinaryOpType binary_op(FlatOp op) {
+    switch (op) {
+        case FlatOp::Add: return BinaryOpType::Add;
+        case FlatOp::Sub: return BinaryOpType::Sub;
+        case FlatOp::Mul: return BinaryOpType::Mul;
+        case FlatOp::Div: return BinaryOpType::Div;
+        case FlatOp::Mod: return BinaryOpType::Mod;
+        case FlatOp::And: return BinaryOpType::And;
+        default: return BinaryOpType::Or;
+    }
+}
+
+
+/**
+ * whether expr becomes an operator slot, the rest are constants or leaves
+ */ 
+bool is_operator(const Expr &expr) {
+    if (!expr.type().is_int()) {
+        return false;
+    }
+    if (expr->node_type() == IRNodeType::Binary) {
+        return true;
+    }
+    if (expr->node_type() == IRNodeType::Unary) {
+        return expr.as<Unary>()->op_type == UnaryOpType::Neg;
+    }
+    return false;
+}
+
+}  // anonymous namespace
+
+
+uint32_t FlatExpr::add(const Expr &expr) {
+    CHECK(expr.defined(), "can't flatten an undefined expression\n");
+    roots.push_back(expr);
+    // second: whether the operands are already on the stack
+    std::vector<std::pair<Expr, bool> > stack{{expr, false}};
+    while (!stack.empty()) {
+        Expr e = stack.back().first;
+        bool expanded = stack.back().second;
+        if (slot_of.count(e.get())) {
+            stack.pop_back();
+            continue;
+        }
+        if (!is_operator(e)) {
+            stack.pop_back();
+            if (e->node_type() == IRNodeType::IntImm) {
+                constants.push_back(e.as<IntImm>()->value());
+                slot_of[e.get()] = push(FlatOp::Const, e.type(), static_cast<uint32_t>(constants.size()) - 1u, 0);
+            } else {
+                FlatOp op = e->node_type() == IRNodeType::Index ? FlatOp::Index : FlatOp::Leaf;
+                slot_of[e.get()] = add_leaf(op, e);
+            }
+            continue;
+        }
+        if (e->node_type() == IRNodeType::Unary) {
+            const Expr &a = e.as<Unary>()->a;
+            if (!expanded) {
+                stack.back().second = true;
+                stack.emplace_back(a, false);
+                continue;
+            }
+            stack.pop_back();
+            slot_of[e.get()] = push(FlatOp::Neg, e.type(), slot_of.at(a.get()), 0);
+            continue;
+        }
+        auto op = e.as<Binary>();
+        if (!expanded) {
+            stack.back().second = true;
+            stack.emplace_back(op->b, false);
+            stack.emplace_back(op->a, false);
+            continue;
+        }
+        stack.pop_back();
+        FlatOp flat_op = FlatOp::Add;
+        flattened_binary(op->op_type, flat_op);
+        slot_of[e.get()] = push(flat_op, e.type(), slot_of.at(op->a.get()), slot_of.at(op->b.get()), op->bracket);
+    }
+    return slot_of.at(expr.get());
+}
+
+
+Expr FlatExpr::to_expr(uint32_t slot) const {
+    CHECK(slot < ops.size(), "slot %u out of range\n", slot);
+    // mark what slot reaches, operands always come first
+    std::vector<uint8_t> used(slot + 1, 0);
+    used[slot] = 1;
+    for (uint32_t s = slot + 1; s-- > 0;) {
+        if (!used[s] || ops[s] == FlatOp::Const || ops[s] == FlatOp::Index || ops[s] == FlatOp::Leaf) {
+            continue;
+        }
+        used[args[2 * s]] = 1;
+        if (ops[s] != FlatOp::Neg) {
+            used[args[2 * s + 1]] = 1;
+        }
+    }
+
+    std::vector<Expr> built(slot + 1);
+    for (uint32_t s = 0; s <= slot; ++s) {
+        if (!used[s]) {
+            continue;
+        }
+        const Type &t = types[type_ids[s]];
+        uint32_t a = args[2 * s];
+        uint32_t b = args[2 * s + 1];
+        switch (ops[s]) {
+            case FlatOp::Const:
+                built[s] = IntImm::make(t, constants[a]);
+                break;
+            case FlatOp::Index:
+            case FlatOp::Leaf:
+                built[s] = leaves[a];
+                break;
+            case FlatOp::Neg:
+                built[s] = Unary::make(t, UnaryOpType::Neg, built[a]);
+                break;
+            default:
+                built[s] = Binary::make(t, binary_op(ops[s]), built[a], built[b], flags[s] != 0);
+                break;
+        }
+    }
+    return built[slot];
+}
+
+
+void FlatExpr::evaluate(const std::vector<int64_t> &leaf_values, std::vector<int64_t> &values) const {
+    CHECK(leaf_values.size() >= leaves.size(), "need %d leaf values, got %d\n",
+        static_cast<int>(leaves.size()), static_cast<int>(leaf_values.size()));
+    size_t n = ops.size();
+    values.resize(n);
+    const uint32_t *arg = args.data();
+    int64_t *v = values.data();
+    for (size_t s = 0; s < n; ++s, arg += 2) {
+        switch (ops[s]) {
+            case FlatOp::Const: v[s] = constants[arg[0]]; break;
+            case FlatOp::Index:
+            case FlatOp::Leaf: v[s] = leaf_values[arg[0]]; break;
+            case FlatOp::Neg: v[s] = -v[arg[0]]; break;
+            case FlatOp::Add: v[s] = v[arg[0]] + v[arg[1]]; break;
+            case FlatOp::Sub: v[s] = v[arg[0]] - v[arg[1]]; break;
+            case FlatOp::Mul: v[s] = v[arg[0]] * v[arg[1]]; break;
+            case FlatOp::Div:
+                CHECK(v[arg[1]] != 0, "division by zero in slot %d\n", static_cast<int>(s));
+                v[s] = v[arg[0]] / v[arg[1]];
+                break;
+            case FlatOp::Mod:
+                CHECK(v[arg[1]] != 0, "modulo by zero in slot %d\n", static_cast<int>(s));
+                v[s] = v[arg[0]] % v[arg[1]];
+                break;
+            case FlatOp::And: v[s] = v[arg[0]] && v[arg[1]]; break;
+            case FlatOp::Or: v[s] = v[arg[0]] || v[arg[1]]; break;
+        }
+    }
+}
+
+
+uint32_t FlatExpr::push(FlatOp op, const Type &t, uint32_t a, uint32_t b, bool bracket) {
+    ops.push_back(op);
+    flags.push_back(bracket ? 1 : 0);
+    type_ids.push_back(static_cast<uint8_t>(type_id(t)));
+    args.push_back(a);
+    args.push_back(b);
+    return static_cast<uint32_t>(ops.size()) - 1u;
+}
+
+
+uint32_t FlatExpr::type_id(const Type &t) {
+    for (size_t i = 0; i < types.size(); ++i) {
+        if (types[i] == t) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    CHECK(types.size() < 256, "too many distinct types in one FlatExpr\n");
+    types.push_back(t);
+    return static_cast<uint32_t>(types.size()) - 1u;
+}
+
+
+uint32_t FlatExpr::add_leaf(FlatOp op, const Expr &expr) {
+    leaves.push_back(expr);
+    return push(op, expr.type(), static_cast<uint32_t>(leaves.size()) - 1u, 0);
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
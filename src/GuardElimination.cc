@@ -0,0 +1,350 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "GuardElimination.h"
+#include "IRFunctor.h"
+#include "arith.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+using Arith::Bounds;
+using Arith::Interval;
+
+namespace {
+
+int64_t floor_div(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+
+/**
+ * replaces Index nodes by name, used to give the body the loop indices
+ * with their new domains
+ */ 
+class ReplaceIndex : public IRMutator {
+ public:
+    explicit ReplaceIndex(const std::map<std::string, Expr> &_indices) : indices(_indices) {}
+
+    Expr visit(Ref<const Index> op) override {
+        auto it = indices.find(op->name);
+        return it == indices.end() ? Expr(op) : it->second;
+    }
+
+ private:
+    const std::map<std::string, Expr> &indices;
+};
+
+
+/**
+ * coefficient of index v in e when e is affine in v, false otherwise
+ */ 
+bool linear_coefficient(const Expr &e, const std::string &v, int64_t &coef) {
+    switch (e->node_type()) {
+        case IRNodeType::Index:
+            coef = e.as<Index>()->name == v ? 1 : 0;
+            return true;
+        case IRNodeType::IntImm:
+        case IRNodeType::UIntImm:
+            coef = 0;
+            return true;
+        case IRNodeType::Unary: {
+            auto op = e.as<Unary>();
+            if (op->op_type != UnaryOpType::Neg || !linear_coefficient(op->a, v, coef)) {
+                return false;
+            }
+            coef = -coef;
+            return true;
+        }
+        case IRNodeType::Binary: {
+            auto op = e.as<Binary>();
+            int64_t a, b;
+            if (!linear_coefficient(op->a, v, a) || !linear_coefficient(op->b, v, b)) {
+                return false;
+            }
+            switch (op->op_type) {
+                case BinaryOpType::Add: coef = a + b; return true;
+                case BinaryOpType::Sub: coef = a - b; return true;
+                case BinaryOpType::Mul:
+                    if (a == 0 && op->a->node_type() == IRNodeType::IntImm) {
+                        coef = op->a.as<IntImm>()->value() * b;
+                        return true;
+                    }
+                    if (b == 0 && op->b->node_type() == IRNodeType::IntImm) {
+                        coef = a * op->b.as<IntImm>()->value();
+                        return true;
+                    }
+                    return a == 0 && b == 0 && (coef = 0, true);
+                default:
+                    // div, mod and logic ops are fine as long as v is not inside
+                    coef = 0;
+                    return a == 0 && b == 0;
+            }
+        }
+        default: {
+            // anything else must not depend on v at all
+            bool uses = false;
+            pre_order_visit(e.get(), [&](const IRNode *node) {
+                if (node->node_type() == IRNodeType::Index && static_cast<const Index*>(node)->name == v) {
+                    uses = true;
+                }
+            });
+            coef = 0;
+            return !uses;
+        }
+    }
+}
+
+
+/**
+ * e < c with a constant c
+ */ 
+struct Guard {
+    Expr cond;
+    Expr e;
+    int64_t c;
+    /**
+     * cleared in the boundary part of a split, so a guard peels one loop only
+     */ 
+    bool splittable;
+};
+
+
+class Eliminator {
+ public:
+    Eliminator(const Stmt &_body, const Type &_cond_type) : body(_body), cond_type(_cond_type) {}
+
+    /**
+     * loops: the indices of the nest from the outermost one, indices that
+     * are already split off stay in indices with their narrowed domain
+     */ 
+    Stmt run(std::vector<std::string> loops, std::map<std::string, Expr> indices,
+        std::vector<Expr> opaque, std::vector<Guard> guards) {
+        Bounds bounds = bind(indices);
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            std::vector<Guard> kept;
+            for (auto &guard : guards) {
+                Interval range = bounds(guard.e);
+                if (range.max < guard.c) {
+                    continue;
+                }
+                if (range.min >= guard.c) {
+                    return Stmt();
+                }
+                // clamp: past hi the guard fails whatever the other indices are
+                for (auto &v : loops) {
+                    int64_t coef;
+                    if (!linear_coefficient(guard.e, v, coef) || coef <= 0) {
+                        continue;
+                    }
+                    Interval rest = rest_range(bounds, guard.e, v);
+                    if (!rest.is_bounded()) {
+                        continue;
+                    }
+                    int64_t hi = floor_div(guard.c - 1 - rest.min, coef) + 1;
+                    Interval dom = bounds(indices.at(v).as<Index>()->dom);
+                    if (hi <= dom.min) {
+                        return Stmt();
+                    }
+                    if (hi <= dom.max) {
+                        indices[v] = with_range(indices.at(v), dom.min, hi);
+                        bounds = bind(indices);
+                        changed = true;
+                    }
+                }
+                kept.push_back(guard);
+            }
+            guards.swap(kept);
+        }
+        if (guards.empty() && opaque.empty()) {
+            return nest(loops, indices, body);
+        }
+
+        // split the outermost loop that a guard is affine in
+        for (size_t p = 0; p < loops.size(); ++p) {
+            const std::string &v = loops[p];
+            for (size_t g = 0; g < guards.size(); ++g) {
+                const Guard &guard = guards[g];
+                int64_t coef;
+                if (!guard.splittable || !linear_coefficient(guard.e, v, coef) || coef <= 0) {
+                    continue;
+                }
+                Interval rest = rest_range(bounds, guard.e, v);
+                if (!rest.is_bounded()) {
+                    continue;
+                }
+                // below split the guard holds for all other indices
+                int64_t split = floor_div(guard.c - 1 - rest.max, coef) + 1;
+                Interval dom = bounds(indices.at(v).as<Index>()->dom);
+                if (split <= dom.min || split > dom.max) {
+                    continue;
+                }
+                std::vector<std::string> outer(loops.begin(), loops.begin() + p);
+                std::vector<std::string> inner(loops.begin() + p, loops.end());
+                std::map<std::string, Expr> steady = indices;
+                std::map<std::string, Expr> boundary = indices;
+                steady[v] = with_range(indices.at(v), dom.min, split);
+                boundary[v] = with_range(indices.at(v), split, dom.max + 1);
+                std::vector<Guard> peeled = guards;
+                peeled[g].splittable = false;
+                std::vector<Stmt> parts;
+                for (auto part : {run(inner, steady, opaque, guards), run(inner, boundary, opaque, peeled)}) {
+                    if (part.defined()) {
+                        parts.push_back(part);
+                    }
+                }
+                return nest(outer, indices, parts);
+            }
+        }
+
+        std::vector<Expr> conds = opaque;
+        for (auto &guard : guards) {
+            conds.push_back(guard.cond);
+        }
+        Expr cond = conds[0];
+        for (size_t i = 1; i < conds.size(); ++i) {
+            cond = Binary::make(cond_type, BinaryOpType::And, cond, conds[i]);
+        }
+        return nest(loops, indices, If::make(cond, body));
+    }
+
+ private:
+    Stmt body;
+    Type cond_type;
+
+    static Bounds bind(const std::map<std::string, Expr> &indices) {
+        Bounds bounds;
+        for (auto &kv : indices) {
+            bounds.bind(kv.first, bounds(kv.second.as<Index>()->dom));
+        }
+        return bounds;
+    }
+
+    /**
+     * range of e - coef * v
+     */ 
+    static Interval rest_range(Bounds bounds, const Expr &e, const std::string &v) {
+        bounds.bind(v, Interval::point(0));
+        return bounds(e);
+    }
+
+    static Expr with_range(const Expr &index, int64_t lo, int64_t hi) {
+        auto op = index.as<Index>();
+        const Type &t = op->dom.type();
+        return Index::make(op->type(), op->name, Dom::make(t, IntImm::make(t, lo), IntImm::make(t, hi - lo)),
+            op->index_type);
+    }
+
+    static Stmt nest(const std::vector<std::string> &loops, const std::map<std::string, Expr> &indices,
+        const Stmt &stmt) {
+        return nest(loops, indices, std::vector<Stmt>{stmt});
+    }
+
+    static Stmt nest(const std::vector<std::string> &loops, const std::map<std::string, Expr> &indices,
+        const std::vector<Stmt> &stmts) {
+        // inner parts of a split already carry their own indices
+        std::map<std::string, Expr> replaced;
+        std::vector<Expr> index_list;
+        for (auto &v : loops) {
+            index_list.push_back(indices.at(v));
+            replaced[v] = indices.at(v);
+        }
+        ReplaceIndex replace(replaced);
+        std::vector<Stmt> body_list;
+        for (auto &stmt : stmts) {
+            body_list.push_back(replace.mutate(stmt));
+        }
+        return LoopNest::make(index_list, body_list);
+    }
+};
+
+
+/**
+ * split a && b && ... into its terms
+ */ 
+void conjuncts(const Expr &cond, std::vector<Expr> &terms) {
+    auto op = cond.as<Binary>();
+    if (op != nullptr && op->op_type == BinaryOpType::And) {
+        conjuncts(op->a, terms);
+        conjuncts(op->b, terms);
+    } else {
+        terms.push_back(cond);
+    }
+}
+
+}  // anonymous namespace
+
+
+Stmt GuardElimination::visit(Ref<const LoopNest> op) {
+    Stmt stmt = IRMutator::visit(op);
+    auto loop = stmt.as<LoopNest>();
+    if (loop == nullptr || loop->body_list.size() != 1 || loop->body_list[0].as<If>() == nullptr) {
+        return stmt;
+    }
+    auto guard_stmt = loop->body_list[0].as<If>();
+
+    std::vector<std::string> loops;
+    std::map<std::string, Expr> indices;
+    for (auto &index : loop->index_list) {
+        auto idx = index.as<Index>();
+        if (idx == nullptr || indices.count(idx->name)) {
+            return stmt;
+        }
+        loops.push_back(idx->name);
+        indices[idx->name] = index;
+    }
+
+    Bounds bounds;
+    std::vector<Expr> terms;
+    conjuncts(guard_stmt->cond, terms);
+    std::vector<Expr> opaque;
+    std::vector<Guard> guards;
+    for (auto &term : terms) {
+        auto cmp = term.as<Compare>();
+        Interval c = cmp != nullptr ? bounds(cmp->b) : Interval::everything();
+        if (cmp != nullptr && cmp->op_type == CompareOpType::LT && c.is_point()) {
+            guards.push_back(Guard{term, cmp->a, c.min, true});
+        } else {
+            opaque.push_back(term);
+        }
+    }
+
+    Eliminator eliminator(guard_stmt->true_case, guard_stmt->cond.type());
+    Stmt result = eliminator.run(loops, indices, opaque, guards);
+    // a statement that never runs leaves an empty nest
+    return result.defined() ? result : LoopNest::make({}, {});
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
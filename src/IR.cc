@@ -23,6 +23,8 @@
 */
 
 #include "IR.h"
+#include "IRContext.h"
+#include "IRStats.h"
 #include "IRMutator.h"
 #include "IRVisitor.h"
 
@@ -30,96 +32,405 @@ namespace Boost {
 
 namespace Internal {
 
+/**
+ * factories: without an entered IRContext every call allocates a new node,
+ * otherwise the context returns an existing structurally equal node.
+ * Children are already interned, so comparing them by pointer is enough.
+ * Statements are never shared, they only use the arena of the context.
+ */ 
+
+namespace {
+
+uint64_t hash_ptr(const Expr &e) {
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(e.get()));
+}
+
+
+uint64_t hash_node(IRNodeType node_type, const Type &t) {
+    return hash_combine(static_cast<uint64_t>(node_type), t.hash());
+}
+
+
+bool same_exprs(const std::vector<Expr> &a, const std::vector<Expr> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].get() != b[i].get()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Ref to a node from inside its own visit/mutate entry point
+ */ 
+template <typename T>
+Ref<const T> self_ref(const T *node) {
+    if (IRNodeCounter::enabled) {
+        IRStats::count_shared_from_this();
+    }
+    return Ref<const T>(node->shared_from_this());
+}
+
+}  // anonymous namespace
+
+
+Ref<const IntImm> IntImm::make(Type t, const int64_t _value) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<IntImm>(t, _value);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), static_cast<uint64_t>(_value));
+    return ctx->intern<IntImm>(h,
+        [&](const IntImm &n) { return n.type() == t && n.value() == _value; },
+        [&]() { return make_node<IntImm>(t, _value); });
+}
+
+
+Ref<const UIntImm> UIntImm::make(Type t, const uint64_t _value) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<UIntImm>(t, _value);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), _value);
+    return ctx->intern<UIntImm>(h,
+        [&](const UIntImm &n) { return n.type() == t && n.value() == _value; },
+        [&]() { return make_node<UIntImm>(t, _value); });
+}
+
+
+Ref<const FloatImm> FloatImm::make(Type t, const double _value) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<FloatImm>(t, _value);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), hash_bytes(&_value, sizeof(_value)));
+    return ctx->intern<FloatImm>(h,
+        [&](const FloatImm &n) {
+            double v = n.value();
+            return n.type() == t && std::memcmp(&v, &_value, sizeof(v)) == 0;
+        },
+        [&]() { return make_node<FloatImm>(t, _value); });
+}
+
+
+Ref<const StringImm> StringImm::make(Type t, const std::string _value) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<StringImm>(t, _value);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), hash_string(_value));
+    return ctx->intern<StringImm>(h,
+        [&](const StringImm &n) { return n.type() == t && n.value() == _value; },
+        [&]() { return make_node<StringImm>(t, _value); });
+}
+
+
+Expr Unary::make(Type t, UnaryOpType _op_type, Expr _a) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<Unary>(t, _op_type, _a);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), static_cast<uint64_t>(_op_type));
+    h = hash_combine(h, hash_ptr(_a));
+    return ctx->intern<Unary>(h,
+        [&](const Unary &n) {
+            return n.type() == t && n.op_type == _op_type && n.a.get() == _a.get();
+        },
+        [&]() { return make_node<Unary>(t, _op_type, _a); });
+}
+
+
+Expr Binary::make(Type t, BinaryOpType _op_type, Expr _a, Expr _b, bool _bracket) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<Binary>(t, _op_type, _a, _b, _bracket);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), static_cast<uint64_t>(_op_type));
+    h = hash_combine(h, hash_ptr(_a));
+    h = hash_combine(h, hash_ptr(_b));
+    h = hash_combine(h, _bracket);
+    return ctx->intern<Binary>(h,
+        [&](const Binary &n) {
+            return n.type() == t && n.op_type == _op_type && n.a.get() == _a.get()
+                && n.b.get() == _b.get() && n.bracket == _bracket;
+        },
+        [&]() { return make_node<Binary>(t, _op_type, _a, _b, _bracket); });
+}
+
+
+Expr Compare::make(Type t, CompareOpType _op_type, Expr _a, Expr _b) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<Compare>(t, _op_type, _a, _b);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), static_cast<uint64_t>(_op_type));
+    h = hash_combine(h, hash_ptr(_a));
+    h = hash_combine(h, hash_ptr(_b));
+    return ctx->intern<Compare>(h,
+        [&](const Compare &n) {
+            return n.type() == t && n.op_type == _op_type && n.a.get() == _a.get()
+                && n.b.get() == _b.get();
+        },
+        [&]() { return make_node<Compare>(t, _op_type, _a, _b); });
+}
+
+
+Expr Select::make(Type t, Expr _cond, Expr _true_value, Expr _false_value) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<Select>(t, _cond, _true_value, _false_value);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), hash_ptr(_cond));
+    h = hash_combine(h, hash_ptr(_true_value));
+    h = hash_combine(h, hash_ptr(_false_value));
+    return ctx->intern<Select>(h,
+        [&](const Select &n) {
+            return n.type() == t && n.cond.get() == _cond.get()
+                && n.true_value.get() == _true_value.get()
+                && n.false_value.get() == _false_value.get();
+        },
+        [&]() { return make_node<Select>(t, _cond, _true_value, _false_value); });
+}
+
+
+Expr Call::make(Type t, const std::vector<Expr> &_args, const std::string &_func_name, CallType _call_type) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<Call>(t, _args, _func_name, _call_type);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), hash_string(_func_name));
+    h = hash_combine(h, static_cast<uint64_t>(_call_type));
+    for (auto &arg : _args) {
+        h = hash_combine(h, hash_ptr(arg));
+    }
+    return ctx->intern<Call>(h,
+        [&](const Call &n) {
+            return n.type() == t && n.func_name == _func_name && n.call_type == _call_type
+                && same_exprs(n.args, _args);
+        },
+        [&]() { return make_node<Call>(t, _args, _func_name, _call_type); });
+}
+
+
+Expr Cast::make(Type t, Type _new_type, Expr _val) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<Cast>(t, _new_type, _val);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), _new_type.hash());
+    h = hash_combine(h, hash_ptr(_val));
+    return ctx->intern<Cast>(h,
+        [&](const Cast &n) {
+            return n.type() == t && n.new_type == _new_type && n.val.get() == _val.get();
+        },
+        [&]() { return make_node<Cast>(t, _new_type, _val); });
+}
+
+
+Expr Ramp::make(Type t, Expr _base, uint16_t _stride, uint16_t _lanes) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<Ramp>(t, _base, _stride, _lanes);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), hash_ptr(_base));
+    h = hash_combine(h, _stride);
+    h = hash_combine(h, _lanes);
+    return ctx->intern<Ramp>(h,
+        [&](const Ramp &n) {
+            return n.type() == t && n.base.get() == _base.get() && n.stride == _stride
+                && n.lanes == _lanes;
+        },
+        [&]() { return make_node<Ramp>(t, _base, _stride, _lanes); });
+}
+
+
+Expr Var::make(Type t, const std::string &_name, const std::vector<Expr> &_args,
+    const std::vector<size_t> &_shape) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<Var>(t, _name, _args, _shape);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), hash_string(_name));
+    for (auto &arg : _args) {
+        h = hash_combine(h, hash_ptr(arg));
+    }
+    for (auto extent : _shape) {
+        h = hash_combine(h, extent);
+    }
+    return ctx->intern<Var>(h,
+        [&](const Var &n) {
+            return n.type() == t && n.name == _name && n.shape == _shape
+                && same_exprs(n.args, _args);
+        },
+        [&]() { return make_node<Var>(t, _name, _args, _shape); });
+}
+
+
+Expr Dom::make(Type t, Expr _begin, Expr _extent) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<Dom>(t, _begin, _extent);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), hash_ptr(_begin));
+    h = hash_combine(h, hash_ptr(_extent));
+    return ctx->intern<Dom>(h,
+        [&](const Dom &n) {
+            return n.type() == t && n.begin.get() == _begin.get() && n.extent.get() == _extent.get();
+        },
+        [&]() { return make_node<Dom>(t, _begin, _extent); });
+}
+
+
+Expr Index::make(Type t, const std::string &_name, Expr _dom, IndexType _index_type) {
+    IRContext *ctx = IRContext::current();
+    if (ctx == nullptr || !ctx->hash_cons()) {
+        return make_node<Index>(t, _name, _dom, _index_type);
+    }
+    uint64_t h = hash_combine(hash_node(node_type_, t), hash_string(_name));
+    h = hash_combine(h, hash_ptr(_dom));
+    h = hash_combine(h, static_cast<uint64_t>(_index_type));
+    return ctx->intern<Index>(h,
+        [&](const Index &n) {
+            return n.type() == t && n.name == _name && n.dom.get() == _dom.get()
+                && n.index_type == _index_type;
+        },
+        [&]() { return make_node<Index>(t, _name, _dom, _index_type); });
+}
+
+
+Stmt LoopNest::make(const std::vector<Expr> &_index_list, const std::vector<Stmt> &_body_list) {
+    return make_node<LoopNest>(_index_list, _body_list);
+}
+
+
+Stmt IfThenElse::make(Expr _cond, Stmt _true_case, Stmt _false_case) {
+    return make_node<IfThenElse>(_cond, _true_case, _false_case);
+}
+
+
+Stmt If::make(Expr _cond, Stmt _true_case) {
+    return make_node<If>(_cond, _true_case);
+}
+
+
+Stmt Move::make(Expr _dst, Expr _src, MoveType _move_type) {
+    return make_node<Move>(_dst, _src, _move_type);
+}
+
+
+Stmt Reduce::make(Expr _dst, Expr _value, BinaryOpType _combiner, Expr _identity,
+    const std::vector<Expr> &_axes) {
+    CHECK(_combiner == BinaryOpType::Add || _combiner == BinaryOpType::Mul
+        || _combiner == BinaryOpType::And || _combiner == BinaryOpType::Or,
+        "reduction combiner must be associative and commutative, got %d\n", static_cast<int>(_combiner));
+    return make_node<Reduce>(_dst, _value, _combiner, _identity, _axes);
+}
+
+
+Group Kernel::make(const std::string &_name, const std::vector<Expr> &_inputs,
+    const std::vector<Expr> &_outputs, const std::vector<Stmt> &_stmt_list, KernelType _kernel_type) {
+    return make_node<Kernel>(_name, _inputs, _outputs, _stmt_list, _kernel_type);
+}
+
+
 Expr IntImm::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const IntImm>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr UIntImm::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const UIntImm>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr FloatImm::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const FloatImm>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr StringImm::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const StringImm>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr Unary::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const Unary>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr Binary::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const Binary>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr Compare::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const Compare>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr Select::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const Select>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr Call::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const Call>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr Cast::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const Cast>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr Ramp::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const Ramp>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr Var::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const Var>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr Dom::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const Dom>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Expr Index::mutate_expr(IRMutator *mutator) const {
-    return mutator->visit(Ref<const Index>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Stmt LoopNest::mutate_stmt(IRMutator *mutator) const {
-    return mutator->visit(Ref<const LoopNest>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 
 Stmt IfThenElse::mutate_stmt(IRMutator *mutator) const {
-    return mutator->visit(Ref<const IfThenElse>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 Stmt If::mutate_stmt(IRMutator *mutator) const {
-    return mutator->visit(Ref<const If>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 Stmt Move::mutate_stmt(IRMutator *mutator) const {
-    return mutator->visit(Ref<const Move>(shared_from_this()));
+    return mutator->visit(self_ref(this));
+}
+
+Stmt Reduce::mutate_stmt(IRMutator *mutator) const {
+    return mutator->visit(self_ref(this));
 }
 
 
 Group Kernel::mutate_group(IRMutator *mutator) const {
-    return mutator->visit(Ref<const Kernel>(shared_from_this()));
+    return mutator->visit(self_ref(this));
 }
 
 /**
@@ -127,95 +438,99 @@ Group Kernel::mutate_group(IRMutator *mutator) const {
  */ 
 
 void IntImm::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const IntImm>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void UIntImm::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const UIntImm>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void FloatImm::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const FloatImm>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void StringImm::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const StringImm>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void Unary::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const Unary>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void Binary::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const Binary>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void Compare::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const Compare>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void Select::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const Select>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void Call::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const Call>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void Cast::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const Cast>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void Ramp::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const Ramp>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void Var::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const Var>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void Dom::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const Dom>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void Index::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const Index>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void LoopNest::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const LoopNest>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
 void IfThenElse::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const IfThenElse>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 void If::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const If>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 void Move::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const Move>(shared_from_this()));
+    return visitor->visit(self_ref(this));
+}
+
+void Reduce::visit_node(IRVisitor *visitor) const {
+    return visitor->visit(self_ref(this));
 }
 
 
 void Kernel::visit_node(IRVisitor *visitor) const {
-    return visitor->visit(Ref<const Kernel>(shared_from_this()));
+    return visitor->visit(self_ref(this));
 }
 
 
@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "IRContext.h"
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+thread_local IRContext *current_context = nullptr;
+
+}  // anonymous namespace
+
+
+IRContext::~IRContext() {
+    CHECK(current_context != this, "IRContext destroyed while it is still entered\n");
+    table_.clear();
+    if (arena_ != nullptr) {
+        CHECK(arena_->live() == 0, "%lu nodes outlive their arena IRContext\n",
+            static_cast<unsigned long>(arena_->live()));
+    }
+}
+
+
+IRContext *IRContext::current() {
+    return current_context;
+}
+
+
+IRContext::Scope::Scope(IRContext &ctx) : prev(current_context) {
+    current_context = &ctx;
+}
+
+
+IRContext::Scope::~Scope() {
+    current_context = prev;
+}
+
+
+}  // namespace Internal
+
+}  // namespace Boost
@@ -0,0 +1,204 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <cstring>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "IREquality.h"
+#include "IRFunctor.h"
+#include "hash.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+typedef std::pair<const IRNode*, const IRNode*> NodePair;
+
+
+struct NodePairHash {
+    size_t operator()(const NodePair &p) const {
+        return static_cast<size_t>(hash_combine(reinterpret_cast<uintptr_t>(p.first),
+            reinterpret_cast<uintptr_t>(p.second)));
+    }
+};
+
+
+/**
+ * the bits of a double, as FloatImm hashes them: -0.0 differs from 0.0,
+ * a NaN equals itself
+ */ 
+uint64_t bits_of(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+
+template <typename T>
+bool same_size(const std::vector<T> &a, const std::vector<T> &b) {
+    return a.size() == b.size();
+}
+
+
+/**
+ * compare the fields of a and b that are not children,
+ * both nodes must have the same node type
+ */ 
+bool shallow_equal(const IRNode *a, const IRNode *b) {
+    switch (a->node_type()) {
+        case IRNodeType::Kernel: {
+            const Kernel *x = static_cast<const Kernel*>(a);
+            const Kernel *y = static_cast<const Kernel*>(b);
+            return x->name == y->name && x->kernel_type == y->kernel_type
+                && same_size(x->inputs, y->inputs) && same_size(x->outputs, y->outputs)
+                && same_size(x->stmt_list, y->stmt_list);
+        }
+        case IRNodeType::LoopNest: {
+            const LoopNest *x = static_cast<const LoopNest*>(a);
+            const LoopNest *y = static_cast<const LoopNest*>(b);
+            return same_size(x->index_list, y->index_list) && same_size(x->body_list, y->body_list);
+        }
+        case IRNodeType::IfThenElse: {
+            const IfThenElse *x = static_cast<const IfThenElse*>(a);
+            const IfThenElse *y = static_cast<const IfThenElse*>(b);
+            return (x->false_case.get() == nullptr) == (y->false_case.get() == nullptr);
+        }
+        case IRNodeType::If:
+            return true;
+        case IRNodeType::Move:
+            return static_cast<const Move*>(a)->move_type == static_cast<const Move*>(b)->move_type;
+        case IRNodeType::Reduce: {
+            const Reduce *x = static_cast<const Reduce*>(a);
+            const Reduce *y = static_cast<const Reduce*>(b);
+            return x->combiner == y->combiner && same_size(x->axes, y->axes);
+        }
+        default:
+            break;
+    }
+
+    const ExprNode *ea = static_cast<const ExprNode*>(a);
+    const ExprNode *eb = static_cast<const ExprNode*>(b);
+    if (ea->type() != eb->type()) {
+        return false;
+    }
+    switch (a->node_type()) {
+        case IRNodeType::Unary:
+            return static_cast<const Unary*>(a)->op_type == static_cast<const Unary*>(b)->op_type;
+        case IRNodeType::Binary:
+            return static_cast<const Binary*>(a)->op_type == static_cast<const Binary*>(b)->op_type;
+        case IRNodeType::Compare:
+            return static_cast<const Compare*>(a)->op_type == static_cast<const Compare*>(b)->op_type;
+        case IRNodeType::Select:
+            return true;
+        case IRNodeType::Call: {
+            const Call *x = static_cast<const Call*>(a);
+            const Call *y = static_cast<const Call*>(b);
+            return x->func_name == y->func_name && x->call_type == y->call_type
+                && same_size(x->args, y->args);
+        }
+        case IRNodeType::Var: {
+            const Var *x = static_cast<const Var*>(a);
+            const Var *y = static_cast<const Var*>(b);
+            return x->name == y->name && x->shape == y->shape && same_size(x->args, y->args);
+        }
+        case IRNodeType::Cast:
+            return static_cast<const Cast*>(a)->new_type == static_cast<const Cast*>(b)->new_type;
+        case IRNodeType::Ramp: {
+            const Ramp *x = static_cast<const Ramp*>(a);
+            const Ramp *y = static_cast<const Ramp*>(b);
+            return x->stride == y->stride && x->lanes == y->lanes;
+        }
+        case IRNodeType::Index: {
+            const Index *x = static_cast<const Index*>(a);
+            const Index *y = static_cast<const Index*>(b);
+            return x->name == y->name && x->index_type == y->index_type;
+        }
+        case IRNodeType::Dom:
+            return true;
+        case IRNodeType::IntImm:
+            return static_cast<const IntImm*>(a)->value() == static_cast<const IntImm*>(b)->value();
+        case IRNodeType::UIntImm:
+            return static_cast<const UIntImm*>(a)->value() == static_cast<const UIntImm*>(b)->value();
+        case IRNodeType::FloatImm:
+            return bits_of(static_cast<const FloatImm*>(a)->value())
+                == bits_of(static_cast<const FloatImm*>(b)->value());
+        case IRNodeType::StringImm:
+            return static_cast<const StringImm*>(a)->value() == static_cast<const StringImm*>(b)->value();
+        default:
+            return false;
+    }
+}
+
+}  // anonymous namespace
+
+
+bool deep_equal(const IRNode *a, const IRNode *b) {
+    // explicit stack so that deep chains do not overflow
+    std::vector<NodePair> stack;
+    std::vector<const IRNode*> children;
+    // pairs already compared, so that unshared copies of a DAG take linear time
+    std::unordered_set<NodePair, NodePairHash> visited;
+    stack.emplace_back(a, b);
+    while (!stack.empty()) {
+        const IRNode *x = stack.back().first;
+        const IRNode *y = stack.back().second;
+        stack.pop_back();
+        if (x == y) {
+            // shared subtree, or both null
+            continue;
+        }
+        if (x == nullptr || y == nullptr) {
+            return false;
+        }
+        if (x->structural_hash() != y->structural_hash() || x->node_type() != y->node_type()) {
+            return false;
+        }
+        if (!shallow_equal(x, y)) {
+            return false;
+        }
+        children.clear();
+        for_each_child(x, [&children](const IRNode *child) { children.push_back(child); });
+        size_t offset = children.size();
+        for_each_child(y, [&children](const IRNode *child) { children.push_back(child); });
+        if (children.size() != 2 * offset) {
+            return false;
+        }
+        if (offset > 0 && !visited.emplace(x, y).second) {
+            continue;
+        }
+        for (size_t i = 0; i < offset; ++i) {
+            stack.emplace_back(children[i], children[offset + i]);
+        }
+    }
+    return true;
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
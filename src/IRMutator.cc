@@ -29,20 +29,69 @@ namespace Boost {
 namespace Internal {
 
 Expr IRMutator::mutate(const Expr &expr) {
-    return expr.mutate_expr(this);
+    if (memoize) {
+        auto it = expr_memo.find(expr.get());
+        if (it != expr_memo.end()) {
+            return it->second.second;
+        }
+    }
+    begin_node();
+    Expr new_expr = expr.mutate_expr(this);
+    end_node(new_expr.get() != expr.get());
+    if (memoize) {
+        expr_memo[expr.get()] = std::make_pair(expr, new_expr);
+    }
+    end_pass();
+    return new_expr;
 }
 
 
 Stmt IRMutator::mutate(const Stmt &stmt) {
-    return stmt.mutate_stmt(this);
+    if (memoize) {
+        auto it = stmt_memo.find(stmt.get());
+        if (it != stmt_memo.end()) {
+            return it->second.second;
+        }
+    }
+    begin_node();
+    Stmt new_stmt = stmt.mutate_stmt(this);
+    end_node(new_stmt.get() != stmt.get());
+    if (memoize) {
+        stmt_memo[stmt.get()] = std::make_pair(stmt, new_stmt);
+    }
+    end_pass();
+    return new_stmt;
 }
 
 
 Group IRMutator::mutate(const Group &group) {
-    return group.mutate_group(this);
+    begin_node();
+    Group new_group = group.mutate_group(this);
+    end_node(new_group.get() != group.get());
+    end_pass();
+    return new_group;
 }
 
 
+namespace {
+
+/**
+ * mutate a list, tell whether any element changed
+ */ 
+template <typename T>
+bool mutate_list(IRMutator *mutator, const std::vector<T> &list, std::vector<T> &new_list) {
+    bool changed = false;
+    new_list.reserve(list.size());
+    for (auto &item : list) {
+        new_list.push_back(mutator->mutate(item));
+        changed = changed || new_list.back().get() != item.get();
+    }
+    return changed;
+}
+
+}  // anonymous namespace
+
+
 Expr IRMutator::visit(Ref<const IntImm> op) {
     return op;
 }
@@ -65,6 +114,9 @@ Expr IRMutator::visit(Ref<const StringImm> op) {
 
 Expr IRMutator::visit(Ref<const Unary> op) {
     Expr new_a = mutate(op->a);
+    if (new_a.get() == op->a.get()) {
+        return op;
+    }
     return Unary::make(op->type(), op->op_type, new_a);
 }
 
@@ -72,6 +124,9 @@ Expr IRMutator::visit(Ref<const Unary> op) {
 Expr IRMutator::visit(Ref<const Binary> op) {
     Expr new_a = mutate(op->a);
     Expr new_b = mutate(op->b);
+    if (new_a.get() == op->a.get() && new_b.get() == op->b.get()) {
+        return op;
+    }
     return Binary::make(op->type(), op->op_type, new_a, new_b,op->bracket);
 }
 
@@ -79,6 +134,9 @@ Expr IRMutator::visit(Ref<const Binary> op) {
 Expr IRMutator::visit(Ref<const Compare> op) {
     Expr new_a = mutate(op->a);
     Expr new_b = mutate(op->b);
+    if (new_a.get() == op->a.get() && new_b.get() == op->b.get()) {
+        return op;
+    }
     return Compare::make(op->type(), op->op_type, new_a, new_b);
 }
 
@@ -87,14 +145,18 @@ Expr IRMutator::visit(Ref<const Select> op) {
     Expr new_cond = mutate(op->cond);
     Expr new_true_value = mutate(op->true_value);
     Expr new_false_value = mutate(op->false_value);
+    if (new_cond.get() == op->cond.get() && new_true_value.get() == op->true_value.get()
+        && new_false_value.get() == op->false_value.get()) {
+        return op;
+    }
     return Select::make(op->type(), new_cond, new_true_value, new_false_value);
 }
 
 
 Expr IRMutator::visit(Ref<const Call> op) {
     std::vector<Expr> new_args;
-    for (auto arg : op->args) {
-        new_args.push_back(mutate(arg));
+    if (!mutate_list(this, op->args, new_args)) {
+        return op;
     }
     return Call::make(op->type(), new_args, op->func_name, op->call_type);
 
@@ -103,20 +165,26 @@ Expr IRMutator::visit(Ref<const Call> op) {
 
 Expr IRMutator::visit(Ref<const Cast> op) {
     Expr new_val = mutate(op->val);
+    if (new_val.get() == op->val.get()) {
+        return op;
+    }
     return Cast::make(op->type(), op->new_type, new_val);
 }
 
 
 Expr IRMutator::visit(Ref<const Ramp> op) {
     Expr new_base = mutate(op->base);
+    if (new_base.get() == op->base.get()) {
+        return op;
+    }
     return Ramp::make(op->type(), new_base, op->stride, op->lanes);
 }
 
 
 Expr IRMutator::visit(Ref<const Var> op) {
     std::vector<Expr> new_args;
-    for (auto arg : op->args) {
-        new_args.push_back(mutate(arg));
+    if (!mutate_list(this, op->args, new_args)) {
+        return op;
     }
     return Var::make(op->type(), op->name, new_args, op->shape);
 }
@@ -125,12 +193,18 @@ Expr IRMutator::visit(Ref<const Var> op) {
 Expr IRMutator::visit(Ref<const Dom> op) {
     Expr new_begin = mutate(op->begin);
     Expr new_extent = mutate(op->extent);
+    if (new_begin.get() == op->begin.get() && new_extent.get() == op->extent.get()) {
+        return op;
+    }
     return Dom::make(op->type(), new_begin, new_extent);
 }
 
 
 Expr IRMutator::visit(Ref<const Index> op) {
     Expr new_dom = mutate(op->dom);
+    if (new_dom.get() == op->dom.get()) {
+        return op;
+    }
     return Index::make(op->type(), op->name, new_dom, op->index_type);
 }
 
@@ -138,11 +212,10 @@ Expr IRMutator::visit(Ref<const Index> op) {
 Stmt IRMutator::visit(Ref<const LoopNest> op) {
     std::vector<Expr> new_index_list;
     std::vector<Stmt> new_body_list;
-    for (auto index : op->index_list) {
-        new_index_list.push_back(mutate(index));
-    }
-    for (auto body : op->body_list) {
-        new_body_list.push_back(mutate(body));
+    bool changed = mutate_list(this, op->index_list, new_index_list);
+    changed = mutate_list(this, op->body_list, new_body_list) || changed;
+    if (!changed) {
+        return op;
     }
     return LoopNest::make(new_index_list, new_body_list);
 }
@@ -152,12 +225,19 @@ Stmt IRMutator::visit(Ref<const IfThenElse> op) {
     Expr new_cond = mutate(op->cond);
     Stmt new_true_case = mutate(op->true_case);
     Stmt new_false_case = mutate(op->false_case);
+    if (new_cond.get() == op->cond.get() && new_true_case.get() == op->true_case.get()
+        && new_false_case.get() == op->false_case.get()) {
+        return op;
+    }
     return IfThenElse::make(new_cond, new_true_case, new_false_case);
 }
 
 Stmt IRMutator::visit(Ref<const If> op) {
     Expr new_cond = mutate(op->cond);
     Stmt new_true_case = mutate(op->true_case);
+    if (new_cond.get() == op->cond.get() && new_true_case.get() == op->true_case.get()) {
+        return op;
+    }
     return If::make(new_cond, new_true_case);
 }
 
@@ -165,22 +245,36 @@ Stmt IRMutator::visit(Ref<const If> op) {
 Stmt IRMutator::visit(Ref<const Move> op) {
     Expr new_dst = mutate(op->dst);
     Expr new_src = mutate(op->src);
+    if (new_dst.get() == op->dst.get() && new_src.get() == op->src.get()) {
+        return op;
+    }
     return Move::make(new_dst, new_src, op->move_type);
 }
 
 
+Stmt IRMutator::visit(Ref<const Reduce> op) {
+    Expr new_dst = mutate(op->dst);
+    Expr new_value = mutate(op->value);
+    Expr new_identity = mutate(op->identity);
+    std::vector<Expr> new_axes;
+    bool changed = mutate_list(this, op->axes, new_axes);
+    if (!changed && new_dst.get() == op->dst.get() && new_value.get() == op->value.get()
+        && new_identity.get() == op->identity.get()) {
+        return op;
+    }
+    return Reduce::make(new_dst, new_value, op->combiner, new_identity, new_axes);
+}
+
+
 Group IRMutator::visit(Ref<const Kernel> op) {
     std::vector<Expr> new_inputs;
-    for (auto expr : op->inputs) {
-        new_inputs.push_back(mutate(expr));
-    }
     std::vector<Expr> new_outputs;
-    for (auto expr : op->outputs) {
-        new_outputs.push_back(mutate(expr));
-    }
     std::vector<Stmt> new_stmt_list;
-    for (auto stmt : op->stmt_list) {
-        new_stmt_list.push_back(mutate(stmt));
+    bool changed = mutate_list(this, op->inputs, new_inputs);
+    changed = mutate_list(this, op->outputs, new_outputs) || changed;
+    changed = mutate_list(this, op->stmt_list, new_stmt_list) || changed;
+    if (!changed) {
+        return op;
     }
     return Kernel::make(op->name, new_inputs, new_outputs, new_stmt_list, op->kernel_type);
 }
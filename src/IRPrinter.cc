@@ -22,12 +22,62 @@
  * SOFTWARE.
 */
 
+#include <vector>
+
 #include "IRPrinter.h"
 
 namespace Boost {
 
 namespace Internal {
 
+namespace {
+
+/**
+ * the vector types of the values of a kernel, in order of first use
+ */ 
+class VectorTypes : public IRVisitor {
+ public:
+    std::vector<Type> types;
+
+    void visit(Ref<const Unary> op) override {
+        add(op->type());
+        IRVisitor::visit(op);
+    }
+
+    void visit(Ref<const Binary> op) override {
+        add(op->type());
+        IRVisitor::visit(op);
+    }
+
+    void visit(Ref<const Ramp> op) override {
+        // other ramps are subscripts, printed as addresses
+        if (op->stride == 0) {
+            add(op->type());
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(Ref<const Var> op) override {
+        add(op->type());
+        IRVisitor::visit(op);
+    }
+
+ private:
+    void add(Type t) {
+        if (t.lanes() == 1) {
+            return;
+        }
+        for (auto &seen : types) {
+            if (seen == t) {
+                return;
+            }
+        }
+        types.push_back(t);
+    }
+};
+
+}  // anonymous namespace
+
 
 std::string IRPrinter::print(const Expr &expr) {
     oss.clear();
@@ -160,6 +210,12 @@ void IRPrinter::visit(Ref<const Cast> op) {
 
 
 void IRPrinter::visit(Ref<const Ramp> op) {
+    if (op->stride == 0) {
+        oss << "broadcast_" << op->type() << "(";
+        (op->base).visit_expr(this);
+        oss << ")";
+        return;
+    }
     oss << "ramp(";
     (op->base).visit_expr(this);
     oss << ", " << op->stride << ", " << op->lanes << ")";
@@ -178,6 +234,11 @@ void IRPrinter::visit(Ref<const Var> op) {
             oss << "]";
         }
     }
+    else if (op->type().lanes() > 1 && !op->args.empty()) {
+        oss << "load_" << op->type() << "(";
+        print_address(op);
+        oss << ")";
+    }
     else{
         oss << op->name;
         for (size_t i = 0; i < op->args.size(); ++i) {
@@ -189,11 +250,26 @@ void IRPrinter::visit(Ref<const Var> op) {
 
 }
 void IRPrinter::visit(Ref<const Dom> op) {
-    oss << "int " << now_index << " = ";
+    // the bounds may refer to outer indices, print those by name
+    std::string index = now_index;
+    print_range = false;
+    oss << "int " << index << " = ";
     (op->begin).visit_expr(this);
-    oss << "; " << now_index << " < ";
-    (op->extent).visit_expr(this);
-    oss <<"; ++" << now_index;
+    oss << "; " << index << " < ";
+    // the domain is [begin, begin + extent)
+    auto begin = op->begin.as<IntImm>();
+    auto extent = op->extent.as<IntImm>();
+    if (begin != nullptr && begin->value() == 0) {
+        (op->extent).visit_expr(this);
+    } else if (begin != nullptr && extent != nullptr) {
+        oss << begin->value() + extent->value();
+    } else {
+        (op->begin).visit_expr(this);
+        oss << " + ";
+        (op->extent).visit_expr(this);
+    }
+    oss <<"; ++" << index;
+    print_range = true;
 }
 
 
@@ -210,6 +286,15 @@ void IRPrinter::visit(Ref<const Index> op) {
 void IRPrinter::visit(Ref<const LoopNest> op) {
     print_range = true;
     for (auto index : op->index_list) {
+        // marks from Schedule, for compilers that honor them
+        IndexType index_type = index.as<Index>()->index_type;
+        if (index_type == IndexType::Parallel) {
+            print_indent();
+            oss << "#pragma omp parallel for\n";
+        } else if (index_type == IndexType::Vectorized) {
+            print_indent();
+            oss << "#pragma GCC ivdep\n";
+        }
         print_indent();
         oss << "for(";
         index.visit_expr(this);
@@ -259,16 +344,67 @@ void IRPrinter::visit(Ref<const If> op) {
 
 void IRPrinter::visit(Ref<const Move> op) {
     print_indent();
+    auto dst = op->dst.as<Var>();
+    if (dst != nullptr && dst->type().lanes() > 1 && !dst->args.empty()) {
+        // vector stores go through the helpers of print_vector_helpers
+        oss << "store_" << dst->type() << "(";
+        print_address(dst);
+        oss << ", ";
+        auto sum = op->src.as<Binary>();
+        bool bracket = op->move_type != MoveType::LocalToMem && sum != nullptr && !sum->bracket
+            && (sum->op_type == BinaryOpType::Add || sum->op_type == BinaryOpType::Sub);
+        if (op->move_type != MoveType::LocalToMem) {
+            (op->dst).visit_expr(this);
+            oss << " + ";
+        }
+        oss << (bracket ? "(" : "");
+        (op->src).visit_expr(this);
+        oss << (bracket ? ")" : "") << ");\n";
+        return;
+    }
+    if (op->move_type == MoveType::MemToLocal) {
+        oss << op->dst->type() << " ";
+    }
     (op->dst).visit_expr(this);
-    oss << " += ";
+    bool assign = op->move_type == MoveType::MemToLocal || op->move_type == MoveType::LocalToMem;
+    oss << (assign ? " = " : " += ");
     (op->src).visit_expr(this);
     oss << ";\n";
 }
 
 
+void IRPrinter::visit(Ref<const Reduce> op) {
+    print_indent();
+    (op->dst).visit_expr(this);
+    switch (op->combiner) {
+        case BinaryOpType::Add:
+            oss << " += ";
+            break;
+        case BinaryOpType::Mul:
+            oss << " *= ";
+            break;
+        default:
+            oss << " = ";
+            (op->dst).visit_expr(this);
+            oss << (op->combiner == BinaryOpType::And ? " && (" : " || (");
+            (op->value).visit_expr(this);
+            oss << ");\n";
+            return;
+    }
+    (op->value).visit_expr(this);
+    oss << ";\n";
+}
+
+
 void IRPrinter::visit(Ref<const Kernel> op) {
     print_indent();
-    oss << "#include \"../run2.h\"\n"<< "void " << op->name << "(";
+    oss << "#include \"../run2.h\"\n";
+    VectorTypes vectors;
+    Group(op).visit_group(&vectors);
+    for (auto &t : vectors.types) {
+        print_vector_helpers(t);
+    }
+    oss << "void " << op->name << "(";
     print_arg = true;
     for (size_t i = 0; i < op->inputs.size(); ++i) {
         op->inputs[i].visit_expr(this);
@@ -292,6 +428,43 @@ void IRPrinter::visit(Ref<const Kernel> op) {
     exit();
     oss << "}\n";
 }
+
+
+void IRPrinter::print_address(Ref<const Var> op) {
+    // a Ramp subscript is the address of its first lane
+    oss << "&" << op->name;
+    for (auto &arg : op->args) {
+        oss << "[";
+        if (auto ramp = arg.as<Ramp>()) {
+            (ramp->base).visit_expr(this);
+        } else {
+            arg.visit_expr(this);
+        }
+        oss << "]";
+    }
+}
+
+
+void IRPrinter::print_vector_helpers(Type t) {
+    Type elem = t.with_lanes(1);
+    int bytes = t.lanes() * t.bits / 8;
+    oss << "#ifndef BOOST_VECTOR_" << t << "\n"
+        << "#define BOOST_VECTOR_" << t << "\n"
+        << "typedef " << elem << " " << t << " __attribute__((vector_size(" << bytes << ")));\n"
+        << "static inline " << t << " load_" << t << "(const " << elem << " *p) {\n"
+        << "  " << t << " v;\n"
+        << "  __builtin_memcpy(&v, p, sizeof(v));\n"
+        << "  return v;\n"
+        << "}\n"
+        << "static inline void store_" << t << "(" << elem << " *p, " << t << " v) {\n"
+        << "  __builtin_memcpy(p, &v, sizeof(v));\n"
+        << "}\n"
+        << "static inline " << t << " broadcast_" << t << "(" << elem << " x) {\n"
+        << "  " << t << " v = {};\n"
+        << "  return v + x;\n"
+        << "}\n"
+        << "#endif\n";
+}
 //new 
 
 
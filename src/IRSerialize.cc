@@ -0,0 +1,568 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BOOST_HAS_MMAP 1
+#endif
+
+#include "IRSerialize.h"
+#include "IRFunctor.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+using namespace serialize;
+
+namespace {
+
+size_t align8(size_t n) {
+    return (n + 7u) & ~static_cast<size_t>(7u);
+}
+
+
+class Encoder {
+ public:
+    std::string encode(const std::vector<Group> &groups) {
+        for (auto &group : groups) {
+            CHECK(group.defined(), "can't serialize an undefined group\n");
+            roots.push_back(add_tree(group.get()));
+        }
+
+        Header header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = magic;
+        header.version = version;
+        header.num_strings = static_cast<uint32_t>(string_offsets.size()) - 1u;
+        header.string_bytes = static_cast<uint32_t>(chars.size());
+        header.num_types = static_cast<uint32_t>(types.size());
+        header.num_nodes = static_cast<uint32_t>(nodes.size());
+        header.num_operands = static_cast<uint32_t>(operands.size());
+        header.num_shapes = static_cast<uint32_t>(shapes.size());
+        header.num_roots = static_cast<uint32_t>(roots.size());
+
+        std::string out;
+        append(out, &header, sizeof(header));
+        append(out, string_offsets.data(), string_offsets.size() * sizeof(uint32_t));
+        append(out, chars.data(), chars.size());
+        append(out, types.data(), types.size() * sizeof(TypeRecord));
+        append(out, nodes.data(), nodes.size() * sizeof(NodeRecord));
+        append(out, operands.data(), operands.size() * sizeof(uint32_t));
+        append(out, shapes.data(), shapes.size() * sizeof(uint64_t));
+        append(out, roots.data(), roots.size() * sizeof(uint32_t));
+        return out;
+    }
+
+ private:
+    std::unordered_map<std::string, uint32_t> string_ids;
+    std::unordered_map<const IRNode*, uint32_t> node_ids;
+    std::vector<uint32_t> string_offsets{0};
+    std::string chars;
+    std::vector<Type> type_list;
+    std::vector<TypeRecord> types;
+    std::vector<NodeRecord> nodes;
+    std::vector<uint32_t> operands;
+    std::vector<uint64_t> shapes;
+    std::vector<uint32_t> roots;
+
+    static void append(std::string &out, const void *data, size_t bytes) {
+        out.append(static_cast<const char*>(data), bytes);
+        out.resize(align8(out.size()), '\0');
+    }
+
+    uint32_t add_string(const std::string &s) {
+        auto it = string_ids.find(s);
+        if (it != string_ids.end()) {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(string_offsets.size()) - 1u;
+        chars += s;
+        string_offsets.push_back(static_cast<uint32_t>(chars.size()));
+        string_ids.emplace(s, id);
+        return id;
+    }
+
+    uint32_t add_type(const Type &t) {
+        // programs use a handful of types, a linear search is enough
+        for (size_t i = 0; i < type_list.size(); ++i) {
+            if (type_list[i] == t) {
+                return static_cast<uint32_t>(i);
+            }
+        }
+        TypeRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.code = static_cast<uint8_t>(t.code);
+        record.bits = t.bits;
+        record.num_lanes = static_cast<uint8_t>(t.lanes_list.size());
+        for (size_t i = 0; i < t.lanes_list.size(); ++i) {
+            record.lanes[i] = t.lanes_list[i];
+        }
+        type_list.push_back(t);
+        types.push_back(record);
+        return static_cast<uint32_t>(types.size()) - 1u;
+    }
+
+    /**
+     * emit the nodes under root children first, each distinct node once
+     */ 
+    uint32_t add_tree(const IRNode *root) {
+        std::vector<std::pair<const IRNode*, bool> > stack{{root, false}};
+        std::vector<const IRNode*> children;
+        while (!stack.empty()) {
+            const IRNode *node = stack.back().first;
+            if (node_ids.count(node)) {
+                stack.pop_back();
+                continue;
+            }
+            if (stack.back().second) {
+                stack.pop_back();
+                node_ids.emplace(node, add_node(node));
+                continue;
+            }
+            stack.back().second = true;
+            children.clear();
+            for_each_child(node, [&children](const IRNode *child) { children.push_back(child); });
+            for (auto it = children.rbegin(); it != children.rend(); ++it) {
+                CHECK(*it != nullptr, "can't serialize a null child\n");
+                if (!node_ids.count(*it)) {
+                    stack.emplace_back(*it, false);
+                }
+            }
+        }
+        return node_ids.at(root);
+    }
+
+    uint32_t add_node(const IRNode *node) {
+        NodeRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.node_type = static_cast<uint8_t>(node->node_type());
+        record.first = static_cast<uint32_t>(operands.size());
+        for_each_child(node, [this](const IRNode *child) { operands.push_back(node_ids.at(child)); });
+        record.count = static_cast<uint32_t>(operands.size()) - record.first;
+
+        switch (node->node_type()) {
+            case IRNodeType::Kernel: {
+                const Kernel *op = static_cast<const Kernel*>(node);
+                record.op = static_cast<uint8_t>(op->kernel_type);
+                record.aux = add_string(op->name);
+                record.extra = static_cast<uint32_t>(op->inputs.size());
+                record.payload = op->outputs.size();
+                break;
+            }
+            case IRNodeType::LoopNest:
+                record.extra = static_cast<uint32_t>(static_cast<const LoopNest*>(node)->index_list.size());
+                break;
+            case IRNodeType::IfThenElse:
+                record.flags = static_cast<const IfThenElse*>(node)->false_case.defined() ? 1 : 0;
+                break;
+            case IRNodeType::If:
+                break;
+            case IRNodeType::Move:
+                record.op = static_cast<uint8_t>(static_cast<const Move*>(node)->move_type);
+                break;
+            case IRNodeType::Reduce:
+                record.op = static_cast<uint8_t>(static_cast<const Reduce*>(node)->combiner);
+                break;
+            default: {
+                const ExprNode *expr = static_cast<const ExprNode*>(node);
+                record.type = add_type(expr->type());
+                add_expr_fields(expr, record);
+                break;
+            }
+        }
+        nodes.push_back(record);
+        return static_cast<uint32_t>(nodes.size()) - 1u;
+    }
+
+    void add_expr_fields(const ExprNode *node, NodeRecord &record) {
+        switch (node->node_type()) {
+            case IRNodeType::Unary:
+                record.op = static_cast<uint8_t>(static_cast<const Unary*>(node)->op_type);
+                break;
+            case IRNodeType::Binary:
+                record.op = static_cast<uint8_t>(static_cast<const Binary*>(node)->op_type);
+                record.flags = static_cast<const Binary*>(node)->bracket ? 1 : 0;
+                break;
+            case IRNodeType::Compare:
+                record.op = static_cast<uint8_t>(static_cast<const Compare*>(node)->op_type);
+                break;
+            case IRNodeType::Call: {
+                const Call *op = static_cast<const Call*>(node);
+                record.op = static_cast<uint8_t>(op->call_type);
+                record.aux = add_string(op->func_name);
+                break;
+            }
+            case IRNodeType::Var: {
+                const Var *op = static_cast<const Var*>(node);
+                record.aux = add_string(op->name);
+                record.extra = static_cast<uint32_t>(op->shape.size());
+                record.payload = shapes.size();
+                for (auto extent : op->shape) {
+                    shapes.push_back(extent);
+                }
+                break;
+            }
+            case IRNodeType::Cast:
+                record.aux = add_type(static_cast<const Cast*>(node)->new_type);
+                break;
+            case IRNodeType::Ramp: {
+                const Ramp *op = static_cast<const Ramp*>(node);
+                record.payload = (static_cast<uint64_t>(op->stride) << 16) | op->lanes;
+                break;
+            }
+            case IRNodeType::Index: {
+                const Index *op = static_cast<const Index*>(node);
+                record.op = static_cast<uint8_t>(op->index_type);
+                record.aux = add_string(op->name);
+                break;
+            }
+            case IRNodeType::IntImm:
+                record.payload = static_cast<uint64_t>(static_cast<const IntImm*>(node)->value());
+                break;
+            case IRNodeType::UIntImm:
+                record.payload = static_cast<const UIntImm*>(node)->value();
+                break;
+            case IRNodeType::FloatImm: {
+                double value = static_cast<const FloatImm*>(node)->value();
+                std::memcpy(&record.payload, &value, sizeof(value));
+                break;
+            }
+            case IRNodeType::StringImm:
+                record.aux = add_string(static_cast<const StringImm*>(node)->value());
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+
+/**
+ * view of one array section of the buffer
+ */ 
+template <typename T>
+struct Section {
+    const T *data = nullptr;
+    size_t size = 0;
+    const T &operator[](size_t i) const {
+        return data[i];
+    }
+};
+
+
+class Decoder {
+ public:
+    Decoder(const char *_data, size_t _size) : data(_data), size(_size), offset(0) {}
+
+    std::vector<Group> decode() {
+        CHECK(size >= sizeof(Header), "serialized IR is truncated\n");
+        Header header;
+        std::memcpy(&header, data, sizeof(header));
+        CHECK(header.magic == magic, "not a serialized IR buffer\n");
+        CHECK(header.version == version, "serialized IR version %u, expected %u\n",
+            header.version, version);
+        offset = align8(sizeof(header));
+
+        string_offsets = section<uint32_t>(static_cast<size_t>(header.num_strings) + 1u);
+        chars = section<char>(header.string_bytes);
+        types = section<TypeRecord>(header.num_types);
+        nodes = section<NodeRecord>(header.num_nodes);
+        operands = section<uint32_t>(header.num_operands);
+        shapes = section<uint64_t>(header.num_shapes);
+        roots = section<uint32_t>(header.num_roots);
+
+        exprs.resize(nodes.size);
+        stmts.resize(nodes.size);
+        groups.resize(nodes.size);
+        for (uint32_t i = 0; i < nodes.size; ++i) {
+            build(i, nodes[i]);
+        }
+
+        std::vector<Group> result;
+        for (size_t i = 0; i < roots.size; ++i) {
+            CHECK(roots[i] < nodes.size && groups[roots[i]].defined(), "bad root in serialized IR\n");
+            result.push_back(groups[roots[i]]);
+        }
+        return result;
+    }
+
+ private:
+    const char *data;
+    size_t size;
+    size_t offset;
+    Section<uint32_t> string_offsets;
+    Section<char> chars;
+    Section<TypeRecord> types;
+    Section<NodeRecord> nodes;
+    Section<uint32_t> operands;
+    Section<uint64_t> shapes;
+    Section<uint32_t> roots;
+    std::vector<Expr> exprs;
+    std::vector<Stmt> stmts;
+    std::vector<Group> groups;
+
+    template <typename T>
+    Section<T> section(size_t count) {
+        CHECK(count <= (size - offset) / sizeof(T), "serialized IR is truncated\n");
+        Section<T> result;
+        result.data = reinterpret_cast<const T*>(data + offset);
+        result.size = count;
+        offset = align8(offset + count * sizeof(T));
+        return result;
+    }
+
+    std::string string_at(uint32_t id) const {
+        CHECK(id + 1u < string_offsets.size, "bad string id %u in serialized IR\n", id);
+        uint32_t begin = string_offsets[id];
+        uint32_t end = string_offsets[id + 1];
+        CHECK(begin <= end && end <= chars.size, "bad string table in serialized IR\n");
+        return std::string(chars.data + begin, end - begin);
+    }
+
+    Type type_at(uint32_t id) const {
+        CHECK(id < types.size, "bad type id %u in serialized IR\n", id);
+        const TypeRecord &record = types[id];
+        LanesList lanes;
+        for (uint8_t i = 0; i < record.num_lanes; ++i) {
+            lanes.push_back(record.lanes[i]);
+        }
+        return Type(static_cast<TypeCode>(record.code), record.bits, lanes);
+    }
+
+    const Expr &expr_at(uint32_t self, const NodeRecord &record, uint32_t i) const {
+        uint32_t id = operands[record.first + i];
+        CHECK(id < self && exprs[id].defined(), "operand of node %u is not an Expr\n", self);
+        return exprs[id];
+    }
+
+    const Stmt &stmt_at(uint32_t self, const NodeRecord &record, uint32_t i) const {
+        uint32_t id = operands[record.first + i];
+        CHECK(id < self && stmts[id].defined(), "operand of node %u is not a Stmt\n", self);
+        return stmts[id];
+    }
+
+    std::vector<Expr> expr_list(uint32_t self, const NodeRecord &record, uint32_t begin, uint32_t end) const {
+        std::vector<Expr> list;
+        list.reserve(end - begin);
+        for (uint32_t i = begin; i < end; ++i) {
+            list.push_back(expr_at(self, record, i));
+        }
+        return list;
+    }
+
+    std::vector<Stmt> stmt_list(uint32_t self, const NodeRecord &record, uint32_t begin, uint32_t end) const {
+        std::vector<Stmt> list;
+        list.reserve(end - begin);
+        for (uint32_t i = begin; i < end; ++i) {
+            list.push_back(stmt_at(self, record, i));
+        }
+        return list;
+    }
+
+    void expect_children(uint32_t self, const NodeRecord &record, uint32_t count) const {
+        CHECK(record.count == count, "node %u has %u children, expected %u\n", self, record.count, count);
+    }
+
+    void build(uint32_t self, const NodeRecord &record) {
+        CHECK(record.first <= operands.size && record.count <= operands.size - record.first,
+            "bad operand range of node %u\n", self);
+        IRNodeType node_type = static_cast<IRNodeType>(record.node_type);
+        switch (node_type) {
+            case IRNodeType::Kernel: {
+                CHECK(static_cast<uint64_t>(record.extra) + record.payload <= record.count,
+                    "bad kernel arguments of node %u\n", self);
+                uint32_t num_outputs = static_cast<uint32_t>(record.payload);
+                uint32_t stmt_begin = record.extra + num_outputs;
+                groups[self] = Kernel::make(string_at(record.aux),
+                    expr_list(self, record, 0, record.extra),
+                    expr_list(self, record, record.extra, stmt_begin),
+                    stmt_list(self, record, stmt_begin, record.count),
+                    static_cast<KernelType>(record.op));
+                return;
+            }
+            case IRNodeType::LoopNest:
+                CHECK(record.extra <= record.count, "bad loop nest of node %u\n", self);
+                stmts[self] = LoopNest::make(expr_list(self, record, 0, record.extra),
+                    stmt_list(self, record, record.extra, record.count));
+                return;
+            case IRNodeType::IfThenElse:
+                if (record.flags) {
+                    expect_children(self, record, 3);
+                    stmts[self] = IfThenElse::make(expr_at(self, record, 0), stmt_at(self, record, 1),
+                        stmt_at(self, record, 2));
+                } else {
+                    expect_children(self, record, 2);
+                    stmts[self] = IfThenElse::make(expr_at(self, record, 0), stmt_at(self, record, 1), Stmt());
+                }
+                return;
+            case IRNodeType::If:
+                expect_children(self, record, 2);
+                stmts[self] = If::make(expr_at(self, record, 0), stmt_at(self, record, 1));
+                return;
+            case IRNodeType::Move:
+                expect_children(self, record, 2);
+                stmts[self] = Move::make(expr_at(self, record, 0), expr_at(self, record, 1),
+                    static_cast<MoveType>(record.op));
+                return;
+            case IRNodeType::Reduce:
+                CHECK(record.count >= 3, "reduce node %u has %u children\n", self, record.count);
+                stmts[self] = Reduce::make(expr_at(self, record, 0), expr_at(self, record, 1),
+                    static_cast<BinaryOpType>(record.op), expr_at(self, record, 2),
+                    expr_list(self, record, 3, record.count));
+                return;
+            default:
+                exprs[self] = build_expr(self, record, node_type, type_at(record.type));
+                return;
+        }
+    }
+
+    Expr build_expr(uint32_t self, const NodeRecord &record, IRNodeType node_type, Type t) {
+        switch (node_type) {
+            case IRNodeType::Unary:
+                expect_children(self, record, 1);
+                return Unary::make(t, static_cast<UnaryOpType>(record.op), expr_at(self, record, 0));
+            case IRNodeType::Binary:
+                expect_children(self, record, 2);
+                return Binary::make(t, static_cast<BinaryOpType>(record.op), expr_at(self, record, 0),
+                    expr_at(self, record, 1), record.flags != 0);
+            case IRNodeType::Compare:
+                expect_children(self, record, 2);
+                return Compare::make(t, static_cast<CompareOpType>(record.op), expr_at(self, record, 0),
+                    expr_at(self, record, 1));
+            case IRNodeType::Select:
+                expect_children(self, record, 3);
+                return Select::make(t, expr_at(self, record, 0), expr_at(self, record, 1),
+                    expr_at(self, record, 2));
+            case IRNodeType::Call:
+                return Call::make(t, expr_list(self, record, 0, record.count), string_at(record.aux),
+                    static_cast<CallType>(record.op));
+            case IRNodeType::Var: {
+                CHECK(record.payload <= shapes.size && record.extra <= shapes.size - record.payload,
+                    "bad shape of node %u\n", self);
+                std::vector<size_t> shape(shapes.data + record.payload,
+                    shapes.data + record.payload + record.extra);
+                return Var::make(t, string_at(record.aux), expr_list(self, record, 0, record.count), shape);
+            }
+            case IRNodeType::Cast:
+                expect_children(self, record, 1);
+                return Cast::make(t, type_at(record.aux), expr_at(self, record, 0));
+            case IRNodeType::Ramp:
+                expect_children(self, record, 1);
+                return Ramp::make(t, expr_at(self, record, 0), static_cast<uint16_t>(record.payload >> 16),
+                    static_cast<uint16_t>(record.payload & 0xffffu));
+            case IRNodeType::Index:
+                expect_children(self, record, 1);
+                return Index::make(t, string_at(record.aux), expr_at(self, record, 0),
+                    static_cast<IndexType>(record.op));
+            case IRNodeType::Dom:
+                expect_children(self, record, 2);
+                return Dom::make(t, expr_at(self, record, 0), expr_at(self, record, 1));
+            case IRNodeType::IntImm:
+                return IntImm::make(t, static_cast<int64_t>(record.payload));
+            case IRNodeType::UIntImm:
+                return UIntImm::make(t, record.payload);
+            case IRNodeType::FloatImm: {
+                double value;
+                std::memcpy(&value, &record.payload, sizeof(value));
+                return FloatImm::make(t, value);
+            }
+            case IRNodeType::StringImm:
+                return StringImm::make(t, string_at(record.aux));
+            default:
+                CHECK(false, "unknown node type %d in serialized IR\n", static_cast<int>(record.node_type));
+                return Expr();
+        }
+    }
+};
+
+}  // anonymous namespace
+
+
+std::string serialize_ir(const std::vector<Group> &groups) {
+    Encoder encoder;
+    return encoder.encode(groups);
+}
+
+
+std::vector<Group> deserialize_ir(const char *data, size_t size) {
+    if (reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) != 0) {
+        // the sections are read in place, they need 8-byte alignment
+        std::vector<uint64_t> aligned(align8(size) / sizeof(uint64_t));
+        std::memcpy(aligned.data(), data, size);
+        return deserialize_ir(reinterpret_cast<const char*>(aligned.data()), size);
+    }
+    Decoder decoder(data, size);
+    return decoder.decode();
+}
+
+
+bool save_ir(const std::string &path, const std::vector<Group> &groups) {
+    std::string bytes = serialize_ir(groups);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
+
+
+std::vector<Group> load_ir(const std::string &path) {
+#ifdef BOOST_HAS_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    CHECK(fd >= 0, "can't open %s\n", path.c_str());
+    struct stat st;
+    CHECK(fstat(fd, &st) == 0, "can't stat %s\n", path.c_str());
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        close(fd);
+        return deserialize_ir(nullptr, 0);
+    }
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    CHECK(addr != MAP_FAILED, "can't map %s\n", path.c_str());
+    std::vector<Group> groups = deserialize_ir(static_cast<const char*>(addr), size);
+    munmap(addr, size);
+    return groups;
+#else
+    std::ifstream in(path, std::ios::binary);
+    CHECK(in, "can't open %s\n", path.c_str());
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return deserialize_ir(bytes.data(), bytes.size());
+#endif
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
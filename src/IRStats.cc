@@ -0,0 +1,193 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+
+#include "IRStats.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+bool IRNodeCounter::enabled = false;
+
+namespace {
+
+const char *node_type_names[ir_node_type_count] = {
+    "Kernel", "LoopNest", "IfThenElse", "If", "Move", "Reduce",
+    "Unary", "Binary", "Select", "Compare", "Call", "Var", "Cast", "Ramp",
+    "Index", "IntImm", "UIntImm", "FloatImm", "StringImm", "Dom"
+};
+
+/**
+ * relaxed atomics: the counters are statistics, not synchronization
+ */ 
+std::atomic<int64_t> live[ir_node_type_count];
+std::atomic<int64_t> peak[ir_node_type_count];
+std::atomic<int64_t> live_total(0);
+std::atomic<int64_t> peak_total(0);
+std::atomic<uint64_t> bytes(0);
+std::atomic<uint64_t> self_refs(0);
+
+std::mutex pass_mutex;
+std::vector<IRStats::Pass> pass_log;
+
+void raise_peak(std::atomic<int64_t> &peak_value, int64_t value) {
+    int64_t old = peak_value.load(std::memory_order_relaxed);
+    while (value > old && !peak_value.compare_exchange_weak(old, value, std::memory_order_relaxed)) {}
+}
+
+}  // anonymous namespace
+
+
+void IRNodeCounter::created(IRNodeType type) {
+    int t = static_cast<int>(type);
+    raise_peak(peak[t], live[t].fetch_add(1, std::memory_order_relaxed) + 1);
+    raise_peak(peak_total, live_total.fetch_add(1, std::memory_order_relaxed) + 1);
+}
+
+
+void IRNodeCounter::destroyed(IRNodeType type) {
+    live[static_cast<int>(type)].fetch_sub(1, std::memory_order_relaxed);
+    live_total.fetch_sub(1, std::memory_order_relaxed);
+}
+
+
+void IRStats::enable(bool on) {
+    IRNodeCounter::enabled = on;
+}
+
+
+void IRStats::reset() {
+    for (int t = 0; t < ir_node_type_count; ++t) {
+        peak[t].store(live[t].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    peak_total.store(live_total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    bytes.store(0, std::memory_order_relaxed);
+    self_refs.store(0, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(pass_mutex);
+    pass_log.clear();
+}
+
+
+int64_t IRStats::live_nodes(IRNodeType type) {
+    return live[static_cast<int>(type)].load(std::memory_order_relaxed);
+}
+
+
+int64_t IRStats::peak_nodes(IRNodeType type) {
+    return peak[static_cast<int>(type)].load(std::memory_order_relaxed);
+}
+
+
+int64_t IRStats::live_nodes() {
+    return live_total.load(std::memory_order_relaxed);
+}
+
+
+int64_t IRStats::peak_nodes() {
+    return peak_total.load(std::memory_order_relaxed);
+}
+
+
+uint64_t IRStats::allocated_bytes() {
+    return bytes.load(std::memory_order_relaxed);
+}
+
+
+uint64_t IRStats::shared_from_this_calls() {
+    return self_refs.load(std::memory_order_relaxed);
+}
+
+
+std::vector<IRStats::Pass> IRStats::passes() {
+    std::lock_guard<std::mutex> lock(pass_mutex);
+    return pass_log;
+}
+
+
+void IRStats::count_bytes(size_t n) {
+    bytes.fetch_add(n, std::memory_order_relaxed);
+}
+
+
+void IRStats::count_shared_from_this() {
+    self_refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void IRStats::record_pass(const std::string &name, size_t visited, size_t rebuilt, double ms) {
+    std::lock_guard<std::mutex> lock(pass_mutex);
+    pass_log.push_back(Pass{name, visited, rebuilt, ms});
+}
+
+
+void IRStats::dump(std::ostream &out) {
+    out << "IR stats\n";
+    out << std::left << std::setw(12) << "  node" << std::right
+        << std::setw(10) << "live" << std::setw(10) << "peak" << "\n";
+    for (int t = 0; t < ir_node_type_count; ++t) {
+        if (peak[t].load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        out << "  " << std::left << std::setw(10) << node_type_names[t] << std::right
+            << std::setw(10) << live[t].load(std::memory_order_relaxed)
+            << std::setw(10) << peak[t].load(std::memory_order_relaxed) << "\n";
+    }
+    out << "  " << std::left << std::setw(10) << "total" << std::right
+        << std::setw(10) << live_nodes() << std::setw(10) << peak_nodes() << "\n";
+    out << "  bytes allocated: " << allocated_bytes() << "\n";
+    out << "  shared_from_this calls: " << shared_from_this_calls() << "\n";
+
+    // passes of the same name are summed up
+    std::vector<Pass> summary;
+    std::vector<size_t> runs;
+    for (auto &pass : passes()) {
+        size_t i = 0;
+        while (i < summary.size() && summary[i].name != pass.name) {
+            ++i;
+        }
+        if (i == summary.size()) {
+            summary.push_back(Pass{pass.name, 0, 0, 0.0});
+            runs.push_back(0);
+        }
+        summary[i].visited += pass.visited;
+        summary[i].rebuilt += pass.rebuilt;
+        summary[i].ms += pass.ms;
+        runs[i] += 1;
+    }
+    for (size_t i = 0; i < summary.size(); ++i) {
+        out << "  pass " << summary[i].name << ": " << runs[i] << " runs, "
+            << summary[i].visited << " visited, " << summary[i].rebuilt << " rebuilt, "
+            << std::fixed << std::setprecision(3) << summary[i].ms << " ms\n";
+        out.unsetf(std::ios::fixed);
+    }
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "IRUtil.h"
+#include "IREquality.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+void NameCollector::visit(Ref<const Var> op) {
+    names.insert(op->name);
+    loads = true;
+    IRVisitor::visit(op);
+}
+
+
+void NameCollector::visit(Ref<const Index> op) {
+    names.insert(op->name);
+}
+
+
+void LoopFinder::visit(Ref<const LoopNest>) {
+    found = true;
+}
+
+
+void LoadCollector::visit(Ref<const Var> op) {
+    loads.push_back(op);
+}
+
+
+Expr Substitute::visit(Ref<const Index> op) {
+    auto found = values.find(op->name);
+    if (found != values.end()) {
+        return found->second;
+    }
+    return IRMutator::visit(op);
+}
+
+
+Expr ReplaceLoads::visit(Ref<const Var> op) {
+    for (auto &r : replacements) {
+        if (deep_equal(Expr(op), r.first)) {
+            return r.second;
+        }
+    }
+    return IRMutator::visit(op);
+}
+
+
+Ref<const LoopNest> flatten(Ref<const LoopNest> op) {
+    std::vector<Expr> loops = op->index_list;
+    std::vector<Stmt> body = op->body_list;
+    while (body.size() == 1) {
+        auto inner = body[0].as<LoopNest>();
+        if (inner == nullptr || inner->index_list.empty()) {
+            break;
+        }
+        loops.insert(loops.end(), inner->index_list.begin(), inner->index_list.end());
+        body = inner->body_list;
+    }
+    if (loops.size() == op->index_list.size()) {
+        return op;
+    }
+    return LoopNest::make(loops, body).as<LoopNest>();
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
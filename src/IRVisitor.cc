@@ -149,6 +149,17 @@ void IRVisitor::visit(Ref<const Move> op) {
 }
 
 
+void IRVisitor::visit(Ref<const Reduce> op) {
+    (op->dst).visit_expr(this);
+    (op->value).visit_expr(this);
+    (op->identity).visit_expr(this);
+    for (auto axis : op->axes) {
+        axis.visit_expr(this);
+    }
+    return;
+}
+
+
 void IRVisitor::visit(Ref<const Kernel> op) {
     for (auto expr : op->inputs) {
         expr.visit_expr(this);
@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <string>
+
+#include "LoopPermutation.h"
+#include "Dependence.h"
+#include "IRUtil.h"
+#include "IRVisitor.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+std::vector<size_t> LoopPermutation::choose(Ref<const LoopNest> nest) const {
+    size_t n = nest->index_list.size();
+    std::vector<size_t> order(n);
+    for (size_t l = 0; l < n; ++l) {
+        order[l] = l;
+    }
+    std::vector<StmtAccesses> stmts = analyze_accesses(Stmt(nest));
+    if (n < 2 || n > max_loops || stmts.empty()) {
+        return order;
+    }
+    std::vector<Dependence> deps = analyze_dependences(stmts);
+    // loops of the nest each loop's bounds use
+    std::vector<std::set<size_t> > bound_by(n);
+    for (size_t l = 0; l < n; ++l) {
+        NameCollector used;
+        nest->index_list[l].as<Index>()->dom.visit_expr(&used);
+        for (size_t m = 0; m < n; ++m) {
+            if (used.names.count(nest->index_list[m].as<Index>()->name)) {
+                bound_by[l].insert(m);
+            }
+        }
+    }
+
+    struct Option {
+        std::vector<size_t> order;
+        double cost;
+        int strided;
+        bool parallel;
+    };
+    std::vector<Option> options;
+    double best_cost = 0;
+    do {
+        bool legal = is_permutation_legal(deps, order);
+        std::set<size_t> outside;
+        for (auto l : order) {
+            for (auto m : bound_by[l]) {
+                legal = legal && outside.count(m);
+            }
+            outside.insert(l);
+        }
+        if (!legal) {
+            continue;
+        }
+        Option option{order, 0, 0, is_outer_parallel(deps, order)};
+        for (size_t s = 0; s < stmts.size(); ++s) {
+            CostEstimate estimate = model.estimate(stmts[s], LoopSchedule{order, {}});
+            option.cost += estimate.time_ns;
+            for (auto &access : stmts[s].accesses) {
+                if (!access.affine()) {
+                    continue;
+                }
+                if (access.invariant(order.back())) {
+                    option.cost -= estimate.iterations * model.cost_params().access_ns;
+                } else if (std::abs(access.stride(order.back())) != 1) {
+                    option.strided += 1;
+                }
+            }
+        }
+        if (options.empty() || option.cost < best_cost) {
+            best_cost = option.cost;
+        }
+        options.push_back(option);
+    } while (std::next_permutation(order.begin(), order.end()));
+
+    const Option *best = nullptr;
+    for (auto &option : options) {
+        if (option.cost > best_cost + slack * std::abs(best_cost)) {
+            continue;
+        }
+        if (best == nullptr || option.strided < best->strided
+            || (option.strided == best->strided && option.parallel && !best->parallel)
+            || (option.strided == best->strided && option.parallel == best->parallel && option.cost < best->cost)) {
+            best = &option;
+        }
+    }
+    return best->order;
+}
+
+
+Stmt LoopPermutation::visit(Ref<const LoopNest> op) {
+    auto nest = flatten(op);
+    LoopFinder inner;
+    for (auto &body : nest->body_list) {
+        body.visit_stmt(&inner);
+    }
+    if (inner.found) {
+        return IRMutator::visit(op);
+    }
+    std::vector<size_t> order = choose(nest);
+    bool moved = false;
+    std::vector<Expr> loops;
+    for (size_t l = 0; l < order.size(); ++l) {
+        moved = moved || order[l] != l;
+        loops.push_back(nest->index_list[order[l]]);
+    }
+    if (!moved) {
+        return op;
+    }
+    return LoopNest::make(loops, nest->body_list);
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
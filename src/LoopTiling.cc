@@ -0,0 +1,222 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include <cstdlib>
+#include <string>
+
+#include "LoopTiling.h"
+#include "Dependence.h"
+#include "GuardElimination.h"
+#include "IRUtil.h"
+#include "IRVisitor.h"
+#include "Schedule.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+/**
+ * powers of two below bound, and bound
+ */ 
+std::vector<int64_t> tile_sizes(int64_t bound) {
+    std::vector<int64_t> sizes;
+    for (int64_t size = 1; size < bound; size *= 2) {
+        sizes.push_back(size);
+    }
+    sizes.push_back(bound);
+    return sizes;
+}
+
+}  // anonymous namespace
+
+
+std::vector<LoopTiling::Tiling> LoopTiling::choose(Ref<const LoopNest> nest) const {
+    std::vector<Tiling> result;
+    size_t n = nest->index_list.size();
+    std::vector<StmtAccesses> stmts = analyze_accesses(Stmt(nest));
+    if (n < 2 || n > max_loops || stmts.empty()) {
+        return result;
+    }
+    std::vector<int64_t> bounds;
+    for (auto &index : nest->index_list) {
+        auto dom = index.as<Index>()->dom.as<Dom>();
+        auto extent = dom->extent.as<IntImm>();
+        if (dom->begin.as<IntImm>() == nullptr || extent == nullptr || extent->value() <= 0) {
+            return result;
+        }
+        bounds.push_back(extent->value());
+    }
+    // something to reuse, and tiles that can run in any order
+    bool reuse = false;
+    for (auto &stmt : stmts) {
+        for (auto &access : stmt.accesses) {
+            if (!access.affine()) {
+                return result;
+            }
+            for (size_t l = 0; l < n; ++l) {
+                reuse = reuse || access.invariant(l);
+            }
+        }
+    }
+    for (auto &dep : analyze_dependences(stmts)) {
+        for (auto d : dep.direction) {
+            if (d != Direction::Less && d != Direction::Equal) {
+                return result;
+            }
+        }
+    }
+    if (!reuse) {
+        return result;
+    }
+
+    std::vector<size_t> order(n);
+    for (size_t l = 0; l < n; ++l) {
+        order[l] = l;
+    }
+    auto footprint = [&](const std::vector<int64_t> &sizes) {
+        size_t tiled = 0;
+        for (size_t l = 0; l < n; ++l) {
+            tiled += sizes[l] < stmts[0].loops[l].extent;
+        }
+        int64_t bytes = 0;
+        for (auto &stmt : stmts) {
+            bytes += model.estimate(stmt, LoopSchedule{order, sizes}).footprint[tiled];
+        }
+        return bytes;
+    };
+
+    // a unit stride innermost loop keeps its whole tile while the others can shrink
+    bool unit_stride = false;
+    for (auto &stmt : stmts) {
+        for (auto &access : stmt.accesses) {
+            unit_stride = unit_stride || std::abs(access.stride(n - 1)) == 1;
+        }
+    }
+    const std::vector<CacheLevel> &caches = model.cache_levels();
+    for (size_t c = caches.size(); c-- > 0;) {
+        double capacity = caches[c].size * fill;
+        std::vector<int64_t> best;
+        for (int keep_inner = unit_stride; keep_inner >= 0 && best.empty(); --keep_inner) {
+            std::vector<std::vector<int64_t> > choices;
+            for (auto bound : bounds) {
+                choices.push_back(tile_sizes(bound));
+            }
+            if (keep_inner) {
+                choices.back() = {bounds.back()};
+            }
+            // odometer over the choices of every loop
+            std::vector<size_t> pick(n, 0);
+            double best_volume = 0, best_intensity = 0;
+            while (true) {
+                std::vector<int64_t> sizes;
+                double volume = 1;
+                for (size_t l = 0; l < n; ++l) {
+                    sizes.push_back(choices[l][pick[l]]);
+                    volume *= static_cast<double>(sizes.back());
+                }
+                int64_t bytes = footprint(sizes);
+                double intensity = volume / static_cast<double>(bytes);
+                if (bytes <= capacity && (best.empty() || intensity > best_intensity
+                    || (intensity == best_intensity && volume > best_volume))) {
+                    best = sizes;
+                    best_volume = volume;
+                    best_intensity = intensity;
+                }
+                size_t l = 0;
+                while (l < n && ++pick[l] == choices[l].size()) {
+                    pick[l++] = 0;
+                }
+                if (l == n) {
+                    break;
+                }
+            }
+        }
+        if (best.empty() || best == bounds) {
+            continue;
+        }
+        result.push_back(Tiling{caches[c].level, best});
+        bounds = best;
+    }
+    return result;
+}
+
+
+Stmt LoopTiling::visit(Ref<const LoopNest> op) {
+    auto nest = flatten(op);
+    LoopFinder inner;
+    for (auto &body : nest->body_list) {
+        body.visit_stmt(&inner);
+    }
+    if (inner.found) {
+        return IRMutator::visit(op);
+    }
+    std::vector<Tiling> tilings = choose(nest);
+    if (tilings.empty()) {
+        return op;
+    }
+
+    size_t n = nest->index_list.size();
+    std::vector<std::string> names;
+    std::vector<int64_t> bounds;
+    std::vector<size_t> last_split(n, tilings.size());
+    for (size_t l = 0; l < n; ++l) {
+        names.push_back(nest->index_list[l].as<Index>()->name);
+        bounds.push_back(nest->index_list[l].as<Index>()->dom.as<Dom>()->extent.as<IntImm>()->value());
+        int64_t bound = bounds.back();
+        for (size_t t = 0; t < tilings.size(); ++t) {
+            if (tilings[t].sizes[l] < bound) {
+                last_split[l] = t;
+            }
+            bound = tilings[t].sizes[l];
+        }
+    }
+
+    Schedule schedule(Kernel::make("tiling", {}, {}, {Stmt(nest)}, KernelType::CPU));
+    std::vector<std::string> current = names;
+    std::vector<std::string> order;
+    for (size_t t = 0; t < tilings.size(); ++t) {
+        std::string tag = "_L" + std::to_string(tilings[t].cache_level);
+        for (size_t l = 0; l < n; ++l) {
+            if (tilings[t].sizes[l] >= bounds[l]) {
+                continue;
+            }
+            std::string inner_name = last_split[l] == t ? names[l] + "_p" : names[l] + tag + "_in";
+            schedule.split(current[l], tilings[t].sizes[l], names[l] + tag, inner_name);
+            order.push_back(names[l] + tag);
+            current[l] = inner_name;
+            bounds[l] = tilings[t].sizes[l];
+        }
+    }
+    order.insert(order.end(), current.begin(), current.end());
+    schedule.reorder(order);
+
+    GuardElimination guards;
+    return guards.mutate(schedule.kernel().as<Kernel>()->stmt_list[0]);
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
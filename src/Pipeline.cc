@@ -0,0 +1,62 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <sstream>
+
+#include "CostModel.h"
+#include "Pipeline.h"
+#include "UnrollAndJam.h"
+#include "Vectorization.h"
+
+// set by CMake on this file only, so that a source change rebuilds just it
+#ifndef BOOST_GENERATOR_HASH
+#define BOOST_GENERATOR_HASH "unknown"
+#endif
+
+
+namespace Boost {
+
+namespace Internal {
+
+const char *const pipeline_passes =
+    "IRMutator;Simplifier;GuardElimination;ReductionDetection;LoopPermutation;LoopTiling;"
+    "UnrollAndJam;ScalarReplacement;Vectorization;StrengthReduction;CommonSubexpressionElimination;IRPrinter";
+
+const char *const kernel_cache_dir = "./.kernel_cache";
+
+
+std::string pipeline_options() {
+    std::ostringstream oss;
+    oss << pipeline_passes << ";generator=" << BOOST_GENERATOR_HASH
+        << ";registers=" << UnrollAndJam::host_registers()
+        << ";vector_bytes=" << Vectorization::host_vector_bytes();
+    for (auto cache : host_caches()) {
+        oss << ";L" << cache.level << "=" << cache.size << "/" << cache.line;
+    }
+    return oss.str();
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
@@ -0,0 +1,173 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "ReductionDetection.h"
+#include "IRVisitor.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+/**
+ * names of the indices used by the destinations of the accumulating
+ * statements, and whether there are such statements and assignments
+ * to memory
+ */ 
+class DestinationIndices : public IRVisitor {
+ public:
+    std::set<std::string> names;
+    bool accumulates = false;
+    bool assigns = false;
+
+    void visit(Ref<const Index> op) override {
+        names.insert(op->name);
+    }
+
+    void visit(Ref<const Move> op) override {
+        if (is_accumulation(op->move_type)) {
+            accumulates = true;
+            op->dst.visit_expr(this);
+        } else if (op->move_type == MoveType::LocalToMem) {
+            assigns = true;
+        }
+    }
+
+    void visit(Ref<const Reduce> op) override {
+        accumulates = true;
+        op->dst.visit_expr(this);
+    }
+
+    // loop ranges and guards don't store anything
+    void visit(Ref<const LoopNest> op) override {
+        for (auto &body : op->body_list) {
+            body.visit_stmt(this);
+        }
+    }
+
+    void visit(Ref<const If> op) override {
+        op->true_case.visit_stmt(this);
+    }
+
+    void visit(Ref<const IfThenElse> op) override {
+        op->true_case.visit_stmt(this);
+        if (op->false_case.defined()) {
+            op->false_case.visit_stmt(this);
+        }
+    }
+};
+
+
+class ReplaceIndex : public IRMutator {
+ public:
+    explicit ReplaceIndex(const std::map<std::string, Expr> &_indices) : indices(_indices) {}
+
+    Expr visit(Ref<const Index> op) override {
+        auto it = indices.find(op->name);
+        return it == indices.end() ? Expr(op) : it->second;
+    }
+
+ private:
+    const std::map<std::string, Expr> &indices;
+};
+
+}  // anonymous namespace
+
+
+bool is_accumulation(MoveType t) {
+    return t == MoveType::MemToMem || t == MoveType::LocalToLocal;
+}
+
+
+Expr reduction_identity(Type t, BinaryOpType combiner) {
+    bool one = combiner == BinaryOpType::Mul || combiner == BinaryOpType::And;
+    if (t.is_float()) {
+        return FloatImm::make(t, one ? 1.0 : 0.0);
+    }
+    if (t.is_uint()) {
+        return UIntImm::make(t, one ? 1 : 0);
+    }
+    return IntImm::make(t, one ? 1 : 0);
+}
+
+
+Stmt ReductionDetection::visit(Ref<const LoopNest> op) {
+    DestinationIndices used;
+    for (auto &body : op->body_list) {
+        body.visit_stmt(&used);
+    }
+    // an assignment keeps the value of the last iteration, it is no reduction
+    bool reduces = used.accumulates && !used.assigns;
+    std::map<std::string, Expr> reduce;
+    std::vector<Expr> new_index_list;
+    for (auto &index : op->index_list) {
+        auto idx = index.as<Index>();
+        if (!reduces || used.names.count(idx->name) || idx->index_type != IndexType::Spatial) {
+            new_index_list.push_back(index);
+            if (idx->index_type == IndexType::Reduce) {
+                reduce[idx->name] = index;
+            }
+            continue;
+        }
+        Expr axis = Index::make(idx->type(), idx->name, idx->dom, IndexType::Reduce);
+        reduce[idx->name] = axis;
+        new_index_list.push_back(axis);
+    }
+    if (reduce.empty()) {
+        return IRMutator::visit(op);
+    }
+
+    size_t depth = axes.size();
+    for (auto &index : new_index_list) {
+        if (reduce.count(index.as<Index>()->name)) {
+            axes.push_back(index);
+        }
+    }
+    ReplaceIndex replace(reduce);
+    std::vector<Stmt> new_body_list;
+    for (auto &body : op->body_list) {
+        new_body_list.push_back(mutate(replace.mutate(body)));
+    }
+    axes.resize(depth);
+    return LoopNest::make(new_index_list, new_body_list);
+}
+
+
+Stmt ReductionDetection::visit(Ref<const Move> op) {
+    if (axes.empty() || !is_accumulation(op->move_type)) {
+        return op;
+    }
+    return Reduce::make(op->dst, op->src, BinaryOpType::Add,
+        reduction_identity(op->dst->type(), BinaryOpType::Add), axes);
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
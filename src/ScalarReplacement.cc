@@ -0,0 +1,160 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <vector>
+
+#include "ScalarReplacement.h"
+#include "IREquality.h"
+#include "IRUtil.h"
+#include "IRVisitor.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+bool uses_any(const Expr &e, const std::set<std::string> &indices) {
+    NameCollector used;
+    e.visit_expr(&used);
+    for (auto &name : used.names) {
+        if (indices.count(name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+}  // anonymous namespace
+
+
+Group ScalarReplacement::visit(Ref<const Kernel> op) {
+    NameCollector names;
+    Group(op).visit_group(&names);
+    taken.insert(names.names.begin(), names.names.end());
+    return IRMutator::visit(op);
+}
+
+
+Expr ScalarReplacement::make_local(const Expr &var, const std::string &suffix) {
+    std::string base = var.as<Var>()->name + suffix;
+    std::string name = base;
+    for (int n = 1; taken.count(name); ++n) {
+        name = base + std::to_string(n);
+    }
+    taken.insert(name);
+    locals.insert(name);
+    return Var::make(var->type(), name, {}, {1});
+}
+
+
+Stmt ScalarReplacement::visit(Ref<const LoopNest> op) {
+    if (op->index_list.empty() || op->body_list.size() != 1) {
+        return IRMutator::visit(op);
+    }
+    Stmt body = op->body_list[0];
+    auto move = body.as<Move>();
+    auto reduce = body.as<Reduce>();
+    if ((move == nullptr || move->move_type != MoveType::MemToMem) && reduce == nullptr) {
+        return IRMutator::visit(op);
+    }
+    Expr dst = move != nullptr ? move->dst : reduce->dst;
+    Expr src = move != nullptr ? move->src : reduce->value;
+    auto dst_var = dst.as<Var>();
+    if (dst_var == nullptr) {
+        return op;
+    }
+
+    // the innermost loops the destination does not depend on
+    size_t n = op->index_list.size();
+    size_t split = n;
+    std::set<std::string> inner;
+    while (split > 0) {
+        std::set<std::string> more = inner;
+        more.insert(op->index_list[split - 1].as<Index>()->name);
+        if (uses_any(dst, more)) {
+            break;
+        }
+        inner = more;
+        --split;
+    }
+
+    LoadCollector loads;
+    src.visit_expr(&loads);
+    bool accumulate = split < n && !locals.count(dst_var->name);
+    for (auto &load : loads.loads) {
+        if (load.as<Var>()->name == dst_var->name && !deep_equal(load, dst)) {
+            accumulate = false;
+        }
+    }
+    if (!accumulate) {
+        // only hoist out of the innermost loop
+        split = n - 1;
+        inner = {op->index_list[split].as<Index>()->name};
+    }
+
+    std::vector<Stmt> before, after;
+    ReplaceLoads replace;
+    if (accumulate) {
+        Expr acc = make_local(dst, "_acc");
+        replace.replacements.emplace_back(dst, acc);
+        before.push_back(Move::make(acc, dst, MoveType::MemToLocal));
+        after.push_back(Move::make(dst, acc, MoveType::LocalToMem));
+    }
+    for (auto &load : loads.loads) {
+        auto var = load.as<Var>();
+        if (var->name == dst_var->name || locals.count(var->name) || uses_any(load, inner)) {
+            continue;
+        }
+        bool seen = false;
+        for (auto &r : replace.replacements) {
+            seen = seen || deep_equal(load, r.first);
+        }
+        if (!seen) {
+            Expr value = make_local(load, "_val");
+            replace.replacements.emplace_back(load, value);
+            before.push_back(Move::make(value, load, MoveType::MemToLocal));
+        }
+    }
+    if (before.empty()) {
+        return op;
+    }
+
+    Expr new_dst = replace.mutate(dst);
+    Expr new_src = replace.mutate(src);
+    Stmt new_body = move != nullptr ? Move::make(new_dst, new_src, MoveType::MemToMem)
+        : Reduce::make(new_dst, new_src, reduce->combiner, reduce->identity, reduce->axes);
+    std::vector<Expr> outer(op->index_list.begin(), op->index_list.begin() + split);
+    std::vector<Expr> loops(op->index_list.begin() + split, op->index_list.end());
+    std::vector<Stmt> body_list = before;
+    body_list.push_back(LoopNest::make(loops, {new_body}));
+    body_list.insert(body_list.end(), after.begin(), after.end());
+    return LoopNest::make(outer, body_list);
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
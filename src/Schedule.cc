@@ -0,0 +1,406 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <set>
+
+#include "Schedule.h"
+#include "AffineAccess.h"
+#include "Dependence.h"
+#include "IREquality.h"
+#include "IRMutator.h"
+#include "IRUtil.h"
+#include "IRVisitor.h"
+#include "Simplifier.h"
+#include "debug.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+int position(Ref<const LoopNest> op, const std::string &loop) {
+    for (size_t p = 0; p < op->index_list.size(); ++p) {
+        if (op->index_list[p].as<Index>()->name == loop) {
+            return static_cast<int>(p);
+        }
+    }
+    return -1;
+}
+
+
+/**
+ * calls rewrite on each (flattened) nest with one of the loops, the
+ * nests inside it are left to rewrite. The result is simplified, which
+ * also puts back the brackets substituted expressions need
+ */ 
+class LoopRewriter : public IRMutator {
+ public:
+    typedef std::function<Stmt(Ref<const LoopNest>)> Rewrite;
+
+    LoopRewriter(const std::vector<std::string> &_loops, Rewrite _rewrite) :
+        IRMutator(false), loops(_loops), rewrite(_rewrite) {}
+
+    int found = 0;
+
+    Stmt visit(Ref<const LoopNest> op) override {
+        for (auto &loop : loops) {
+            if (position(op, loop) >= 0) {
+                ++found;
+                return Simplifier().simplify(rewrite(flatten(op)));
+            }
+        }
+        return IRMutator::visit(op);
+    }
+
+ private:
+    std::vector<std::string> loops;
+    Rewrite rewrite;
+};
+
+
+Group rewrite_loops(const Group &kernel, const std::vector<std::string> &loops, LoopRewriter::Rewrite rewrite) {
+    LoopRewriter rewriter(loops, rewrite);
+    Group result = rewriter.mutate(kernel);
+    CHECK(rewriter.found > 0, "no loop named %s\n", loops[0].c_str());
+    return result;
+}
+
+
+Expr add(const Expr &a, const Expr &b) {
+    auto imm = a.as<IntImm>();
+    if (imm != nullptr && imm->value() == 0) {
+        return b;
+    }
+    return Binary::make(b->type(), BinaryOpType::Add, a, b);
+}
+
+
+/**
+ * the statements inside loop p of the nest: the loops after it around the body
+ */ 
+std::vector<Stmt> inside(Ref<const LoopNest> op, size_t p) {
+    if (p + 1 == op->index_list.size()) {
+        return op->body_list;
+    }
+    std::vector<Expr> loops(op->index_list.begin() + p + 1, op->index_list.end());
+    return {LoopNest::make(loops, op->body_list)};
+}
+
+
+std::vector<size_t> count_statements(const std::vector<Stmt> &stmts) {
+    std::vector<size_t> counts;
+    for (auto &stmt : stmts) {
+        counts.push_back(analyze_accesses(stmt).size());
+    }
+    return counts;
+}
+
+
+bool writes(const Stmt &stmt, const std::string &array) {
+    for (auto &s : analyze_accesses(stmt)) {
+        for (auto &access : s.accesses) {
+            if (access.is_write && access.name() == array) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+}  // anonymous namespace
+
+
+Schedule &Schedule::split(const std::string &loop, int64_t factor, const std::string &outer,
+    const std::string &inner) {
+    CHECK(factor > 0, "split factor of %s must be positive\n", loop.c_str());
+    current = rewrite_loops(current, {loop}, [&](Ref<const LoopNest> op) {
+        size_t p = position(op, loop);
+        auto index = op->index_list[p].as<Index>();
+        auto dom = index->dom.as<Dom>();
+        Type t = index->type();
+        Expr f = IntImm::make(t, factor);
+        auto extent = dom->extent.as<IntImm>();
+        Expr outer_extent = extent != nullptr ? Expr(IntImm::make(t, (extent->value() + factor - 1) / factor))
+            : Binary::make(t, BinaryOpType::Div, add(dom->extent, IntImm::make(t, factor - 1)), f);
+        Expr outer_index = Index::make(t, outer, Dom::make(t, IntImm::make(t, 0), outer_extent), index->index_type);
+        Expr inner_index = Index::make(t, inner, Dom::make(t, IntImm::make(t, 0), f), index->index_type);
+        Expr value = add(dom->begin, add(Binary::make(t, BinaryOpType::Mul, outer_index, f), inner_index));
+
+        Substitute substitute;
+        substitute.values[loop] = value;
+        std::vector<Expr> loops(op->index_list.begin(), op->index_list.begin() + p);
+        loops.push_back(outer_index);
+        loops.push_back(inner_index);
+        for (size_t q = p + 1; q < op->index_list.size(); ++q) {
+            loops.push_back(substitute.mutate(op->index_list[q]));
+        }
+        std::vector<Stmt> body;
+        for (auto &stmt : op->body_list) {
+            body.push_back(substitute.mutate(stmt));
+        }
+        if (extent == nullptr || extent->value() % factor != 0) {
+            Expr cond = Compare::make(t, CompareOpType::LT, value, add(dom->begin, dom->extent));
+            // one guard per body, the form GuardElimination takes apart
+            auto guard = body.size() == 1 ? body[0].as<If>() : nullptr;
+            if (guard != nullptr) {
+                body = {If::make(Binary::make(t, BinaryOpType::And, guard->cond, cond), guard->true_case)};
+            } else {
+                body = {If::make(cond, body.size() == 1 ? body[0] : LoopNest::make({}, body))};
+            }
+        }
+        return LoopNest::make(loops, body);
+    });
+    return *this;
+}
+
+
+Schedule &Schedule::reorder(const std::vector<std::string> &order) {
+    current = rewrite_loops(current, order, [&](Ref<const LoopNest> op) {
+        std::vector<size_t> places;
+        for (auto &loop : order) {
+            int p = position(op, loop);
+            CHECK(p >= 0, "%s is not in the nest of %s\n", loop.c_str(), order[0].c_str());
+            places.push_back(p);
+        }
+        std::vector<size_t> sorted = places;
+        std::sort(sorted.begin(), sorted.end());
+        // perm[l]: the old level of the loop at new level l
+        std::vector<size_t> perm;
+        for (size_t p = 0; p < op->index_list.size(); ++p) {
+            perm.push_back(p);
+        }
+        for (size_t l = 0; l < sorted.size(); ++l) {
+            perm[sorted[l]] = places[l];
+        }
+        std::vector<Expr> loops;
+        std::set<std::string> outside;
+        for (auto p : perm) {
+            auto index = op->index_list[p].as<Index>();
+            NameCollector bounds;
+            index->dom.visit_expr(&bounds);
+            for (auto &name : bounds.names) {
+                CHECK(outside.count(name) || position(op, name) < 0,
+                    "the bounds of %s depend on %s, it can't move outside\n", index->name.c_str(), name.c_str());
+            }
+            outside.insert(index->name);
+            loops.push_back(op->index_list[p]);
+        }
+        std::vector<StmtAccesses> stmts = analyze_accesses(Stmt(op));
+        CHECK(is_permutation_legal(analyze_dependences(stmts), perm),
+            "reordering %s breaks a dependence\n", order[0].c_str());
+        return LoopNest::make(loops, op->body_list);
+    });
+    return *this;
+}
+
+
+Schedule &Schedule::fuse(const std::string &outer, const std::string &inner, const std::string &fused) {
+    current = rewrite_loops(current, {outer}, [&](Ref<const LoopNest> op) {
+        size_t p = position(op, outer);
+        CHECK(position(op, inner) == static_cast<int>(p) + 1, "%s is not right inside %s\n",
+            inner.c_str(), outer.c_str());
+        auto outer_index = op->index_list[p].as<Index>();
+        auto inner_index = op->index_list[p + 1].as<Index>();
+        auto outer_dom = outer_index->dom.as<Dom>();
+        auto inner_dom = inner_index->dom.as<Dom>();
+        NameCollector bounds;
+        inner_index->dom.visit_expr(&bounds);
+        CHECK(!bounds.names.count(outer), "the bounds of %s depend on %s\n", inner.c_str(), outer.c_str());
+        Type t = outer_index->type();
+        auto outer_extent = outer_dom->extent.as<IntImm>();
+        auto inner_extent = inner_dom->extent.as<IntImm>();
+        Expr extent = outer_extent != nullptr && inner_extent != nullptr
+            ? Expr(IntImm::make(t, outer_extent->value() * inner_extent->value()))
+            : Binary::make(t, BinaryOpType::Mul, outer_dom->extent, inner_dom->extent);
+        Expr fused_index = Index::make(t, fused, Dom::make(t, IntImm::make(t, 0), extent), outer_index->index_type);
+
+        Substitute substitute;
+        substitute.values[outer] = add(outer_dom->begin,
+            Binary::make(t, BinaryOpType::Div, fused_index, inner_dom->extent));
+        substitute.values[inner] = add(inner_dom->begin,
+            Binary::make(t, BinaryOpType::Mod, fused_index, inner_dom->extent));
+        std::vector<Expr> loops(op->index_list.begin(), op->index_list.begin() + p);
+        loops.push_back(fused_index);
+        for (size_t q = p + 2; q < op->index_list.size(); ++q) {
+            loops.push_back(substitute.mutate(op->index_list[q]));
+        }
+        std::vector<Stmt> body;
+        for (auto &stmt : op->body_list) {
+            body.push_back(substitute.mutate(stmt));
+        }
+        return LoopNest::make(loops, body);
+    });
+    return *this;
+}
+
+
+Schedule &Schedule::tile(const std::string &x, const std::string &y,
+    const std::string &x_outer, const std::string &y_outer,
+    const std::string &x_inner, const std::string &y_inner, int64_t x_factor, int64_t y_factor) {
+    return split(x, x_factor, x_outer, x_inner).split(y, y_factor, y_outer, y_inner)
+        .reorder({x_outer, y_outer, x_inner, y_inner});
+}
+
+
+Schedule &Schedule::unroll(const std::string &loop) {
+    current = rewrite_loops(current, {loop}, [&](Ref<const LoopNest> op) {
+        size_t p = position(op, loop);
+        auto index = op->index_list[p].as<Index>();
+        auto dom = index->dom.as<Dom>();
+        auto begin = dom->begin.as<IntImm>();
+        auto extent = dom->extent.as<IntImm>();
+        CHECK(begin != nullptr && extent != nullptr, "%s has no constant bounds to unroll\n", loop.c_str());
+        std::vector<Stmt> body = inside(op, p);
+        std::vector<Stmt> copies;
+        for (int64_t v = 0; v < extent->value(); ++v) {
+            Substitute substitute;
+            substitute.values[loop] = IntImm::make(index->type(), begin->value() + v);
+            for (auto &stmt : body) {
+                copies.push_back(substitute.mutate(stmt));
+            }
+        }
+        std::vector<Expr> loops(op->index_list.begin(), op->index_list.begin() + p);
+        return LoopNest::make(loops, copies);
+    });
+    return *this;
+}
+
+
+Schedule &Schedule::mark(const std::string &loop, IndexType index_type, bool innermost) {
+    current = rewrite_loops(current, {loop}, [&](Ref<const LoopNest> op) {
+        size_t p = position(op, loop);
+        CHECK(!innermost || p + 1 == op->index_list.size(), "%s is not an innermost loop\n", loop.c_str());
+        if (index_type == IndexType::Parallel || index_type == IndexType::Vectorized) {
+            std::vector<StmtAccesses> stmts = analyze_accesses(Stmt(op));
+            std::vector<Dependence> deps = analyze_dependences(stmts);
+            for (size_t s = 0; s < stmts.size(); ++s) {
+                CHECK(is_parallel(deps, stmts, s, p), "%s carries a dependence\n", loop.c_str());
+            }
+        }
+        auto index = op->index_list[p].as<Index>();
+        Expr marked = Index::make(index->type(), index->name, index->dom, index_type);
+        Substitute substitute;
+        substitute.values[loop] = marked;
+        std::vector<Expr> loops = op->index_list;
+        loops[p] = marked;
+        std::vector<Stmt> body;
+        for (auto &stmt : op->body_list) {
+            body.push_back(substitute.mutate(stmt));
+        }
+        return LoopNest::make(loops, body);
+    });
+    return *this;
+}
+
+
+Schedule &Schedule::vectorize(const std::string &loop) {
+    return mark(loop, IndexType::Vectorized, true);
+}
+
+
+Schedule &Schedule::parallel(const std::string &loop) {
+    return mark(loop, IndexType::Parallel, false);
+}
+
+
+Schedule &Schedule::compute_at(const std::string &producer, const std::string &loop) {
+    auto kernel = current.as<Kernel>();
+    std::vector<Stmt> stmts = kernel->stmt_list;
+    size_t consumer = 0;
+    int depth = -1;
+    for (; consumer < stmts.size() && depth < 0; ++consumer) {
+        if (auto nest = stmts[consumer].as<LoopNest>()) {
+            depth = position(flatten(nest), loop);
+        }
+    }
+    CHECK(depth >= 0, "no top level nest has a loop %s\n", loop.c_str());
+    --consumer;
+    size_t source = consumer;
+    while (source > 0 && !writes(stmts[source - 1], producer)) {
+        --source;
+    }
+    CHECK(source > 0, "%s is not computed before the nest of %s\n", producer.c_str(), loop.c_str());
+    --source;
+    CHECK(stmts[source].as<LoopNest>() != nullptr, "%s is not computed in a loop nest\n", producer.c_str());
+    auto from = flatten(stmts[source].as<LoopNest>());
+    auto into = flatten(stmts[consumer].as<LoopNest>());
+    CHECK(static_cast<int>(from->index_list.size()) > depth, "%s has fewer loops than the nest of %s\n",
+        producer.c_str(), loop.c_str());
+
+    // the producer's outer loops become the consumer's
+    Substitute substitute;
+    for (int l = 0; l <= depth; ++l) {
+        auto shared = substitute.mutate(from->index_list[l]).as<Index>();
+        auto target = into->index_list[l].as<Index>();
+        CHECK(deep_equal(shared->dom, target->dom), "%s and %s have different bounds\n",
+            shared->name.c_str(), target->name.c_str());
+        substitute.values[shared->name] = into->index_list[l];
+    }
+    std::vector<Stmt> body;
+    for (auto &stmt : inside(from, depth)) {
+        body.push_back(substitute.mutate(stmt));
+    }
+    size_t produced = analyze_accesses(LoopNest::make({}, body)).size();
+    for (auto &stmt : inside(into, depth)) {
+        body.push_back(stmt);
+    }
+    std::vector<Expr> loops(into->index_list.begin(), into->index_list.begin() + depth + 1);
+    Stmt fused = LoopNest::make(loops, body);
+
+    // no consumer iteration may now run before a producer iteration it depends on
+    std::vector<StmtAccesses> accesses = analyze_accesses(fused);
+    for (auto &dep : analyze_dependences(accesses)) {
+        CHECK(dep.src_stmt < produced || dep.dst_stmt >= produced,
+            "the nest of %s uses %s computed in later iterations\n", loop.c_str(), producer.c_str());
+    }
+    // nor may the producer move past statements it depends on
+    std::vector<size_t> counts = count_statements(stmts);
+    std::vector<Dependence> deps = analyze_dependences(analyze_accesses(current));
+    size_t first = 0;
+    for (size_t s = 0; s < source; ++s) {
+        first += counts[s];
+    }
+    size_t between = first + counts[source];
+    for (size_t s = source + 1; s < consumer; ++s) {
+        for (size_t a = first; a < first + counts[source]; ++a) {
+            for (size_t b = between; b < between + counts[s]; ++b) {
+                CHECK(are_independent(deps, a, b), "%s can't move past statement %zu\n", producer.c_str(), s);
+            }
+        }
+        between += counts[s];
+    }
+
+    stmts[consumer] = fused;
+    stmts.erase(stmts.begin() + source);
+    current = Kernel::make(kernel->name, kernel->inputs, kernel->outputs, stmts, kernel->kernel_type);
+    return *this;
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
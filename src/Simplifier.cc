@@ -0,0 +1,479 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+
+#include "Simplifier.h"
+#include "IREquality.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+const int max_rounds = 16;
+
+
+bool is_integer(const Type &t) {
+    return t.is_int() || t.is_uint();
+}
+
+
+bool int_value(const Expr &e, int64_t &value) {
+    if (auto imm = e.as<IntImm>()) {
+        value = imm->value();
+        return true;
+    }
+    if (auto imm = e.as<UIntImm>()) {
+        value = static_cast<int64_t>(imm->value());
+        return true;
+    }
+    return false;
+}
+
+
+bool const_value(const Expr &e, double &value) {
+    int64_t i;
+    if (int_value(e, i)) {
+        value = static_cast<double>(i);
+        return true;
+    }
+    if (auto imm = e.as<FloatImm>()) {
+        value = imm->value();
+        return true;
+    }
+    return false;
+}
+
+
+bool is_const(const Expr &e) {
+    double value;
+    return const_value(e, value);
+}
+
+
+bool is_const(const Expr &e, double expected) {
+    double value;
+    return const_value(e, value) && value == expected;
+}
+
+
+/**
+ * whether the printer writes v back as the same float literal
+ */ 
+bool prints_exactly(double v) {
+    std::ostringstream oss;
+    oss << v;
+    std::string text = oss.str();
+    return text.find_first_of(".e") != std::string::npos && std::strtod(text.c_str(), nullptr) == v;
+}
+
+
+/**
+ * whether v is a value of the integer type t
+ */ 
+bool fits(const Type &t, int64_t v) {
+    if (t.bits >= 64) {
+        return t.is_int() || v >= 0;
+    }
+    if (t.is_uint()) {
+        return v >= 0 && (t.bits == 63 || v < (static_cast<int64_t>(1) << t.bits));
+    }
+    int64_t bound = static_cast<int64_t>(1) << (t.bits - 1);
+    return v >= -bound && v < bound;
+}
+
+
+/**
+ * x op y as a value of type t, false when it overflows t: the C code
+ * would be undefined or wrap, so the expression stays as it is
+ */ 
+bool fold_int(BinaryOpType op, int64_t x, int64_t y, const Type &t, int64_t &result) {
+    switch (op) {
+        case BinaryOpType::Add:
+            if ((y > 0 && x > INT64_MAX - y) || (y < 0 && x < INT64_MIN - y)) {
+                return false;
+            }
+            result = x + y;
+            break;
+        case BinaryOpType::Sub:
+            if ((y < 0 && x > INT64_MAX + y) || (y > 0 && x < INT64_MIN + y)) {
+                return false;
+            }
+            result = x - y;
+            break;
+        case BinaryOpType::Mul:
+            if ((x == -1 && y == INT64_MIN) || (y == -1 && x == INT64_MIN)) {
+                return false;
+            }
+            result = static_cast<int64_t>(static_cast<uint64_t>(x) * static_cast<uint64_t>(y));
+            if (y != 0 && result / y != x) {
+                return false;
+            }
+            break;
+        case BinaryOpType::Div:
+        case BinaryOpType::Mod:
+            if (y == 0 || (x == INT64_MIN && y == -1)) {
+                return false;
+            }
+            result = op == BinaryOpType::Div ? x / y : x % y;
+            break;
+        default:
+            return false;
+    }
+    return fits(t, result);
+}
+
+
+bool fold_float(BinaryOpType op, double x, double y, double &result) {
+    switch (op) {
+        case BinaryOpType::Add: result = x + y; break;
+        case BinaryOpType::Sub: result = x - y; break;
+        case BinaryOpType::Mul: result = x * y; break;
+        case BinaryOpType::Div:
+            if (y == 0) {
+                return false;
+            }
+            result = x / y;
+            break;
+        default:
+            return false;
+    }
+    return prints_exactly(result);
+}
+
+
+bool is_commutative(BinaryOpType op) {
+    return op == BinaryOpType::Add || op == BinaryOpType::Mul
+        || op == BinaryOpType::And || op == BinaryOpType::Or;
+}
+
+
+/**
+ * canonical operand order: compound, loads, indices, constants
+ */ 
+int rank(const Expr &e) {
+    if (is_const(e)) {
+        return 3;
+    }
+    if (e.as<Index>()) {
+        return 2;
+    }
+    if (e.as<Var>()) {
+        return 1;
+    }
+    return 0;
+}
+
+
+std::string leaf_name(const Expr &e) {
+    if (auto index = e.as<Index>()) {
+        return index->name;
+    }
+    return e.as<Var>()->name;
+}
+
+
+bool should_swap(const Expr &a, const Expr &b) {
+    int ra = rank(a);
+    int rb = rank(b);
+    if (ra != rb) {
+        return ra > rb;
+    }
+    return (ra == 1 || ra == 2) && leaf_name(b) < leaf_name(a);
+}
+
+
+int precedence(BinaryOpType op) {
+    switch (op) {
+        case BinaryOpType::Mul:
+        case BinaryOpType::Div:
+        case BinaryOpType::Mod:
+            return 4;
+        case BinaryOpType::Add:
+        case BinaryOpType::Sub:
+            return 3;
+        case BinaryOpType::And:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* between arithmetic and && */
+const int compare_precedence = 2;
+
+
+Expr with_bracket(const Expr &e, bool bracket) {
+    auto op = e.as<Binary>();
+    if (op == nullptr || op->bracket == bracket) {
+        return e;
+    }
+    return Binary::make(op->type(), op->op_type, op->a, op->b, bracket);
+}
+
+
+/**
+ * a Binary operand needs parentheses when it binds weaker than its
+ * parent, or as strong on the right (C groups from the left)
+ */ 
+bool needs_bracket(int parent, const Expr &child, bool right) {
+    auto op = child.as<Binary>();
+    if (op == nullptr) {
+        return false;
+    }
+    int p = precedence(op->op_type);
+    return p < parent || (right && p == parent);
+}
+
+
+/**
+ * recomputes every Binary::bracket from precedence
+ */ 
+class Brackets : public IRMutator {
+ public:
+    Brackets() : IRMutator(true) {}
+
+    Expr visit(Ref<const Binary> op) override {
+        int p = precedence(op->op_type);
+        Expr a = mutate(op->a);
+        Expr b = mutate(op->b);
+        a = with_bracket(a, needs_bracket(p, a, false));
+        b = with_bracket(b, needs_bracket(p, b, true));
+        if (a.get() == op->a.get() && b.get() == op->b.get() && !op->bracket) {
+            return op;
+        }
+        return Binary::make(op->type(), op->op_type, a, b, false);
+    }
+
+    Expr visit(Ref<const Unary> op) override {
+        Expr a = mutate(op->a);
+        a = with_bracket(a, a.as<Binary>() != nullptr);
+        if (a.get() == op->a.get()) {
+            return op;
+        }
+        return Unary::make(op->type(), op->op_type, a);
+    }
+
+    Expr visit(Ref<const Compare> op) override {
+        Expr a = mutate(op->a);
+        Expr b = mutate(op->b);
+        a = with_bracket(a, needs_bracket(compare_precedence, a, false));
+        b = with_bracket(b, needs_bracket(compare_precedence, b, true));
+        if (a.get() == op->a.get() && b.get() == op->b.get()) {
+            return op;
+        }
+        return Compare::make(op->type(), op->op_type, a, b);
+    }
+};
+
+}  // anonymous namespace
+
+
+Expr Simplifier::visit(Ref<const Unary> op) {
+    return rewrite(IRMutator::visit(op));
+}
+
+
+Expr Simplifier::visit(Ref<const Binary> op) {
+    return rewrite(IRMutator::visit(op));
+}
+
+
+Expr Simplifier::rewrite(const Expr &e) {
+    if (auto op = e.as<Unary>()) {
+        if (op->op_type != UnaryOpType::Neg) {
+            return e;
+        }
+        int64_t i;
+        double d;
+        if (int_value(op->a, i) && op->a.as<IntImm>() && i != INT64_MIN && fits(op->a->type(), -i)) {
+            return IntImm::make(op->a->type(), -i);
+        }
+        if (const_value(op->a, d) && op->a.as<FloatImm>()) {
+            return FloatImm::make(op->a->type(), -d);
+        }
+        auto inner = op->a.as<Unary>();
+        if (inner != nullptr && inner->op_type == UnaryOpType::Neg) {
+            return inner->a;
+        }
+        return e;
+    }
+
+    auto op = e.as<Binary>();
+    if (op == nullptr) {
+        return e;
+    }
+    Type t = op->type();
+    BinaryOpType op_type = op->op_type;
+    Expr a = op->a;
+    Expr b = op->b;
+    bool integer = is_integer(t) && is_integer(a->type()) && is_integer(b->type());
+    bool algebra = integer || (reassociate_floats && t.is_float());
+
+    // constant folding
+    int64_t x, y, r;
+    double dx, dy, dr;
+    if (int_value(a, x) && int_value(b, y) && a.as<FloatImm>() == nullptr && b.as<FloatImm>() == nullptr) {
+        if (fold_int(op_type, x, y, a->type(), r)) {
+            return IntImm::make(a->type(), r);
+        }
+        return e;
+    }
+    if (const_value(a, dx) && const_value(b, dy)) {
+        if (fold_float(op_type, dx, dy, dr)) {
+            return FloatImm::make(a.as<FloatImm>() ? a->type() : b->type(), dr);
+        }
+        return e;
+    }
+
+    if (is_commutative(op_type) && should_swap(a, b)) {
+        return rewrite(Binary::make(t, op_type, b, a));
+    }
+
+    // identities
+    switch (op_type) {
+        case BinaryOpType::Add:
+            if (algebra && is_const(b, 0)) {
+                return a;
+            }
+            break;
+        case BinaryOpType::Sub:
+            if (is_const(b, 0)) {
+                return a;
+            }
+            if (integer && deep_equal(a, b)) {
+                return IntImm::make(t, 0);
+            }
+            break;
+        case BinaryOpType::Mul:
+            if (is_const(b, 1)) {
+                return a;
+            }
+            if (algebra && is_const(b, 0)) {
+                return b;
+            }
+            break;
+        case BinaryOpType::Div:
+            if (is_const(b, 1)) {
+                return a;
+            }
+            break;
+        case BinaryOpType::Mod:
+            if (integer && is_const(b, 1)) {
+                return IntImm::make(t, 0);
+            }
+            break;
+        default:
+            break;
+    }
+    if (!algebra || !is_const(b)) {
+        return e;
+    }
+
+    // chains of constants
+    auto inner = a.as<Binary>();
+    bool additive = op_type == BinaryOpType::Add || op_type == BinaryOpType::Sub;
+    if (inner != nullptr && is_const(inner->b)) {
+        bool inner_additive = inner->op_type == BinaryOpType::Add || inner->op_type == BinaryOpType::Sub;
+        if (additive && inner_additive) {
+            // (x +- c1) +- c2 = x + (+-c1 +- c2)
+            Expr c1 = inner->op_type == BinaryOpType::Add ? inner->b : rewrite(Unary::make(t, UnaryOpType::Neg, inner->b));
+            Expr c = rewrite(Binary::make(t, op_type, c1, b));
+            if (is_const(c)) {
+                return rewrite(Binary::make(t, BinaryOpType::Add, inner->a, c));
+            }
+        }
+        if (op_type == BinaryOpType::Mul && inner->op_type == BinaryOpType::Mul) {
+            Expr c = rewrite(Binary::make(t, BinaryOpType::Mul, inner->b, b));
+            if (is_const(c)) {
+                return rewrite(Binary::make(t, BinaryOpType::Mul, inner->a, c));
+            }
+        }
+        int64_t c1, c2;
+        if (integer && inner->op_type == BinaryOpType::Mul && int_value(inner->b, c1) && int_value(b, c2)
+            && c1 == c2 && c1 != 0) {
+            if (op_type == BinaryOpType::Div) {
+                return inner->a;
+            }
+            if (op_type == BinaryOpType::Mod) {
+                return IntImm::make(t, 0);
+            }
+        }
+    }
+    // x + -c reads better as x - c
+    if (integer && additive && int_value(b, y) && y < 0 && b.as<IntImm>() && y != INT64_MIN
+        && fits(b->type(), -y)) {
+        return Binary::make(t, op_type == BinaryOpType::Add ? BinaryOpType::Sub : BinaryOpType::Add,
+            a, IntImm::make(b->type(), -y));
+    }
+    return e;
+}
+
+
+Expr Simplifier::simplify(const Expr &expr) {
+    Expr result = expr;
+    for (int round = 0; round < max_rounds; ++round) {
+        Expr next = mutate(result);
+        if (next.get() == result.get()) {
+            break;
+        }
+        result = next;
+    }
+    return Brackets().mutate(result);
+}
+
+
+Stmt Simplifier::simplify(const Stmt &stmt) {
+    Stmt result = stmt;
+    for (int round = 0; round < max_rounds; ++round) {
+        Stmt next = mutate(result);
+        if (next.get() == result.get()) {
+            break;
+        }
+        result = next;
+    }
+    return Brackets().mutate(result);
+}
+
+
+Group Simplifier::simplify(const Group &group) {
+    Group result = group;
+    for (int round = 0; round < max_rounds; ++round) {
+        Group next = mutate(result);
+        if (next.get() == result.get()) {
+            break;
+        }
+        result = next;
+    }
+    return Brackets().mutate(result);
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
@@ -0,0 +1,427 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include <vector>
+
+#include "StrengthReduction.h"
+#include "IREquality.h"
+#include "IRUtil.h"
+#include "IRVisitor.h"
+#include "Simplifier.h"
+#include "arith.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+bool uses_any(const Expr &e, const std::vector<std::string> &indices) {
+    NameCollector used;
+    e.visit_expr(&used);
+    for (auto &name : indices) {
+        if (used.names.count(name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * sum of coef[k] * loop k, an invariant rest and a constant
+ */ 
+struct Affine {
+    std::vector<int64_t> coef;
+    int64_t constant = 0;
+    /* undefined when there is none */
+    Expr rest;
+
+    int nonzero() const {
+        int n = 0;
+        for (auto c : coef) {
+            n += c != 0;
+        }
+        return n;
+    }
+};
+
+
+Expr combine(Type t, BinaryOpType op, const Expr &a, const Expr &b) {
+    if (!b.defined()) {
+        return a;
+    }
+    if (!a.defined()) {
+        return op == BinaryOpType::Add ? b : Unary::make(t, UnaryOpType::Neg, b);
+    }
+    return Binary::make(t, op, a, b);
+}
+
+
+void scale(Affine &form, int64_t c, Type t) {
+    for (auto &k : form.coef) {
+        k *= c;
+    }
+    form.constant *= c;
+    if (form.rest.defined()) {
+        form.rest = Binary::make(t, BinaryOpType::Mul, form.rest, IntImm::make(t, c));
+    }
+}
+
+
+/**
+ * e as an affine form of the loops, false when it is not one or its
+ * invariant part reads memory
+ */ 
+bool affine(const Expr &e, const std::vector<std::string> &loops, Affine &form) {
+    form.coef.assign(loops.size(), 0);
+    if (!e->type().is_int()) {
+        return false;
+    }
+    if (auto imm = e.as<IntImm>()) {
+        form.constant = imm->value();
+        return true;
+    }
+    if (auto index = e.as<Index>()) {
+        for (size_t k = 0; k < loops.size(); ++k) {
+            if (loops[k] == index->name) {
+                form.coef[k] = 1;
+                return true;
+            }
+        }
+    }
+    if (auto op = e.as<Unary>()) {
+        if (op->op_type == UnaryOpType::Neg && affine(op->a, loops, form)) {
+            scale(form, -1, e->type());
+            return true;
+        }
+    }
+    if (auto op = e.as<Binary>()) {
+        Affine a, b;
+        if ((op->op_type == BinaryOpType::Add || op->op_type == BinaryOpType::Sub)
+            && affine(op->a, loops, a) && affine(op->b, loops, b)) {
+            int64_t sign = op->op_type == BinaryOpType::Add ? 1 : -1;
+            for (size_t k = 0; k < loops.size(); ++k) {
+                form.coef[k] = a.coef[k] + sign * b.coef[k];
+            }
+            form.constant = a.constant + sign * b.constant;
+            form.rest = combine(e->type(), op->op_type, a.rest, b.rest);
+            return true;
+        }
+        if (op->op_type == BinaryOpType::Mul) {
+            auto ca = op->a.as<IntImm>();
+            auto cb = op->b.as<IntImm>();
+            if (cb != nullptr && affine(op->a, loops, form)) {
+                scale(form, cb->value(), e->type());
+                return true;
+            }
+            if (ca != nullptr && affine(op->b, loops, form)) {
+                scale(form, ca->value(), e->type());
+                return true;
+            }
+        }
+    }
+    NameCollector used;
+    e.visit_expr(&used);
+    if (used.loads || uses_any(e, loops)) {
+        return false;
+    }
+    form.coef.assign(loops.size(), 0);
+    form.constant = 0;
+    form.rest = e;
+    return true;
+}
+
+
+/**
+ * a subscript expression worth an induction variable
+ */ 
+struct Candidate {
+    /* the expression, or the dividend of a / c and a % c */
+    Expr expr;
+    Affine form;
+    /* 0 for a plain affine expression */
+    int64_t divisor = 0;
+    bool quotient = false;
+    bool remainder = false;
+    /* the innermost locals, what the uses are replaced with */
+    Expr value, quot, rem;
+};
+
+
+class CandidateCollector : public IRVisitor {
+ public:
+    CandidateCollector(const std::vector<std::string> &_loops, const std::vector<bool> &_invariant_begin) :
+        loops(_loops), invariant_begin(_invariant_begin) {}
+
+    std::vector<Candidate> candidates;
+
+    void visit(Ref<const Var> op) override {
+        for (auto &arg : op->args) {
+            find(arg);
+        }
+    }
+
+ private:
+    const std::vector<std::string> &loops;
+    const std::vector<bool> &invariant_begin;
+
+    bool begins_known(const Affine &form) {
+        for (size_t k = 0; k < loops.size(); ++k) {
+            if (form.coef[k] != 0 && !invariant_begin[k]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Candidate &add(const Expr &e, const Affine &form, int64_t divisor) {
+        for (auto &c : candidates) {
+            if (c.divisor == divisor && deep_equal(c.expr, e)) {
+                return c;
+            }
+        }
+        candidates.emplace_back();
+        candidates.back().expr = e;
+        candidates.back().form = form;
+        candidates.back().divisor = divisor;
+        return candidates.back();
+    }
+
+    void find(const Expr &e) {
+        Affine form;
+        auto op = e.as<Binary>();
+        if (op != nullptr && (op->op_type == BinaryOpType::Div || op->op_type == BinaryOpType::Mod)) {
+            auto c = op->b.as<IntImm>();
+            if (c != nullptr && c->value() > 0 && affine(op->a, loops, form)
+                && form.nonzero() > 0 && begins_known(form) && Arith::Bounds()(op->a).min >= 0) {
+                bool ascending = true;
+                for (auto k : form.coef) {
+                    ascending = ascending && k >= 0;
+                }
+                if (ascending) {
+                    Candidate &candidate = add(op->a, form, c->value());
+                    candidate.quotient = candidate.quotient || op->op_type == BinaryOpType::Div;
+                    candidate.remainder = candidate.remainder || op->op_type == BinaryOpType::Mod;
+                    return;
+                }
+            }
+        }
+        if (affine(e, loops, form) && begins_known(form)) {
+            bool scaled = false;
+            for (auto k : form.coef) {
+                scaled = scaled || (k != 0 && k != 1 && k != -1);
+            }
+            if (form.nonzero() > 1 || scaled) {
+                add(e, form, 0);
+            }
+            return;
+        }
+        if (op != nullptr) {
+            find(op->a);
+            find(op->b);
+        } else if (auto neg = e.as<Unary>()) {
+            find(neg->a);
+        } else if (e.as<Var>() != nullptr) {
+            e.visit_expr(this);
+        }
+    }
+};
+
+
+/**
+ * replaces the candidate expressions with their innermost locals
+ */ 
+class ReplaceCandidates : public IRMutator {
+ public:
+    explicit ReplaceCandidates(const std::vector<Candidate> &_candidates) : candidates(_candidates) {}
+
+    Expr visit(Ref<const Binary> op) override {
+        for (auto &c : candidates) {
+            if (c.divisor == 0) {
+                if (deep_equal(Expr(op), c.expr)) {
+                    return c.value;
+                }
+                continue;
+            }
+            auto divisor = op->b.as<IntImm>();
+            if (divisor == nullptr || divisor->value() != c.divisor || !deep_equal(op->a, c.expr)) {
+                continue;
+            }
+            if (op->op_type == BinaryOpType::Div) {
+                return c.quot;
+            }
+            if (op->op_type == BinaryOpType::Mod) {
+                return c.rem;
+            }
+        }
+        return IRMutator::visit(op);
+    }
+
+ private:
+    const std::vector<Candidate> &candidates;
+};
+
+}  // anonymous namespace
+
+
+Group StrengthReduction::visit(Ref<const Kernel> op) {
+    NameCollector names;
+    Group(op).visit_group(&names);
+    taken.insert(names.names.begin(), names.names.end());
+    return IRMutator::visit(op);
+}
+
+
+Expr StrengthReduction::make_local(Type t, const std::string &base) {
+    std::string name = base;
+    for (int n = 1; taken.count(name); ++n) {
+        name = base + std::to_string(n);
+    }
+    taken.insert(name);
+    return Var::make(t, name, {}, {1});
+}
+
+
+Stmt StrengthReduction::visit(Ref<const LoopNest> op) {
+    LoopFinder inner;
+    for (auto &body : op->body_list) {
+        body.visit_stmt(&inner);
+    }
+    if (inner.found || op->index_list.empty()) {
+        return IRMutator::visit(op);
+    }
+
+    size_t n = op->index_list.size();
+    std::vector<std::string> loops;
+    for (auto &index : op->index_list) {
+        loops.push_back(index.as<Index>()->name);
+    }
+    std::vector<bool> invariant_begin;
+    for (auto &index : op->index_list) {
+        Expr begin = index.as<Index>()->dom.as<Dom>()->begin;
+        Affine form;
+        invariant_begin.push_back(affine(begin, loops, form) && form.nonzero() == 0);
+    }
+    CandidateCollector collector(loops, invariant_begin);
+    for (auto &body : op->body_list) {
+        body.visit_stmt(&collector);
+    }
+    std::vector<Candidate> &candidates = collector.candidates;
+    if (candidates.empty()) {
+        return op;
+    }
+
+    // declarations before loop k, updates at the end of its body
+    std::vector<std::vector<Stmt> > before(n), after(n);
+    Simplifier simplifier;
+    for (size_t id = 0; id < candidates.size(); ++id) {
+        Candidate &c = candidates[id];
+        Type t = c.expr->type();
+        Expr init = c.form.rest.defined() ? c.form.rest : Expr(IntImm::make(t, 0));
+        init = Binary::make(t, BinaryOpType::Add, init, IntImm::make(t, c.form.constant));
+        for (size_t k = 0; k < n; ++k) {
+            if (c.form.coef[k] != 0) {
+                Expr begin = op->index_list[k].as<Index>()->dom.as<Dom>()->begin;
+                init = Binary::make(t, BinaryOpType::Add, init,
+                    Binary::make(t, BinaryOpType::Mul, IntImm::make(t, c.form.coef[k]), begin));
+            }
+        }
+        Expr value, quot, rem;
+        for (size_t k = 0; k < n; ++k) {
+            int64_t step = c.form.coef[k];
+            if (step == 0) {
+                continue;
+            }
+            std::string suffix = std::to_string(id) + "_" + loops[k];
+            if (c.divisor == 0) {
+                Expr local = make_local(t, "iv" + suffix);
+                before[k].push_back(Move::make(local, value.defined() ? value : simplifier.simplify(init),
+                    MoveType::MemToLocal));
+                after[k].push_back(Move::make(local, IntImm::make(t, step), MoveType::LocalToLocal));
+                value = local;
+                continue;
+            }
+            Expr divisor = IntImm::make(t, c.divisor);
+            Expr local_rem = make_local(t, "mod" + suffix);
+            before[k].push_back(Move::make(local_rem, rem.defined() ? rem
+                : simplifier.simplify(Binary::make(t, BinaryOpType::Mod, init, divisor)), MoveType::MemToLocal));
+            Expr local_quot;
+            if (c.quotient) {
+                local_quot = make_local(t, "div" + suffix);
+                before[k].push_back(Move::make(local_quot, quot.defined() ? quot
+                    : simplifier.simplify(Binary::make(t, BinaryOpType::Div, init, divisor)), MoveType::MemToLocal));
+                if (step / c.divisor != 0) {
+                    after[k].push_back(Move::make(local_quot, IntImm::make(t, step / c.divisor),
+                        MoveType::LocalToLocal));
+                }
+            }
+            if (step % c.divisor != 0) {
+                after[k].push_back(Move::make(local_rem, IntImm::make(t, step % c.divisor), MoveType::LocalToLocal));
+                std::vector<Stmt> carry = {Move::make(local_rem, IntImm::make(t, -c.divisor), MoveType::LocalToLocal)};
+                if (c.quotient) {
+                    carry.push_back(Move::make(local_quot, IntImm::make(t, 1), MoveType::LocalToLocal));
+                }
+                after[k].push_back(If::make(Compare::make(t, CompareOpType::GE, local_rem, divisor),
+                    LoopNest::make({}, carry)));
+            }
+            rem = local_rem;
+            quot = local_quot;
+        }
+        c.value = value;
+        c.quot = quot;
+        c.rem = rem;
+    }
+
+    ReplaceCandidates replace(candidates);
+    std::vector<Stmt> body;
+    for (auto &stmt : op->body_list) {
+        body.push_back(replace.mutate(stmt));
+    }
+    body.insert(body.end(), after[n - 1].begin(), after[n - 1].end());
+    // loops with nothing between them stay in one nest
+    std::vector<Expr> nest = {op->index_list[n - 1]};
+    for (size_t k = n - 1; k > 0; --k) {
+        if (before[k].empty() && after[k - 1].empty()) {
+            nest.insert(nest.begin(), op->index_list[k - 1]);
+            continue;
+        }
+        std::vector<Stmt> outer = before[k];
+        outer.push_back(LoopNest::make(nest, body));
+        outer.insert(outer.end(), after[k - 1].begin(), after[k - 1].end());
+        body = outer;
+        nest = {op->index_list[k - 1]};
+    }
+    Stmt result = LoopNest::make(nest, body);
+    if (before[0].empty()) {
+        return result;
+    }
+    std::vector<Stmt> top = before[0];
+    top.push_back(result);
+    return LoopNest::make({}, top);
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
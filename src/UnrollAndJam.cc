@@ -0,0 +1,385 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include <map>
+#include <vector>
+
+#include "UnrollAndJam.h"
+#include "AffineAccess.h"
+#include "Dependence.h"
+#include "IREquality.h"
+#include "IRUtil.h"
+#include "IRVisitor.h"
+#include "Simplifier.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+/**
+ * the destination and the value accumulated into it, undefined when the
+ * body is not one accumulation
+ */ 
+std::pair<Expr, Expr> accumulation(Ref<const LoopNest> nest) {
+    if (nest->body_list.size() != 1) {
+        return {};
+    }
+    auto move = nest->body_list[0].as<Move>();
+    if (move != nullptr && move->move_type == MoveType::MemToMem) {
+        return {move->dst, move->src};
+    }
+    auto reduce = nest->body_list[0].as<Reduce>();
+    if (reduce != nullptr && reduce->combiner == BinaryOpType::Add) {
+        return {reduce->dst, reduce->value};
+    }
+    return {};
+}
+
+
+const Dom *dom_of(Ref<const LoopNest> nest, size_t l) {
+    return nest->index_list[l].as<Index>()->dom.as<Dom>().get();
+}
+
+
+int64_t constant(const Expr &e) {
+    auto imm = e.as<IntImm>();
+    return imm != nullptr ? imm->value() : -1;
+}
+
+
+Expr add(const Expr &a, int64_t c) {
+    return c == 0 ? a : Binary::make(a->type(), BinaryOpType::Add, a, IntImm::make(a->type(), c));
+}
+
+
+/**
+ * the nest with loop l running over [begin, begin + extent)
+ */ 
+Ref<const LoopNest> with_range(Ref<const LoopNest> nest, size_t l, int64_t begin, int64_t extent) {
+    auto index = nest->index_list[l].as<Index>();
+    Type t = index->dom->type();
+    Expr dom = Dom::make(t, IntImm::make(t, begin), IntImm::make(t, extent));
+    Expr loop = Index::make(index->type(), index->name, dom, index->index_type);
+    Substitute subst;
+    subst.values[index->name] = loop;
+    std::vector<Expr> loops = nest->index_list;
+    loops[l] = loop;
+    std::vector<Stmt> body;
+    for (auto &s : nest->body_list) {
+        body.push_back(subst.mutate(s));
+    }
+    return LoopNest::make(loops, body).as<LoopNest>();
+}
+
+
+/**
+ * a nest of the loops with more than one iteration, the body uses the
+ * only value of the others
+ */ 
+Stmt make_nest(const std::vector<Expr> &loops, const std::vector<Stmt> &body) {
+    std::vector<Expr> kept;
+    Substitute subst;
+    for (auto &loop : loops) {
+        auto index = loop.as<Index>();
+        auto dom = index->dom.as<Dom>();
+        if (constant(dom->extent) == 1) {
+            subst.values[index->name] = dom->begin;
+        } else {
+            kept.push_back(loop);
+        }
+    }
+    if (kept.size() == loops.size()) {
+        return LoopNest::make(loops, body);
+    }
+    std::vector<Stmt> new_body;
+    for (auto &s : body) {
+        new_body.push_back(subst.mutate(s));
+    }
+    return LoopNest::make(kept, new_body);
+}
+
+}  // anonymous namespace
+
+
+int UnrollAndJam::host_registers() {
+#if defined(__AVX512F__) || defined(__aarch64__) || defined(__powerpc64__)
+    return 32;
+#else
+    return 16;
+#endif
+}
+
+
+Group UnrollAndJam::visit(Ref<const Kernel> op) {
+    NameCollector names;
+    Group(op).visit_group(&names);
+    taken.insert(names.names.begin(), names.names.end());
+    return IRMutator::visit(op);
+}
+
+
+Expr UnrollAndJam::make_local(Type t, const std::string &base) {
+    std::string name = base;
+    for (int n = 1; taken.count(name); ++n) {
+        name = base + std::to_string(n);
+    }
+    taken.insert(name);
+    return Var::make(t, name, {}, {1});
+}
+
+
+bool UnrollAndJam::choose(Ref<const LoopNest> nest, Tile &tile) const {
+    size_t n = nest->index_list.size();
+    auto acc = accumulation(nest);
+    std::vector<StmtAccesses> stmts = analyze_accesses(Stmt(nest));
+    if (!acc.first.defined() || acc.first.as<Var>() == nullptr || stmts.size() != 1) {
+        return false;
+    }
+    const StmtAccesses &stmt = stmts[0];
+    const std::string &dst = stmt.accesses[0].name();
+    for (auto &access : stmt.accesses) {
+        if (!access.affine() || (!access.is_write && access.name() == dst)) {
+            return false;
+        }
+    }
+    // loop bounds only of constants, so loops can move and be split freely
+    for (size_t l = 0; l < n; ++l) {
+        NameCollector used;
+        nest->index_list[l].as<Index>()->dom.visit_expr(&used);
+        if (!used.names.empty()) {
+            return false;
+        }
+    }
+
+    // the innermost loop the destination does not depend on and a source does
+    size_t r = n;
+    for (size_t l = n; l-- > 0 && r == n;) {
+        if (!stmt.accesses[0].invariant(l)) {
+            continue;
+        }
+        for (size_t a = 1; a < stmt.accesses.size(); ++a) {
+            if (!stmt.accesses[a].invariant(l)) {
+                r = l;
+            }
+        }
+    }
+    if (r == n || stmt.loops[r].extent <= 0) {
+        return false;
+    }
+    std::vector<size_t> perm;
+    for (size_t l = 0; l < n; ++l) {
+        if (l != r) {
+            perm.push_back(l);
+        }
+    }
+    perm.push_back(r);
+    if (!is_permutation_legal(analyze_dependences(stmts), perm)) {
+        return false;
+    }
+
+    // loads per r step of the tile, counting each element once
+    auto loads = [&](size_t m, size_t nn, int64_t mr, int64_t nr) {
+        int64_t count = 0;
+        for (size_t a = 1; a < stmt.accesses.size(); ++a) {
+            const Access &access = stmt.accesses[a];
+            count += (access.invariant(m) ? 1 : mr) * (nn == m || access.invariant(nn) ? 1 : nr);
+        }
+        return count;
+    };
+    // the two innermost loops of the destination, outer ones would undo a cache tiling
+    std::vector<size_t> candidates;
+    for (size_t l = n; l-- > 0 && candidates.size() < 2;) {
+        if (!stmt.accesses[0].invariant(l) && stmt.loops[l].extent > 0) {
+            candidates.insert(candidates.begin(), l);
+        }
+    }
+    double best = 0;
+    bool found = false;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        for (size_t j = i; j < candidates.size(); ++j) {
+            size_t m = candidates[i], nn = candidates[j];
+            int64_t extent_m = stmt.loops[m].extent;
+            int64_t extent_n = nn == m ? 1 : stmt.loops[nn].extent;
+            // an iteration left to the remainder nests loads every access and updates
+            // the destination in memory
+            int64_t untiled = loads(m, nn, 1, 1) + 1;
+            for (int64_t mr = 1; mr <= extent_m && mr <= registers; ++mr) {
+                for (int64_t nr = 1; nr <= extent_n && mr * nr <= registers; ++nr) {
+                    int64_t count = loads(m, nn, mr, nr);
+                    if (mr * nr < 2 || count == 0 || mr * nr + count > registers) {
+                        continue;
+                    }
+                    // updates per load over all m, n iterations of an r step
+                    int64_t tiled_m = extent_m - extent_m % mr, tiled_n = extent_n - extent_n % nr;
+                    int64_t rest = extent_m * extent_n - tiled_m * tiled_n;
+                    double total = static_cast<double>(tiled_m / mr * (tiled_n / nr) * count + rest * untiled);
+                    double updates = static_cast<double>(extent_m * extent_n) / total;
+                    if (!found || updates > best
+                        || (updates == best && mr * nr > tile.mr * tile.nr)) {
+                        tile = Tile{m, nn, r, mr, nr};
+                        best = updates;
+                        found = true;
+                    }
+                }
+            }
+        }
+    }
+    return found;
+}
+
+
+Stmt UnrollAndJam::visit(Ref<const LoopNest> op) {
+    auto nest = flatten(op);
+    LoopFinder inner;
+    for (auto &body : nest->body_list) {
+        body.visit_stmt(&inner);
+    }
+    if (inner.found) {
+        return IRMutator::visit(op);
+    }
+    Tile tile;
+    if (!choose(nest, tile)) {
+        return op;
+    }
+    return Simplifier().simplify(lower(nest, tile));
+}
+
+
+Stmt UnrollAndJam::lower(Ref<const LoopNest> nest, const Tile &tile) {
+    // iterations past a multiple of the tile run in the original nest
+    std::vector<std::pair<size_t, int64_t> > unrolled = {{tile.m, tile.mr}, {tile.n, tile.nr}};
+    for (auto &u : unrolled) {
+        const Dom *dom = dom_of(nest, u.first);
+        int64_t begin = constant(dom->begin), extent = constant(dom->extent);
+        int64_t tail = extent % u.second;
+        if (tail != 0) {
+            Stmt main = lower(with_range(nest, u.first, begin, extent - tail), tile);
+            auto rest_nest = with_range(nest, u.first, begin + extent - tail, tail);
+            Stmt rest = make_nest(rest_nest->index_list, rest_nest->body_list);
+            return LoopNest::make({}, {main, rest});
+        }
+    }
+    return jam(nest, tile);
+}
+
+
+Stmt UnrollAndJam::jam(Ref<const LoopNest> nest, const Tile &tile) {
+    auto acc = accumulation(nest);
+    size_t n = nest->index_list.size();
+    std::vector<std::string> names;
+    for (auto &loop : nest->index_list) {
+        names.push_back(loop.as<Index>()->name);
+    }
+    int64_t extent_r = constant(dom_of(nest, tile.r)->extent);
+    int64_t step = 1;
+    while (step * 2 <= max_step && extent_r % (step * 2) == 0) {
+        step *= 2;
+    }
+
+    // the loops over tiles and the steps of r
+    auto outer = [&](size_t l, int64_t factor) {
+        auto index = nest->index_list[l].as<Index>();
+        Type t = index->dom->type();
+        Expr dom = Dom::make(t, IntImm::make(t, 0), IntImm::make(t, constant(dom_of(nest, l)->extent) / factor));
+        return Index::make(index->type(), factor == 1 ? index->name : index->name + "_o", dom, index->index_type);
+    };
+    // the original value of loop l in copy c of an outer loop
+    auto value = [&](size_t l, const Expr &loop, int64_t factor, int64_t c) {
+        Expr scaled = factor == 1 ? loop
+            : Binary::make(loop->type(), BinaryOpType::Mul, loop, IntImm::make(loop->type(), factor));
+        return add(add(scaled, c), constant(dom_of(nest, l)->begin));
+    };
+    std::vector<Expr> loops;
+    for (size_t l = 0; l < n; ++l) {
+        if (l == tile.m) {
+            loops.push_back(outer(l, tile.mr));
+        } else if (l == tile.n) {
+            loops.push_back(outer(l, tile.nr));
+        } else if (l != tile.r) {
+            loops.push_back(nest->index_list[l]);
+        }
+    }
+    Expr m_loop = loops[tile.m - (tile.m > tile.r)];
+    Expr n_loop = loops[tile.n - (tile.n > tile.r)];
+    Expr r_loop = outer(tile.r, step);
+
+    Type t = acc.first->type();
+    std::string dst_name = acc.first.as<Var>()->name;
+    std::vector<Stmt> before, body, after;
+    std::vector<std::vector<Expr> > locals(tile.mr, std::vector<Expr>(tile.nr));
+    for (int64_t a = 0; a < tile.mr; ++a) {
+        for (int64_t b = 0; b < tile.nr; ++b) {
+            Substitute subst;
+            subst.values[names[tile.m]] = value(tile.m, m_loop, tile.mr, a);
+            if (tile.n != tile.m) {
+                subst.values[names[tile.n]] = value(tile.n, n_loop, tile.nr, b);
+            }
+            Expr dst = subst.mutate(acc.first);
+            locals[a][b] = make_local(t, dst_name + "_acc" + std::to_string(a) + "_" + std::to_string(b));
+            before.push_back(Move::make(locals[a][b], dst, MoveType::MemToLocal));
+            after.push_back(Move::make(dst, locals[a][b], MoveType::LocalToMem));
+        }
+    }
+    for (int64_t u = 0; u < step; ++u) {
+        ReplaceLoads replace;
+        std::vector<Stmt> updates;
+        for (int64_t a = 0; a < tile.mr; ++a) {
+            for (int64_t b = 0; b < tile.nr; ++b) {
+                Substitute subst;
+                subst.values[names[tile.m]] = value(tile.m, m_loop, tile.mr, a);
+                if (tile.n != tile.m) {
+                    subst.values[names[tile.n]] = value(tile.n, n_loop, tile.nr, b);
+                }
+                subst.values[names[tile.r]] = value(tile.r, r_loop, step, u);
+                Expr src = subst.mutate(acc.second);
+                LoadCollector loads;
+                src.visit_expr(&loads);
+                for (auto &load : loads.loads) {
+                    bool seen = false;
+                    for (auto &r : replace.replacements) {
+                        seen = seen || deep_equal(load, r.first);
+                    }
+                    if (!seen) {
+                        Expr reg = make_local(load->type(), load.as<Var>()->name + "_reg");
+                        replace.replacements.emplace_back(load, reg);
+                        body.push_back(Move::make(reg, load, MoveType::MemToLocal));
+                    }
+                }
+                updates.push_back(Move::make(locals[a][b], src, MoveType::LocalToLocal));
+            }
+        }
+        for (auto &update : updates) {
+            body.push_back(replace.mutate(update));
+        }
+    }
+    before.push_back(make_nest({r_loop}, body));
+    before.insert(before.end(), after.begin(), after.end());
+    return make_nest(loops, before);
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
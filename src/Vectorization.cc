@@ -0,0 +1,281 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Vectorization.h"
+#include "AffineAccess.h"
+#include "Dependence.h"
+#include "IRUtil.h"
+#include "IRVisitor.h"
+#include "Simplifier.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+namespace {
+
+bool uses(const Expr &e, const std::string &name) {
+    NameCollector used;
+    e.visit_expr(&used);
+    return used.names.count(name) != 0;
+}
+
+
+/**
+ * the vector form of expressions over one loop, undefined when an
+ * expression has none
+ */ 
+class Widen {
+ public:
+    Widen(const std::string &_loop, const Expr &_value, int _lanes, Type _elem) :
+        loop(_loop), value(_value), lanes(static_cast<uint16_t>(_lanes)), elem(_elem),
+        vec(_elem.with_lanes(static_cast<uint16_t>(_lanes))) {}
+
+    Expr operator()(const Expr &e) const {
+        if (!uses(e, loop)) {
+            return e->type() == elem ? Ramp::make(vec, e, 0, lanes) : Expr();
+        }
+        if (auto var = e.as<Var>()) {
+            return access(var);
+        }
+        if (e->type() != elem) {
+            return Expr();
+        }
+        if (auto op = e.as<Unary>()) {
+            Expr a = (*this)(op->a);
+            if (op->op_type != UnaryOpType::Neg || !a.defined()) {
+                return Expr();
+            }
+            return Unary::make(vec, op->op_type, a);
+        }
+        auto op = e.as<Binary>();
+        if (op == nullptr || op->op_type == BinaryOpType::And || op->op_type == BinaryOpType::Or
+            || (op->op_type == BinaryOpType::Mod && !elem.is_int())) {
+            return Expr();
+        }
+        Expr a = (*this)(op->a);
+        Expr b = (*this)(op->b);
+        if (!a.defined() || !b.defined()) {
+            return Expr();
+        }
+        return Binary::make(vec, op->op_type, a, b, op->bracket);
+    }
+
+    /**
+     * the vector of consecutive elements accessed by the lanes
+     */ 
+    Expr access(Ref<const Var> var) const {
+        if (var->type() != elem || var->args.empty()) {
+            return Expr();
+        }
+        std::vector<Expr> args = var->args;
+        for (size_t d = 0; d + 1 < args.size(); ++d) {
+            if (uses(args[d], loop)) {
+                return Expr();
+            }
+        }
+        AffineExpr last = affine_form(args.back(), {loop});
+        if (!last.affine || last.coef[0] != 1) {
+            return Expr();
+        }
+        Substitute subst;
+        subst.values[loop] = value;
+        Expr base = Simplifier().simplify(subst.mutate(args.back()));
+        args.back() = Ramp::make(base->type().with_lanes(lanes), base, 1, lanes);
+        return Var::make(vec, var->name, args, var->shape);
+    }
+
+ private:
+    std::string loop;
+    Expr value;
+    uint16_t lanes;
+    Type elem;
+    Type vec;
+};
+
+
+/**
+ * the destination, the value and whether it accumulates, undefined when
+ * the statement is not a store to memory
+ */ 
+struct Store {
+    Expr dst, src;
+    bool accumulate = false;
+
+    explicit Store(const Stmt &stmt) {
+        auto move = stmt.as<Move>();
+        auto reduce = stmt.as<Reduce>();
+        if (move != nullptr && (move->move_type == MoveType::MemToMem || move->move_type == MoveType::LocalToMem)) {
+            dst = move->dst;
+            src = move->src;
+            accumulate = move->move_type == MoveType::MemToMem;
+        } else if (reduce != nullptr && reduce->combiner == BinaryOpType::Add) {
+            dst = reduce->dst;
+            src = reduce->value;
+            accumulate = true;
+        }
+        if (dst.defined() && dst.as<Var>() == nullptr) {
+            dst = Expr();
+        }
+    }
+
+    Stmt widen(const Widen &widen) const {
+        Expr new_dst = widen.access(dst.as<Var>());
+        Expr new_src = widen(src);
+        if (!new_dst.defined() || !new_src.defined()) {
+            return Stmt();
+        }
+        return Move::make(new_dst, new_src, accumulate ? MoveType::MemToMem : MoveType::LocalToMem);
+    }
+};
+
+}  // anonymous namespace
+
+
+int Vectorization::host_vector_bytes() {
+#if defined(__AVX512F__)
+    return 64;
+#elif defined(__AVX__)
+    return 32;
+#else
+    return 16;
+#endif
+}
+
+
+int Vectorization::choose(Ref<const LoopNest> nest, const std::vector<Expr> &enclosing) const {
+    size_t n = nest->index_list.size();
+    if (n == 0 || nest->body_list.empty()) {
+        return 0;
+    }
+    auto index = nest->index_list.back().as<Index>();
+    auto dom = index->dom.as<Dom>();
+    auto begin = dom->begin.as<IntImm>();
+    auto extent = dom->extent.as<IntImm>();
+    Expr dst = Store(nest->body_list[0]).dst;
+    if (begin == nullptr || extent == nullptr || !dst.defined()) {
+        return 0;
+    }
+    Type elem = dst->type();
+    int lanes = vector_bytes * 8 / elem.bits;
+    if (lanes < 2 || extent->value() < lanes || elem.lanes() != 1) {
+        return 0;
+    }
+    Widen widen(index->name, nest->index_list.back(), lanes, elem);
+    for (auto &stmt : nest->body_list) {
+        Store store(stmt);
+        if (!store.dst.defined() || !store.widen(widen).defined()) {
+            return 0;
+        }
+    }
+    // subscripts over the enclosing loops are affine too
+    Stmt context = enclosing.empty() ? Stmt(nest) : LoopNest::make(enclosing, {nest});
+    std::vector<StmtAccesses> stmts = analyze_accesses(context);
+    std::vector<Dependence> deps = analyze_dependences(stmts);
+    for (size_t s = 0; s < stmts.size(); ++s) {
+        if (!is_parallel(deps, stmts, s, enclosing.size() + n - 1)) {
+            return 0;
+        }
+    }
+    return lanes;
+}
+
+
+Stmt Vectorization::visit(Ref<const LoopNest> op) {
+    auto nest = flatten(op);
+    LoopFinder inner;
+    for (auto &body : nest->body_list) {
+        body.visit_stmt(&inner);
+    }
+    if (inner.found) {
+        size_t depth = enclosing.size();
+        enclosing.insert(enclosing.end(), op->index_list.begin(), op->index_list.end());
+        Stmt result = IRMutator::visit(op);
+        enclosing.resize(depth);
+        return result;
+    }
+    int lanes = choose(nest, enclosing);
+    auto last = nest->index_list.back().as<Index>();
+    if (lanes == 0 && last->index_type == IndexType::Vectorized) {
+        // the printer would still claim the loop carries no dependence
+        Expr loop = Index::make(last->type(), last->name, last->dom, IndexType::Spatial);
+        Substitute subst;
+        subst.values[last->name] = loop;
+        std::vector<Expr> loops = nest->index_list;
+        loops.back() = loop;
+        std::vector<Stmt> body;
+        for (auto &stmt : nest->body_list) {
+            body.push_back(subst.mutate(stmt));
+        }
+        return LoopNest::make(loops, body);
+    }
+    if (lanes == 0) {
+        return op;
+    }
+
+    std::vector<Expr> outer = nest->index_list;
+    auto index = outer.back().as<Index>();
+    outer.pop_back();
+    Type t = index->type();
+    int64_t begin = index->dom.as<Dom>()->begin.as<IntImm>()->value();
+    int64_t extent = index->dom.as<Dom>()->extent.as<IntImm>()->value();
+    int64_t steps = extent / lanes;
+    IndexType index_type = index->index_type == IndexType::Vectorized ? IndexType::Spatial : index->index_type;
+    Expr vector_loop = Index::make(t, index->name + "_v", Dom::make(t, IntImm::make(t, 0), IntImm::make(t, steps)),
+        index_type);
+    Expr value = Binary::make(t, BinaryOpType::Mul, vector_loop, IntImm::make(t, lanes));
+    if (begin != 0) {
+        value = Binary::make(t, BinaryOpType::Add, value, IntImm::make(t, begin));
+    }
+
+    Widen widen(index->name, value, lanes, Store(nest->body_list[0]).dst->type());
+    std::vector<Stmt> body;
+    for (auto &stmt : nest->body_list) {
+        body.push_back(Store(stmt).widen(widen));
+    }
+    if (extent % lanes == 0) {
+        outer.push_back(vector_loop);
+        return LoopNest::make(outer, body);
+    }
+
+    // the last iterations stay scalar
+    Expr tail_loop = Index::make(t, index->name, Dom::make(t, IntImm::make(t, begin + steps * lanes),
+        IntImm::make(t, extent - steps * lanes)), index_type);
+    Substitute subst;
+    subst.values[index->name] = tail_loop;
+    std::vector<Stmt> tail;
+    for (auto &stmt : nest->body_list) {
+        tail.push_back(subst.mutate(stmt));
+    }
+    return LoopNest::make(outer, {LoopNest::make({vector_loop}, body), LoopNest::make({tail_loop}, tail)});
+}
+
+}  // namespace Internal
+
+}  // namespace Boost
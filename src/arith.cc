@@ -0,0 +1,387 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2020 Size Zheng
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <algorithm>
+
+#include "arith.h"
+#include "IR.h"
+
+
+namespace Boost {
+
+namespace Arith {
+
+using namespace Internal;
+
+namespace {
+
+const int64_t neg_inf = Interval::neg_inf;
+const int64_t pos_inf = Interval::pos_inf;
+
+
+bool is_inf(int64_t a) {
+    return a == neg_inf || a == pos_inf;
+}
+
+
+int64_t sat_add(int64_t a, int64_t b) {
+    if (a == neg_inf || b == neg_inf) {
+        return neg_inf;
+    }
+    if (a == pos_inf || b == pos_inf) {
+        return pos_inf;
+    }
+    if (b > 0 && a > pos_inf - b) {
+        return pos_inf;
+    }
+    if (b < 0 && a < neg_inf - b) {
+        return neg_inf;
+    }
+    return a + b;
+}
+
+
+int64_t sat_neg(int64_t a) {
+    if (a == neg_inf) {
+        return pos_inf;
+    }
+    if (a == pos_inf) {
+        return neg_inf;
+    }
+    return -a;
+}
+
+
+/**
+ * a * b into out, false on overflow
+ */ 
+bool checked_mul(int64_t a, int64_t b, int64_t &out) {
+    if (a == 0 || b == 0) {
+        out = 0;
+        return true;
+    }
+    if (a > 0 ? (b > 0 ? a > pos_inf / b : b < neg_inf / a)
+              : (b > 0 ? a < neg_inf / b : b < pos_inf / a)) {
+        return false;
+    }
+    out = a * b;
+    return true;
+}
+
+
+int64_t sat_mul(int64_t a, int64_t b) {
+    int64_t out;
+    if (!is_inf(a) && !is_inf(b) && checked_mul(a, b, out)) {
+        return out;
+    }
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    return (a > 0) == (b > 0) ? pos_inf : neg_inf;
+}
+
+
+int64_t sat_div(int64_t a, int64_t b) {
+    if (is_inf(a)) {
+        return (a > 0) == (b > 0) ? pos_inf : neg_inf;
+    }
+    return a / b;
+}
+
+
+int64_t sat_abs(int64_t a) {
+    return a < 0 ? sat_neg(a) : a;
+}
+
+
+int64_t gcd(int64_t a, int64_t b) {
+    a = a < 0 ? -a : a;
+    b = b < 0 ? -b : b;
+    while (b != 0) {
+        int64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+
+/**
+ * a mod m in [0, m)
+ */ 
+int64_t mod_pos(int64_t a, int64_t m) {
+    int64_t r = a % m;
+    return r < 0 ? r + m : r;
+}
+
+
+int64_t min4(int64_t a, int64_t b, int64_t c, int64_t d) {
+    return std::min(std::min(a, b), std::min(c, d));
+}
+
+
+int64_t max4(int64_t a, int64_t b, int64_t c, int64_t d) {
+    return std::max(std::max(a, b), std::max(c, d));
+}
+
+}  // anonymous namespace
+
+
+Interval::Interval(int64_t _min, int64_t _max, int64_t _stride, int64_t _remainder) :
+    min(_min), max(_max), stride(_stride < 0 ? -_stride : _stride), remainder(_remainder) {
+    if (min == max && !is_inf(min)) {
+        stride = 0;
+        remainder = min;
+        return;
+    }
+    if (stride == 0) {
+        // only a single value can have stride 0
+        stride = 1;
+    }
+    remainder = mod_pos(remainder, stride);
+    if (stride > 1) {
+        // tighten the ends to the lattice
+        if (!is_inf(min)) {
+            min = sat_add(min, mod_pos(remainder - mod_pos(min, stride), stride));
+        }
+        if (!is_inf(max)) {
+            max = max - mod_pos(mod_pos(max, stride) - remainder, stride);
+        }
+        if (min == max) {
+            stride = 0;
+            remainder = min;
+        }
+    }
+}
+
+
+bool Interval::contains(int64_t value) const {
+    if (value < min || value > max) {
+        return false;
+    }
+    return stride == 0 ? value == remainder : mod_pos(value, stride) == remainder;
+}
+
+
+Interval Interval::union_of(const Interval &a, const Interval &b) {
+    if (a.is_empty()) {
+        return b;
+    }
+    if (b.is_empty()) {
+        return a;
+    }
+    int64_t stride = gcd(gcd(a.stride, b.stride), a.remainder - b.remainder);
+    return Interval(std::min(a.min, b.min), std::max(a.max, b.max), stride, a.remainder);
+}
+
+
+Interval Interval::intersect(const Interval &a, const Interval &b) {
+    int64_t lo = std::max(a.min, b.min);
+    int64_t hi = std::min(a.max, b.max);
+    if (a.stride == 0 || b.stride == 0) {
+        const Interval &p = a.stride == 0 ? a : b;
+        const Interval &other = a.stride == 0 ? b : a;
+        return other.contains(p.min) ? p : Interval(1, 0);
+    }
+    // keep the finer lattice when one refines the other, else fall back to dense
+    if (a.stride % b.stride == 0 && mod_pos(a.remainder, b.stride) == b.remainder) {
+        return Interval(lo, hi, a.stride, a.remainder);
+    }
+    if (b.stride % a.stride == 0 && mod_pos(b.remainder, a.stride) == a.remainder) {
+        return Interval(lo, hi, b.stride, b.remainder);
+    }
+    return Interval(lo, hi);
+}
+
+
+Interval operator-(const Interval &a) {
+    return Interval(sat_neg(a.max), sat_neg(a.min), a.stride, sat_neg(a.remainder));
+}
+
+
+Interval operator+(const Interval &a, const Interval &b) {
+    int64_t stride = gcd(a.stride, b.stride);
+    int64_t remainder = stride == 0 ? sat_add(a.remainder, b.remainder)
+        : mod_pos(a.remainder, stride) + mod_pos(b.remainder, stride);
+    return Interval(sat_add(a.min, b.min), sat_add(a.max, b.max), stride, remainder);
+}
+
+
+Interval operator-(const Interval &a, const Interval &b) {
+    return a + (-b);
+}
+
+
+Interval operator*(const Interval &a, const Interval &b) {
+    int64_t lo = min4(sat_mul(a.min, b.min), sat_mul(a.min, b.max), sat_mul(a.max, b.min), sat_mul(a.max, b.max));
+    int64_t hi = max4(sat_mul(a.min, b.min), sat_mul(a.min, b.max), sat_mul(a.max, b.min), sat_mul(a.max, b.max));
+    // x = sa * k + ra, y = sb * l + rb: x * y = ra * rb mod gcd(sa * sb, sa * rb, sb * ra)
+    int64_t s1, s2, s3, remainder;
+    if (checked_mul(a.stride, b.stride, s1) && checked_mul(a.stride, b.remainder, s2)
+        && checked_mul(b.stride, a.remainder, s3) && checked_mul(a.remainder, b.remainder, remainder)) {
+        return Interval(lo, hi, gcd(gcd(s1, s2), s3), remainder);
+    }
+    return Interval(lo, hi);
+}
+
+
+Interval operator/(const Interval &a, const Interval &b) {
+    if (b.min <= 0 && b.max >= 0) {
+        return Interval::everything();
+    }
+    int64_t lo = min4(sat_div(a.min, b.min), sat_div(a.min, b.max), sat_div(a.max, b.min), sat_div(a.max, b.max));
+    int64_t hi = max4(sat_div(a.min, b.min), sat_div(a.min, b.max), sat_div(a.max, b.min), sat_div(a.max, b.max));
+    if (b.is_point() && b.min > 0 && a.min >= 0 && a.stride > 0 && a.stride % b.min == 0) {
+        // (s * k + r) / c = (s / c) * k + r / c when c divides s and r < s
+        return Interval(lo, hi, a.stride / b.min, a.remainder / b.min);
+    }
+    return Interval(lo, hi);
+}
+
+
+Interval operator%(const Interval &a, const Interval &b) {
+    if (b.min <= 0 && b.max >= 0) {
+        return Interval::everything();
+    }
+    int64_t m = std::max(sat_abs(b.min), sat_abs(b.max));
+    if (is_inf(m)) {
+        return a.min >= 0 ? Interval(0, a.max) : Interval::everything();
+    }
+    // the sign follows the dividend
+    int64_t lo = a.min >= 0 ? 0 : -(m - 1);
+    int64_t hi = a.max <= 0 ? 0 : m - 1;
+    if (a.min >= 0) {
+        hi = std::min(hi, a.max);
+    } else if (a.max <= 0) {
+        lo = std::max(lo, a.min);
+    }
+    if (!b.is_point()) {
+        return Interval(lo, hi);
+    }
+    if (a.min >= 0 && a.max != pos_inf && a.max - a.min < m && a.min % m <= a.max % m) {
+        // a does not wrap around
+        lo = a.min % m;
+        hi = a.max % m;
+    }
+    // x % m = x (mod m), so the lattice of x survives modulo gcd(stride, m)
+    int64_t stride = gcd(a.stride, m);
+    return Interval(lo, hi, stride, stride == 0 ? a.remainder : mod_pos(a.remainder, stride));
+}
+
+
+std::ostream &operator<<(std::ostream &out, const Interval &interval) {
+    out << "[";
+    if (interval.min == neg_inf) {
+        out << "-inf";
+    } else {
+        out << interval.min;
+    }
+    out << ", ";
+    if (interval.max == pos_inf) {
+        out << "+inf";
+    } else {
+        out << interval.max;
+    }
+    out << "]";
+    if (interval.stride > 1) {
+        out << " = " << interval.remainder << " mod " << interval.stride;
+    }
+    return out;
+}
+
+
+Interval Bounds::operator()(const Expr &expr) const {
+    if (!expr.defined()) {
+        return Interval::everything();
+    }
+    const Type &t = expr.type();
+    switch (expr->node_type()) {
+        case IRNodeType::IntImm:
+            return Interval::point(expr.as<IntImm>()->value());
+        case IRNodeType::UIntImm: {
+            uint64_t value = expr.as<UIntImm>()->value();
+            return value <= static_cast<uint64_t>(pos_inf) ? Interval::point(static_cast<int64_t>(value))
+                : Interval::everything();
+        }
+        case IRNodeType::Index: {
+            auto op = expr.as<Index>();
+            auto it = bounds.find(op->name);
+            if (it != bounds.end()) {
+                return it->second;
+            }
+            return (*this)(op->dom);
+        }
+        case IRNodeType::Dom: {
+            auto op = expr.as<Dom>();
+            Interval extent = (*this)(op->extent);
+            if (extent.max == pos_inf) {
+                return Interval((*this)(op->begin).min, pos_inf);
+            }
+            return (*this)(op->begin) + Interval(0, extent.max - 1);
+        }
+        case IRNodeType::Unary: {
+            auto op = expr.as<Unary>();
+            if (op->op_type == UnaryOpType::Not) {
+                return Interval(0, 1);
+            }
+            return t.is_float() ? Interval::everything() : -(*this)(op->a);
+        }
+        case IRNodeType::Binary: {
+            auto op = expr.as<Binary>();
+            if (op->op_type == BinaryOpType::And || op->op_type == BinaryOpType::Or) {
+                return Interval(0, 1);
+            }
+            if (t.is_float()) {
+                return Interval::everything();
+            }
+            Interval a = (*this)(op->a);
+            Interval b = (*this)(op->b);
+            switch (op->op_type) {
+                case BinaryOpType::Add: return a + b;
+                case BinaryOpType::Sub: return a - b;
+                case BinaryOpType::Mul: return a * b;
+                case BinaryOpType::Div: return a / b;
+                case BinaryOpType::Mod: return a % b;
+                default: return Interval::everything();
+            }
+        }
+        case IRNodeType::Compare:
+            return Interval(0, 1);
+        case IRNodeType::Select: {
+            auto op = expr.as<Select>();
+            return Interval::union_of((*this)(op->true_value), (*this)(op->false_value));
+        }
+        case IRNodeType::Cast: {
+            auto op = expr.as<Cast>();
+            return op->new_type.is_float() || op->val.type().is_float() ? Interval::everything()
+                : (*this)(op->val);
+        }
+        default:
+            return Interval::everything();
+    }
+}
+
+}  // namespace Arith
+
+}  // namespace Boost
@@ -0,0 +1,72 @@
+#include <string>
+#include <iostream>
+
+#include "IR.h"
+#include "AffineAccess.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+int main() {
+    const int M = 64;
+    const int N = 32;
+    const int K = 16;
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, M), IndexType::Spatial);
+    Expr j = Index::make(index_type, "j", Dom::make(index_type, 0, N), IndexType::Spatial);
+    Expr k = Index::make(index_type, "k", Dom::make(index_type, 0, K), IndexType::Reduce);
+
+    // C[i, j] += A[i, k] * B[k, j] in i, j, k order
+    Expr expr_A = Var::make(data_type, "A", {i, k}, {M, K});
+    Expr expr_B = Var::make(data_type, "B", {k, j}, {K, N});
+    Expr expr_C = Var::make(data_type, "C", {i, j}, {M, N});
+    Stmt gemm = Move::make(expr_C,
+        Binary::make(data_type, BinaryOpType::Mul, expr_A, expr_B), MoveType::MemToMem);
+
+    // D[i, j] = E[2 * i + 1, j / 2]
+    Expr expr_E = Var::make(data_type, "E", {
+        Binary::make(index_type, BinaryOpType::Add, Binary::make(index_type, BinaryOpType::Mul, 2, i), 1),
+        Binary::make(index_type, BinaryOpType::Div, j, 2)}, {2 * M + 1, N});
+    Expr expr_D = Var::make(data_type, "D", {i, j}, {M, N});
+    Stmt strided = Move::make(expr_D, expr_E, MoveType::MemToMem);
+
+    Group kernel = Kernel::make("accesses", {expr_A, expr_B, expr_E}, {expr_C, expr_D},
+        {LoopNest::make({i, j, k}, {gemm}), LoopNest::make({i, j}, {strided})}, KernelType::CPU);
+
+    std::vector<StmtAccesses> stmts = analyze_accesses(kernel);
+    if (stmts.size() != 2 || stmts[0].accesses.size() != 3 || stmts[1].accesses.size() != 2) {
+        std::cout << "Wrong number of statements or accesses!\n";
+        return 1;
+    }
+
+    // gemm: C is written and unit stride in j, A unit stride in k, B in j
+    const StmtAccesses &g = stmts[0];
+    if (!g.accesses[0].is_write || g.unit_stride_loop(0) != 1 || g.unit_stride_loop(1) != 2
+        || g.unit_stride_loop(2) != 1 || g.accesses[2].stride(2) != N) {
+        std::cout << "Wrong gemm strides!\n";
+        return 1;
+    }
+    // C is invariant in k, A in j (reused every K iterations), B in i (every N * K)
+    if (g.reuse_distance(0, 2) != 1 || g.reuse_distance(1, 1) != K || g.reuse_distance(2, 0) != N * K
+        || g.reuse_distance(1, 2) != -1) {
+        std::cout << "Wrong gemm reuse distances!\n";
+        return 1;
+    }
+
+    // E[2 * i + 1, j / 2]: first row affine with coefficient 2, second row is not
+    const Access &e = stmts[1].accesses[1];
+    if (e.affine() || !e.subscripts[0].affine || e.subscripts[0].coef[0] != 2
+        || e.subscripts[0].constant != 1 || e.subscripts[1].affine || stmts[1].unit_stride_loop(1) != -1) {
+        std::cout << "Wrong strided access!\n";
+        return 1;
+    }
+
+    for (auto &stmt : stmts) {
+        stmt.dump(std::cout);
+    }
+    std::cout << "Success!\n";
+    return 0;
+}
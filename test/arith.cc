@@ -0,0 +1,71 @@
+#include <string>
+#include <iostream>
+
+#include "IR.h"
+#include "arith.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+using Boost::Arith::Bounds;
+using Boost::Arith::Interval;
+
+
+bool expect(const std::string &what, const Interval &got, const Interval &want) {
+    if (got != want) {
+        std::cout << what << ": got " << got << ", expected " << want << "\n";
+        return false;
+    }
+    return true;
+}
+
+
+int main() {
+    Type index_type = Type::int_scalar(32);
+    Expr p = Index::make(index_type, "p", Dom::make(index_type, 0, 32), IndexType::Spatial);
+    Expr r = Index::make(index_type, "r", Dom::make(index_type, 0, 3), IndexType::Reduce);
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, 64), IndexType::Spatial);
+
+    Bounds bounds;
+    bool ok = true;
+    ok &= expect("p + r", bounds(Binary::make(index_type, BinaryOpType::Add, p, r)), Interval(0, 33));
+    ok &= expect("i + 2", bounds(Binary::make(index_type, BinaryOpType::Add, i, 2)), Interval(2, 65));
+    ok &= expect("i / 16", bounds(Binary::make(index_type, BinaryOpType::Div, i, 16)), Interval(0, 3));
+    ok &= expect("i % 16", bounds(Binary::make(index_type, BinaryOpType::Mod, i, 16)), Interval(0, 15));
+    ok &= expect("p - r", bounds(Binary::make(index_type, BinaryOpType::Sub, p, r)), Interval(-2, 31));
+
+    // strides and remainders
+    Expr two_i_1 = Binary::make(index_type, BinaryOpType::Add,
+        Binary::make(index_type, BinaryOpType::Mul, i, 2), 1);
+    ok &= expect("2 * i + 1", bounds(two_i_1), Interval(1, 127, 2, 1));
+    ok &= expect("(2 * i + 1) % 2", bounds(Binary::make(index_type, BinaryOpType::Mod, two_i_1, 2)),
+        Interval::point(1));
+    Expr eight_i = Binary::make(index_type, BinaryOpType::Mul, i, 8);
+    ok &= expect("8 * i / 4", bounds(Binary::make(index_type, BinaryOpType::Div, eight_i, 4)),
+        Interval(0, 126, 2, 0));
+    ok &= expect("8 * i % 4", bounds(Binary::make(index_type, BinaryOpType::Mod, eight_i, 4)),
+        Interval::point(0));
+
+    // a narrower binding overrides the Dom, e.g. inside a split loop
+    bounds.bind("i", Interval(16, 31));
+    ok &= expect("i / 16 with i in [16, 31]",
+        bounds(Binary::make(index_type, BinaryOpType::Div, i, 16)), Interval::point(1));
+    ok &= expect("i % 16 with i in [16, 31]",
+        bounds(Binary::make(index_type, BinaryOpType::Mod, i, 16)), Interval(0, 15));
+    bounds.unbind("i");
+
+    // loads are not analysed
+    Expr load = Var::make(index_type, "A", {i}, {64});
+    ok &= expect("A[i] + 1", bounds(Binary::make(index_type, BinaryOpType::Add, load, 1)), Interval::everything());
+
+    // interval arithmetic itself
+    ok &= expect("[-7, -1] % 4", Interval(-7, -1) % Interval::point(4), Interval(-3, 0));
+    ok &= expect("[-4, 4] * [-2, 3]", Interval(-4, 4) * Interval(-2, 3), Interval(-12, 12));
+    ok &= expect("[-9, 9] / 4", Interval(-9, 9) / Interval::point(4), Interval(-2, 2));
+    ok &= expect("union", Interval::union_of(Interval::point(3), Interval::point(7)), Interval(3, 7, 4, 3));
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <string>
+#include <iostream>
+
+#include "IR.h"
+#include "IRPrinter.h"
+#include "CommonSubexpressionElimination.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+bool contains(const std::string &code, const std::string &line) {
+    if (code.find(line) == std::string::npos) {
+        std::cout << "missing \"" << line << "\" in:\n" << code;
+        return false;
+    }
+    return true;
+}
+
+
+int main() {
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    Expr p = Index::make(index_type, "p", Dom::make(index_type, 0, 7), IndexType::Spatial);
+    Expr q = Index::make(index_type, "q", Dom::make(index_type, 0, 7), IndexType::Spatial);
+    Expr r = Index::make(index_type, "r", Dom::make(index_type, 0, 3), IndexType::Reduce);
+    Expr s = Index::make(index_type, "s", Dom::make(index_type, 0, 3), IndexType::Reduce);
+    auto add = [&](Expr a, Expr b) { return Binary::make(index_type, BinaryOpType::Add, a, b); };
+    auto mul = [&](Expr a, Expr b) { return Binary::make(data_type, BinaryOpType::Mul, a, b); };
+
+    // O[p, q] += I[p + r, q + s] * W[r, s] + I[p + r, q + s] * J[q + s, p + r]:
+    // the load of I, p + r and q + s are each computed once
+    Expr expr_I = Var::make(data_type, "I", {add(p, r), add(q, s)}, {9, 9});
+    Expr expr_I2 = Var::make(data_type, "I", {add(p, r), add(q, s)}, {9, 9});
+    Expr expr_J = Var::make(data_type, "J", {add(s, q), add(p, r)}, {9, 9});
+    Expr expr_W = Var::make(data_type, "W", {r, s}, {3, 3});
+    Expr expr_O = Var::make(data_type, "O", {p, q}, {7, 7});
+    Stmt conv = Move::make(expr_O, Binary::make(data_type, BinaryOpType::Add,
+        mul(expr_I, expr_W), mul(expr_I2, expr_J)), MoveType::MemToMem);
+
+    // dA[p, q] += dB[p, q] * A[p, q] + A[p, q] * dB[p, q]: the product matches with its operands swapped
+    Expr expr_A = Var::make(data_type, "A", {p, q}, {7, 7});
+    Expr expr_dB = Var::make(data_type, "dB", {p, q}, {7, 7});
+    Expr expr_dA = Var::make(data_type, "dA", {p, q}, {7, 7});
+    Stmt grad = Move::make(expr_dA, Binary::make(data_type, BinaryOpType::Add,
+        mul(expr_dB, expr_A), mul(expr_A, expr_dB)), MoveType::MemToMem);
+
+    // nothing repeats
+    Stmt copy = LoopNest::make({p, q}, {Move::make(expr_dB, expr_A, MoveType::MemToMem)});
+
+    // E[p, q] += select(A[p, q] * dB[p, q] < 1 && A[p, q] * dB[p, q] < dB[p, q], dB[p, q] * dB[p, q], 0):
+    // the right operand of && and the values only run for some conditions, nothing is bound
+    auto less = [&](Expr a, Expr b) { return Compare::make(index_type, CompareOpType::LT, a, b); };
+    Expr product = mul(expr_A, expr_dB);
+    Expr cond = Binary::make(index_type, BinaryOpType::And,
+        less(product, FloatImm::make(data_type, 1.0)), less(product, expr_dB));
+    Expr expr_E = Var::make(data_type, "E", {p, q}, {7, 7});
+    Stmt guarded = LoopNest::make({p, q}, {Move::make(expr_E, Select::make(data_type, cond,
+        mul(expr_dB, expr_dB), FloatImm::make(data_type, 0.0)), MoveType::MemToMem)});
+
+    Group kernel = Kernel::make("cse", {expr_I, expr_J, expr_W, expr_A}, {expr_O, expr_dB, expr_dA, expr_E},
+        {LoopNest::make({p, q, r, s}, {conv}), LoopNest::make({p, q}, {grad}), copy, guarded}, KernelType::CPU);
+    CommonSubexpressionElimination cse;
+    Group result = cse.mutate(kernel);
+    std::string code = IRPrinter().print(result);
+
+    if (!contains(code, "int cse0 = p + r;") || !contains(code, "int cse1 = q + s;")
+        || !contains(code, "float cse2 = I[cse0][cse1];")
+        || !contains(code, "O[p][q] += cse2 * W[r][s] + cse2 * J[cse1][cse0];")
+        || !contains(code, "float cse3 = dB[p][q] * A[p][q];") || !contains(code, "dA[p][q] += cse3 + cse3;")) {
+        return 1;
+    }
+    if (result.as<Kernel>()->stmt_list[2].get() != copy.get()) {
+        std::cout << "a statement without repeats should be left alone!\n";
+        return 1;
+    }
+    if (result.as<Kernel>()->stmt_list[3].get() != guarded.get()) {
+        std::cout << "values that only run under a condition should not be bound:\n" << code;
+        return 1;
+    }
+
+    std::cout << code;
+    std::cout << "Success!\n";
+    return 0;
+}
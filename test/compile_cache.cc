@@ -0,0 +1,107 @@
+#include <string>
+#include <iostream>
+#include <cstdio>
+
+#include "IR.h"
+#include "IRPrinter.h"
+#include "CompileCache.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+Group build_copy(const std::string &name, int N) {
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+    size_t extent = static_cast<size_t>(N);
+
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, N), IndexType::Spatial);
+    Expr expr_A = Var::make(data_type, "A", {i}, {extent});
+    Expr expr_B = Var::make(data_type, "B", {i}, {extent});
+    Stmt loop_nest = LoopNest::make({i}, {Move::make(expr_B, expr_A, MoveType::MemToMem)});
+    return Kernel::make(name, {expr_A}, {expr_B}, {loop_nest}, KernelType::CPU);
+}
+
+
+std::string compile(CompileCache &cache, const Group &kernel) {
+    std::string code;
+    if (!cache.lookup(kernel, code)) {
+        IRPrinter printer;
+        code = printer.print(kernel);
+        cache.store(kernel, code);
+    }
+    return code;
+}
+
+
+std::string entry_path(const std::string &dir, uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.cc", static_cast<unsigned long long>(key));
+    return dir + "/" + name;
+}
+
+
+int main() {
+    // the directory is removed at the end
+    std::string dir = "compile_cache_test";
+    Group small = build_copy("copy", 16);
+    Group large = build_copy("copy", 32);
+    CompileCache cache(dir, "test");
+    CompileCache other(dir, "other");
+    // start cold even if an earlier run was interrupted
+    cache.erase(cache.key(small));
+    cache.erase(cache.key(large));
+    other.erase(other.key(small));
+
+    std::string first = compile(cache, small);
+    compile(cache, large);
+    if (cache.hits() != 0 || cache.misses() != 2) {
+        std::cout << "Cold cache: " << cache.report() << "\n";
+        return 1;
+    }
+
+    // a structurally equal kernel hits, other options do not
+    std::string second = compile(cache, build_copy("copy", 16));
+    compile(other, small);
+    if (cache.hits() != 1 || other.misses() != 1 || first != second) {
+        std::cout << "Warm cache: " << cache.report() << ", " << other.report() << "\n";
+        return 1;
+    }
+    std::cout << cache.report() << "\n";
+
+    // an entry that does not hold the kernel's IR is a miss, as on a key collision
+    write_if_changed(entry_path(dir, cache.key(large)), "stale");
+    compile(cache, large);
+    if (cache.misses() != 3) {
+        std::cout << "Stale entry hit: " << cache.report() << "\n";
+        return 1;
+    }
+
+    std::string path = dir + "/output.cc";
+    bool written = write_if_changed(path, first);
+    bool rewritten = write_if_changed(path, first);
+    if (!written || rewritten) {
+        std::cout << "write_if_changed rewrote an unchanged file!\n";
+        return 1;
+    }
+
+    // a recorded output is current until the file, the options or the entry change
+    cache.record_output(path, small);
+    bool current = cache.output_is_current(path);
+    bool other_current = other.output_is_current(path);
+    write_if_changed(path, "stub");
+    bool stub_current = cache.output_is_current(path);
+    std::remove(path.c_str());
+    cache.erase_output(path);
+    cache.erase(cache.key(small));
+    cache.erase(cache.key(large));
+    other.erase(other.key(small));
+    std::remove(dir.c_str());
+    if (!current || other_current || stub_current) {
+        std::cout << "Wrong output record: " << current << other_current << stub_current << "\n";
+        return 1;
+    }
+
+    std::cout << "Success!\n";
+    return 0;
+}
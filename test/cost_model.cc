@@ -0,0 +1,134 @@
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <vector>
+
+#include "IR.h"
+#include "AffineAccess.h"
+#include "CostModel.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+template <typename F>
+double measure_ms(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+
+void report(const std::string &name, const CostEstimate &estimate, double measured) {
+    std::cout << name << ": predicted " << estimate.time_ns / 1e6 << " ms, measured " << measured << " ms\n";
+}
+
+
+int main() {
+    CostModel model;
+    for (auto &cache : model.cache_levels()) {
+        std::cout << "L" << cache.level << " " << cache.size << " bytes, line " << cache.line << "\n";
+    }
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    // gemm with the shapes of test/gemm.cc
+    const int M = 1024;
+    const int N = 512;
+    const int K = 256;
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, M), IndexType::Spatial);
+    Expr j = Index::make(index_type, "j", Dom::make(index_type, 0, N), IndexType::Spatial);
+    Expr k = Index::make(index_type, "k", Dom::make(index_type, 0, K), IndexType::Reduce);
+    Expr expr_A = Var::make(data_type, "A", {i, k}, {M, K});
+    Expr expr_B = Var::make(data_type, "B", {k, j}, {K, N});
+    Expr expr_C = Var::make(data_type, "C", {i, j}, {M, N});
+    Stmt gemm = Move::make(expr_C,
+        Binary::make(data_type, BinaryOpType::Mul, expr_A, expr_B), MoveType::MemToMem);
+    StmtAccesses g = analyze_accesses(LoopNest::make({i, j, k}, {gemm}))[0];
+
+    std::vector<float> A(M * K, 1.0f), B(K * N, 2.0f), C(M * N, 0.0f);
+    CostEstimate ijk = model.estimate(g, LoopSchedule{{0, 1, 2}, {}});
+    report("gemm i j k", ijk, measure_ms([&]() {
+        for (int x = 0; x < M; ++x)
+            for (int y = 0; y < N; ++y)
+                for (int z = 0; z < K; ++z)
+                    C[x * N + y] += A[x * K + z] * B[z * N + y];
+    }));
+    CostEstimate ikj = model.estimate(g, LoopSchedule{{0, 2, 1}, {}});
+    report("gemm i k j", ikj, measure_ms([&]() {
+        for (int x = 0; x < M; ++x)
+            for (int z = 0; z < K; ++z)
+                for (int y = 0; y < N; ++y)
+                    C[x * N + y] += A[x * K + z] * B[z * N + y];
+    }));
+    const int T = 64;
+    CostEstimate tiled = model.estimate(g, LoopSchedule{{0, 2, 1}, {0, T, T}});
+    report("gemm i k j, j and k tiled by 64", tiled, measure_ms([&]() {
+        for (int zz = 0; zz < K; zz += T)
+            for (int yy = 0; yy < N; yy += T)
+                for (int x = 0; x < M; ++x)
+                    for (int z = zz; z < zz + T; ++z)
+                        for (int y = yy; y < yy + T; ++y)
+                            C[x * N + y] += A[x * K + z] * B[z * N + y];
+    }));
+    ikj.dump(std::cout);
+    std::vector<size_t> best = model.best_order(g);
+    if (ikj.time_ns >= ijk.time_ns || best.back() != 1 || ijk.footprint[2] <= ikj.footprint[2]) {
+        std::cout << "gemm: j should be the innermost loop!\n";
+        return 1;
+    }
+
+    // conv2d with the layout of test/conv2d.cc, batch and channels reduced to run quickly
+    const int BN = 1, CC = 256, P = 7, Q = 7, H = 9, W = 9, KK = 256, R = 3, S = 3;
+    Expr n = Index::make(index_type, "n", Dom::make(index_type, 0, BN), IndexType::Spatial);
+    Expr kk = Index::make(index_type, "k", Dom::make(index_type, 0, KK), IndexType::Spatial);
+    Expr p = Index::make(index_type, "p", Dom::make(index_type, 0, P), IndexType::Spatial);
+    Expr q = Index::make(index_type, "q", Dom::make(index_type, 0, Q), IndexType::Spatial);
+    Expr c = Index::make(index_type, "c", Dom::make(index_type, 0, CC), IndexType::Reduce);
+    Expr r = Index::make(index_type, "r", Dom::make(index_type, 0, R), IndexType::Reduce);
+    Expr s = Index::make(index_type, "s", Dom::make(index_type, 0, S), IndexType::Reduce);
+    Expr expr_I = Var::make(data_type, "I",
+        {n, c, Binary::make(index_type, BinaryOpType::Add, p, r),
+               Binary::make(index_type, BinaryOpType::Add, q, s)},
+        {BN, CC, H, W});
+    Expr expr_W = Var::make(data_type, "W", {kk, c, r, s}, {KK, CC, R, S});
+    Expr expr_O = Var::make(data_type, "O", {n, kk, p, q}, {BN, KK, P, Q});
+    Stmt conv = LoopNest::make({n, kk, p, q, c, r, s}, {Move::make(expr_O,
+        Binary::make(data_type, BinaryOpType::Mul, expr_I, expr_W), MoveType::MemToMem)});
+    StmtAccesses cv = analyze_accesses(conv)[0];
+
+    std::vector<float> I(BN * CC * H * W, 1.0f), Wt(KK * CC * R * S, 2.0f), O(BN * KK * P * Q, 0.0f);
+    CostEstimate original = model.estimate(cv, LoopSchedule{{0, 1, 2, 3, 4, 5, 6}, {}});
+    report("conv2d n k p q c r s", original, measure_ms([&]() {
+        for (int a = 0; a < BN; ++a)
+            for (int b = 0; b < KK; ++b)
+                for (int x = 0; x < P; ++x)
+                    for (int y = 0; y < Q; ++y)
+                        for (int z = 0; z < CC; ++z)
+                            for (int u = 0; u < R; ++u)
+                                for (int v = 0; v < S; ++v)
+                                    O[((a * KK + b) * P + x) * Q + y] += I[((a * CC + z) * H + x + u) * W + y + v]
+                                        * Wt[((b * CC + z) * R + u) * S + v];
+    }));
+    CostEstimate reordered = model.estimate(cv, LoopSchedule{{0, 1, 4, 5, 6, 2, 3}, {}});
+    report("conv2d n k c r s p q", reordered, measure_ms([&]() {
+        for (int a = 0; a < BN; ++a)
+            for (int b = 0; b < KK; ++b)
+                for (int z = 0; z < CC; ++z)
+                    for (int u = 0; u < R; ++u)
+                        for (int v = 0; v < S; ++v)
+                            for (int x = 0; x < P; ++x)
+                                for (int y = 0; y < Q; ++y)
+                                    O[((a * KK + b) * P + x) * Q + y] += I[((a * CC + z) * H + x + u) * W + y + v]
+                                        * Wt[((b * CC + z) * R + u) * S + v];
+    }));
+    if (original.iterations != reordered.iterations || original.footprint[0] != reordered.footprint[0]) {
+        std::cout << "conv2d: reordering must not change the iterations or the total footprint!\n";
+        return 1;
+    }
+
+    std::cout << "checksum " << C[0] + O[0] << "\n";
+    std::cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <string>
+#include <iostream>
+
+#include "IR.h"
+#include "AffineAccess.h"
+#include "Dependence.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+int main() {
+    const int M = 64;
+    const int N = 32;
+    const int K = 16;
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 1, M - 1), IndexType::Spatial);
+    Expr j = Index::make(index_type, "j", Dom::make(index_type, 0, N - 1), IndexType::Spatial);
+    Expr k = Index::make(index_type, "k", Dom::make(index_type, 0, K), IndexType::Reduce);
+    Expr i_minus_1 = Binary::make(index_type, BinaryOpType::Sub, i, 1);
+    Expr j_plus_1 = Binary::make(index_type, BinaryOpType::Add, j, 1);
+
+    // S0: C[i, j] += A[i, k] * B[k, j]
+    Expr expr_A = Var::make(data_type, "A", {i, k}, {M, K});
+    Expr expr_B = Var::make(data_type, "B", {k, j}, {K, N});
+    Expr expr_C = Var::make(data_type, "C", {i, j}, {M, N});
+    Stmt gemm = Move::make(expr_C,
+        Binary::make(data_type, BinaryOpType::Mul, expr_A, expr_B), MoveType::MemToMem);
+    // S1: D[i, j] = C[i, j], a second nest reading the gemm result
+    Expr expr_D = Var::make(data_type, "D", {i, j}, {M, N});
+    Stmt copy = Move::make(expr_D, expr_C, MoveType::MemToMem);
+    // S2: E[i, j] = F[i, j], unrelated to the others
+    Expr expr_E = Var::make(data_type, "E", {i, j}, {M, N});
+    Expr expr_F = Var::make(data_type, "F", {i, j}, {M, N});
+    Stmt other = Move::make(expr_E, expr_F, MoveType::MemToMem);
+    // S3: G[i, j] = G[i - 1, j + 1], carried by i with direction (<, >)
+    Expr expr_G = Var::make(data_type, "G", {i, j}, {M, N});
+    Expr expr_G_shift = Var::make(data_type, "G", {i_minus_1, j_plus_1}, {M, N});
+    Stmt skew = Move::make(expr_G, expr_G_shift, MoveType::MemToMem);
+
+    Group kernel = Kernel::make("dependence", {expr_A, expr_B, expr_F}, {expr_C, expr_D, expr_E, expr_G},
+        {LoopNest::make({i, j, k}, {gemm}), LoopNest::make({i, j}, {copy}),
+        LoopNest::make({i, j}, {other}), LoopNest::make({i, j}, {skew})}, KernelType::CPU);
+
+    std::vector<StmtAccesses> stmts = analyze_accesses(kernel);
+    std::vector<Dependence> deps = analyze_dependences(stmts);
+    for (auto &dep : deps) {
+        std::cout << dep << "\n";
+    }
+
+    // the gemm reduction is carried by k only
+    if (!is_parallel(deps, stmts, 0, 0) || !is_parallel(deps, stmts, 0, 1) || is_parallel(deps, stmts, 0, 2)
+        || !is_permutation_legal(deps, {2, 0, 1})) {
+        std::cout << "Wrong gemm dependences!\n";
+        return 1;
+    }
+    // the copy reads C after the gemm, the third nest touches nothing shared
+    if (are_independent(deps, 0, 1) || !are_independent(deps, 0, 2) || !are_independent(deps, 1, 2)) {
+        std::cout << "Wrong dependences between nests!\n";
+        return 1;
+    }
+    // G: one flow dependence at distance (1, -1), interchange would reverse it
+    size_t skew_deps = 0;
+    for (auto &dep : deps) {
+        if (dep.src_stmt != 3) {
+            continue;
+        }
+        ++skew_deps;
+        if (dep.type != DependenceType::Flow || dep.direction != std::vector<Direction>{Direction::Less, Direction::Greater}
+            || dep.distance != std::vector<int64_t>{1, -1}) {
+            std::cout << "Wrong skewed dependence: " << dep << "\n";
+            return 1;
+        }
+    }
+    if (skew_deps != 1 || is_parallel(deps, stmts, 3, 0) || !is_parallel(deps, stmts, 3, 1)
+        || !is_permutation_legal(deps, {0, 1}) || is_permutation_legal(deps, {1, 0})) {
+        std::cout << "Wrong skewed nest legality!\n";
+        return 1;
+    }
+
+    // W[i, j] = W[i - 1, j - 1]: interchange is legal, but (<, <) is still
+    // carried by the outer loop after it
+    Expr expr_W = Var::make(data_type, "W", {i, j}, {M, N});
+    Expr expr_W_shift = Var::make(data_type, "W", {i_minus_1, Binary::make(index_type, BinaryOpType::Sub, j, 1)},
+        {M, N});
+    Group diagonal = Kernel::make("diagonal", {}, {expr_W},
+        {LoopNest::make({i, j}, {Move::make(expr_W, expr_W_shift, MoveType::MemToMem)})}, KernelType::CPU);
+    std::vector<Dependence> diagonal_deps = analyze_dependences(analyze_accesses(diagonal));
+    if (!is_permutation_legal(diagonal_deps, {1, 0}) || is_outer_parallel(diagonal_deps, {1, 0})
+        || is_outer_parallel(diagonal_deps, {0, 1})) {
+        std::cout << "Wrong parallel outer loop of a diagonal dependence!\n";
+        return 1;
+    }
+
+    // H: the same skew in a loop inside the permuted ones, (<, >, =)
+    Expr expr_H = Var::make(data_type, "H", {i, j}, {M, N});
+    Expr expr_H_shift = Var::make(data_type, "H", {i_minus_1, j_plus_1}, {M, N});
+    Stmt inner = LoopNest::make({k}, {Move::make(expr_H, expr_H_shift, MoveType::MemToMem)});
+    Group nested = Kernel::make("nested", {}, {expr_D, expr_H}, {LoopNest::make({i, j}, {copy, inner})},
+        KernelType::CPU);
+    std::vector<Dependence> nested_deps = analyze_dependences(analyze_accesses(nested));
+    if (!is_permutation_legal(nested_deps, {0, 1}) || is_permutation_legal(nested_deps, {1, 0})) {
+        std::cout << "Wrong legality of an inner nest!\n";
+        return 1;
+    }
+
+    std::cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <string>
+#include <iostream>
+#include <chrono>
+
+#include "IR.h"
+#include "IREquality.h"
+#include "FlatExpr.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+/**
+ * reference: recursive evaluation of the tree
+ */ 
+int64_t eval_tree(const Expr &e, const std::vector<Expr> &indices, const std::vector<int64_t> &values) {
+    switch (e->node_type()) {
+        case IRNodeType::IntImm:
+            return e.as<IntImm>()->value();
+        case IRNodeType::Index:
+            for (size_t i = 0; i < indices.size(); ++i) {
+                if (indices[i].get() == e.get()) {
+                    return values[i];
+                }
+            }
+            return 0;
+        case IRNodeType::Binary: {
+            auto op = e.as<Binary>();
+            int64_t a = eval_tree(op->a, indices, values);
+            int64_t b = eval_tree(op->b, indices, values);
+            switch (op->op_type) {
+                case BinaryOpType::Add: return a + b;
+                case BinaryOpType::Sub: return a - b;
+                case BinaryOpType::Mul: return a * b;
+                case BinaryOpType::Div: return a / b;
+                case BinaryOpType::Mod: return a % b;
+                default: return 0;
+            }
+        }
+        default:
+            return 0;
+    }
+}
+
+
+int main() {
+    Type index_type = Type::int_scalar(32);
+    Expr p = Index::make(index_type, "p", Dom::make(index_type, 0, 32), IndexType::Spatial);
+    Expr r = Index::make(index_type, "r", Dom::make(index_type, 0, 3), IndexType::Reduce);
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, 64), IndexType::Spatial);
+
+    // the subscripts of one statement: p + r, i / 16, i % 16, (p + r) * 2 - 1
+    Expr pr = Binary::make(index_type, BinaryOpType::Add, p, r);
+    std::vector<Expr> subscripts = {
+        pr,
+        Binary::make(index_type, BinaryOpType::Div, i, 16),
+        Binary::make(index_type, BinaryOpType::Mod, i, 16),
+        Binary::make(index_type, BinaryOpType::Sub,
+            Binary::make(index_type, BinaryOpType::Mul, pr, 2, true), 1)
+    };
+
+    FlatExpr flat;
+    std::vector<uint32_t> slots;
+    for (auto &e : subscripts) {
+        slots.push_back(flat.add(e));
+    }
+    // p + r is shared, so 3 leaves, 4 constants and 5 operators
+    if (flat.leaves.size() != 3 || flat.constants.size() != 4 || flat.size() != 12) {
+        std::cout << "Unexpected encoding: " << flat.size() << " slots\n";
+        return 1;
+    }
+    for (size_t n = 0; n < subscripts.size(); ++n) {
+        if (!deep_equal(flat.to_expr(slots[n]), subscripts[n])) {
+            std::cout << "Subscript " << n << " does not round-trip!\n";
+            return 1;
+        }
+    }
+
+    // both evaluators agree over the whole iteration space
+    std::vector<int64_t> leaf_values(3), values;
+    std::vector<int64_t> point(3);
+    int64_t checksum_flat = 0, checksum_tree = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int64_t vp = 0; vp < 32; ++vp) {
+        for (int64_t vr = 0; vr < 3; ++vr) {
+            for (int64_t vi = 0; vi < 64; ++vi) {
+                leaf_values[0] = vp, leaf_values[1] = vr, leaf_values[2] = vi;
+                flat.evaluate(leaf_values, values);
+                for (auto s : slots) {
+                    checksum_flat += values[s];
+                }
+            }
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<Expr> indices = {p, r, i};
+    for (int64_t vp = 0; vp < 32; ++vp) {
+        for (int64_t vr = 0; vr < 3; ++vr) {
+            for (int64_t vi = 0; vi < 64; ++vi) {
+                point[0] = vp, point[1] = vr, point[2] = vi;
+                for (auto &e : subscripts) {
+                    checksum_tree += eval_tree(e, indices, point);
+                }
+            }
+        }
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    if (checksum_flat != checksum_tree) {
+        std::cout << "Flat evaluation differs: " << checksum_flat << " vs " << checksum_tree << "\n";
+        return 1;
+    }
+
+    std::cout << "6144 points: flat " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+              << " ms, tree " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms\n";
+    std::cout << "Success!\n";
+    return 0;
+}
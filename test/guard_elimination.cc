@@ -0,0 +1,157 @@
+#include <string>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "IR.h"
+#include "IRPrinter.h"
+#include "GuardElimination.h"
+#include "arith.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+using Boost::Arith::Bounds;
+using Boost::Arith::Interval;
+
+typedef std::map<std::string, int64_t> Point;
+
+
+/**
+ * run the loops, record the index values at which a Move executes
+ */ 
+void run(const Stmt &stmt, Point &point, std::multiset<Point> &executed);
+
+void run_loops(const Ref<const LoopNest> &loop, size_t level, Point &point, std::multiset<Point> &executed) {
+    if (level == loop->index_list.size()) {
+        for (auto &body : loop->body_list) {
+            run(body, point, executed);
+        }
+        return;
+    }
+    auto index = loop->index_list[level].as<Index>();
+    Bounds bounds;
+    for (auto &kv : point) {
+        bounds.bind(kv.first, Interval::point(kv.second));
+    }
+    Interval range = bounds(index->dom);
+    for (int64_t v = range.min; v <= range.max; ++v) {
+        point[index->name] = v;
+        run_loops(loop, level + 1, point, executed);
+    }
+    point.erase(index->name);
+}
+
+
+bool holds(const Expr &cond, const Point &point) {
+    Bounds bounds;
+    for (auto &kv : point) {
+        bounds.bind(kv.first, Interval::point(kv.second));
+    }
+    if (auto op = cond.as<Binary>()) {
+        return holds(op->a, point) && holds(op->b, point);
+    }
+    auto cmp = cond.as<Compare>();
+    return bounds(cmp->a).min < bounds(cmp->b).min;
+}
+
+
+void run(const Stmt &stmt, Point &point, std::multiset<Point> &executed) {
+    if (auto loop = stmt.as<LoopNest>()) {
+        run_loops(loop, 0, point, executed);
+    } else if (auto guard = stmt.as<If>()) {
+        if (holds(guard->cond, point)) {
+            run(guard->true_case, point, executed);
+        }
+    } else {
+        executed.insert(point);
+    }
+}
+
+
+int count_ifs(const Stmt &stmt) {
+    if (auto loop = stmt.as<LoopNest>()) {
+        int n = 0;
+        for (auto &body : loop->body_list) {
+            n += count_ifs(body);
+        }
+        return n;
+    }
+    if (auto guard = stmt.as<If>()) {
+        return 1 + count_ifs(guard->true_case);
+    }
+    return 0;
+}
+
+
+/**
+ * A[out...] = B[in...] under the guard Parse builds: each non-trivial
+ * subscript below its extent
+ */ 
+Stmt guarded_copy(const std::vector<Expr> &loops, const std::vector<Expr> &subscripts, size_t extent) {
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+    Expr dst = Var::make(data_type, "A", {loops[0]}, {extent});
+    Expr src = Var::make(data_type, "B", subscripts, std::vector<size_t>(subscripts.size(), extent));
+    Expr cond;
+    for (auto &s : subscripts) {
+        Expr c = Compare::make(data_type, CompareOpType::LT, s, IntImm::make(index_type, extent));
+        cond = cond.defined() ? Binary::make(data_type, BinaryOpType::And, cond, c) : c;
+    }
+    return LoopNest::make(loops, {If::make(cond, Move::make(dst, src, MoveType::MemToMem))});
+}
+
+
+bool check(const std::string &what, const Stmt &before, int ifs_after) {
+    GuardElimination pass;
+    Stmt after = pass.mutate(before);
+    std::multiset<Point> ran_before, ran_after;
+    Point point;
+    run(before, point, ran_before);
+    run(after, point, ran_after);
+    if (ran_before != ran_after || count_ifs(after) != ifs_after) {
+        IRPrinter printer;
+        std::cout << what << ": " << ran_after.size() << " of " << ran_before.size()
+                  << " iterations, " << count_ifs(after) << " guards\n" << printer.print(after);
+        return false;
+    }
+    return true;
+}
+
+
+int main() {
+    Type index_type = Type::int_scalar(32);
+    auto index = [&](const std::string &name, int extent) {
+        return Index::make(index_type, name, Dom::make(index_type, 0, extent), IndexType::Spatial);
+    };
+    Expr i = index("i", 8);
+    Expr j = index("j", 8);
+    Expr p = index("p", 32);
+    Expr r = index("r", 3);
+    auto add = [&](const Expr &a, const Expr &b) {
+        return Binary::make(index_type, BinaryOpType::Add, a, b);
+    };
+
+    bool ok = true;
+    // kernel_case10: B<10, 8>[i + 2, j] with i < 8, the guard always holds
+    ok &= check("proven", guarded_copy({i, j}, {add(i, 1), add(i, 2)}, 10), 0);
+    // i + 2 < 8: clamp i to [0, 6)
+    ok &= check("clamped", guarded_copy({i, j}, {add(i, 2), j}, 8), 0);
+    // p + r < 32: p in [0, 30) runs without a guard, [30, 32) keeps it
+    ok &= check("split", guarded_copy({p, r}, {add(p, r)}, 32), 1);
+    // split on the inner loop keeps the outer one around both parts
+    ok &= check("inner split", guarded_copy({j, p, r}, {j, add(p, r)}, 32), 1);
+    // i * i is not affine, the guard stays
+    ok &= check("opaque", guarded_copy({i}, {Binary::make(index_type, BinaryOpType::Mul, i, i)}, 20), 1);
+    // never true: the statement disappears
+    ok &= check("dead", guarded_copy({i}, {add(i, 40)}, 32), 0);
+    if (!ok) {
+        return 1;
+    }
+
+    GuardElimination pass;
+    IRPrinter printer;
+    std::cout << printer.print(pass.mutate(guarded_copy({p, r}, {add(p, r)}, 32)));
+    std::cout << "Success!\n";
+    return 0;
+}
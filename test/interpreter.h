@@ -0,0 +1,229 @@
+#ifndef BOOST_TEST_INTERPRETER_H
+#define BOOST_TEST_INTERPRETER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "IR.h"
+
+
+namespace Boost {
+
+namespace Internal {
+
+/**
+ * runs kernel statements lane by lane, the way IRPrinter prints them.
+ * Arrays start out filled with their flat offsets, modulo period when it
+ * is not 0, which keeps sums of products exact in any order
+ */ 
+class Interpreter {
+ public:
+    typedef std::vector<double> Value;
+
+    std::map<std::string, Value> scalars;
+    std::map<std::string, std::vector<double> > arrays;
+
+    explicit Interpreter(size_t _period = 0) : period(_period) {}
+
+    Value eval(const Expr &e) {
+        if (auto imm = e.as<IntImm>()) {
+            return {static_cast<double>(imm->value())};
+        }
+        if (auto imm = e.as<FloatImm>()) {
+            return {imm->value()};
+        }
+        if (auto index = e.as<Index>()) {
+            return scalars.at(index->name);
+        }
+        if (auto ramp = e.as<Ramp>()) {
+            double base = eval(ramp->base)[0];
+            Value lanes;
+            for (int l = 0; l < ramp->lanes; ++l) {
+                lanes.push_back(base + l * ramp->stride);
+            }
+            return lanes;
+        }
+        if (auto var = e.as<Var>()) {
+            if (var->args.empty()) {
+                return scalars.at(var->name);
+            }
+            Value lanes;
+            for (auto offset : offsets(var)) {
+                lanes.push_back(arrays[var->name][offset]);
+            }
+            return lanes;
+        }
+        if (auto op = e.as<Unary>()) {
+            Value a = eval(op->a);
+            for (auto &x : a) {
+                x = op->op_type == UnaryOpType::Neg ? -x : x == 0;
+            }
+            return a;
+        }
+        Value a, b;
+        if (auto op = e.as<Compare>()) {
+            if (!operands(op->a, op->b, a, b)) {
+                return a;
+            }
+            for (size_t l = 0; l < a.size(); ++l) {
+                a[l] = compare(op->op_type, a[l], b[l]);
+            }
+            return a;
+        }
+        auto op = e.as<Binary>();
+        if (!operands(op->a, op->b, a, b)) {
+            return a;
+        }
+        for (size_t l = 0; l < a.size(); ++l) {
+            a[l] = binary(op->op_type, a[l], b[l]);
+        }
+        return a;
+    }
+
+    /**
+     * the flat offset of each lane of an array access
+     */ 
+    std::vector<size_t> offsets(Ref<const Var> var) {
+        std::vector<double> &data = arrays[var->name];
+        size_t size = 1;
+        std::vector<Value> args;
+        size_t lanes = 1;
+        for (size_t d = 0; d < var->args.size(); ++d) {
+            args.push_back(eval(var->args[d]));
+            lanes = std::max(lanes, args.back().size());
+            size *= var->shape[d];
+        }
+        if (data.empty()) {
+            for (size_t v = 0; v < size; ++v) {
+                data.push_back(static_cast<double>(period == 0 ? v : v % period));
+            }
+        }
+        std::vector<size_t> result;
+        for (size_t l = 0; l < lanes; ++l) {
+            size_t offset = 0;
+            for (size_t d = 0; d < args.size(); ++d) {
+                int64_t at = static_cast<int64_t>(args[d][args[d].size() == 1 ? 0 : l]);
+                if (at < 0 || at >= static_cast<int64_t>(var->shape[d])) {
+                    std::cout << var->name << " subscript " << d << " out of range: " << at << "\n";
+                    at = 0;
+                }
+                offset = offset * var->shape[d] + at;
+            }
+            result.push_back(offset);
+        }
+        return result;
+    }
+
+    void run(const Stmt &stmt) {
+        if (auto loop = stmt.as<LoopNest>()) {
+            run_loops(loop, 0);
+        } else if (auto guard = stmt.as<If>()) {
+            if (eval(guard->cond)[0] != 0) {
+                run(guard->true_case);
+            }
+        } else if (auto reduce = stmt.as<Reduce>()) {
+            store(reduce->dst.as<Var>(), eval(reduce->value), false, reduce->combiner);
+        } else if (auto move = stmt.as<Move>()) {
+            Value value = eval(move->src);
+            auto dst = move->dst.as<Var>();
+            if (move->move_type == MoveType::MemToLocal) {
+                scalars[dst->name] = value;
+            } else {
+                store(dst, value, move->move_type == MoveType::LocalToMem);
+            }
+        }
+    }
+
+ private:
+    size_t period;
+
+    bool operands(const Expr &x, const Expr &y, Value &a, Value &b) {
+        a = eval(x);
+        b = eval(y);
+        if (a.size() != b.size()) {
+            std::cout << "operands of " << a.size() << " and " << b.size() << " lanes\n";
+            return false;
+        }
+        return true;
+    }
+
+    static double compare(CompareOpType op, double a, double b) {
+        switch (op) {
+            case CompareOpType::LT: return a < b;
+            case CompareOpType::LE: return a <= b;
+            case CompareOpType::EQ: return a == b;
+            case CompareOpType::NE: return a != b;
+            case CompareOpType::GE: return a >= b;
+            default: return a > b;
+        }
+    }
+
+    static double binary(BinaryOpType op, double a, double b) {
+        switch (op) {
+            case BinaryOpType::Add: return a + b;
+            case BinaryOpType::Sub: return a - b;
+            case BinaryOpType::Mul: return a * b;
+            case BinaryOpType::Div: return static_cast<double>(static_cast<int64_t>(a) / static_cast<int64_t>(b));
+            case BinaryOpType::Mod: return static_cast<double>(static_cast<int64_t>(a) % static_cast<int64_t>(b));
+            case BinaryOpType::And: return a != 0 && b != 0;
+            case BinaryOpType::Or: return a != 0 || b != 0;
+            default: return 0;
+        }
+    }
+
+    /**
+     * assigns value to each lane of dst, or combines it into them
+     */ 
+    void store(Ref<const Var> dst, const Value &value, bool assign, BinaryOpType combiner = BinaryOpType::Add) {
+        std::vector<double *> lanes;
+        if (dst->args.empty()) {
+            Value &local = scalars[dst->name];
+            if (local.empty()) {
+                local.resize(value.size());
+            }
+            for (auto &x : local) {
+                lanes.push_back(&x);
+            }
+        } else {
+            for (auto offset : offsets(dst)) {
+                lanes.push_back(&arrays[dst->name][offset]);
+            }
+        }
+        if (lanes.size() != value.size()) {
+            std::cout << "storing " << value.size() << " lanes to " << lanes.size() << "\n";
+            return;
+        }
+        for (size_t l = 0; l < lanes.size(); ++l) {
+            *lanes[l] = assign ? value[l] : binary(combiner, *lanes[l], value[l]);
+        }
+    }
+
+    void run_loops(const Ref<const LoopNest> &loop, size_t level) {
+        if (level == loop->index_list.size()) {
+            for (auto &body : loop->body_list) {
+                run(body);
+            }
+            return;
+        }
+        auto index = loop->index_list[level].as<Index>();
+        auto dom = index->dom.as<Dom>();
+        int64_t begin = static_cast<int64_t>(eval(dom->begin)[0]);
+        int64_t end = begin + static_cast<int64_t>(eval(dom->extent)[0]);
+        for (int64_t v = begin; v < end; ++v) {
+            scalars[index->name] = {static_cast<double>(v)};
+            run_loops(loop, level + 1);
+        }
+    }
+};
+
+
+}  // namespace Internal
+
+}  // namespace Boost
+
+
+#endif  // BOOST_TEST_INTERPRETER_H
@@ -0,0 +1,165 @@
+#include <string>
+#include <iostream>
+#include <chrono>
+
+#include "IR.h"
+#include "IRContext.h"
+#include "IRMutator.h"
+#include "IRVisitor.h"
+#include "IRPrinter.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+Group build_gemm() {
+    const int M = 1024;
+    const int N = 512;
+    const int K = 256;
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, M), IndexType::Spatial);
+    Expr j = Index::make(index_type, "j", Dom::make(index_type, 0, N), IndexType::Spatial);
+    Expr k = Index::make(index_type, "k", Dom::make(index_type, 0, K), IndexType::Reduce);
+
+    Expr expr_A = Var::make(data_type, "A", {i, k}, {M, K});
+    Expr expr_B = Var::make(data_type, "B", {k, j}, {K, N});
+    // C is spelled twice, as a parser would do
+    Expr expr_C = Var::make(data_type, "C", {i, j}, {M, N});
+    Expr expr_C_rhs = Var::make(data_type, "C", {i, j}, {M, N});
+
+    Stmt main_stmt = Move::make(
+        expr_C,
+        Binary::make(data_type, BinaryOpType::Add, expr_C_rhs,
+            Binary::make(data_type, BinaryOpType::Mul, expr_A, expr_B)),
+        MoveType::MemToMem
+    );
+    Stmt loop_nest = LoopNest::make({i, j, k}, {main_stmt});
+    return Kernel::make("simple_gemm", {expr_A, expr_B}, {expr_C}, {loop_nest}, KernelType::CPU);
+}
+
+
+Group build_conv2d() {
+    const int N = 256;
+    const int C = 1024;
+    const int P = 7;
+    const int Q = 7;
+    const int H = 9;
+    const int W = 9;
+    const int K = 1024;
+    const int R = 3;
+    const int S = 3;
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    Expr n = Index::make(index_type, "n", Dom::make(index_type, 0, N), IndexType::Spatial);
+    Expr k = Index::make(index_type, "k", Dom::make(index_type, 0, K), IndexType::Spatial);
+    Expr p = Index::make(index_type, "p", Dom::make(index_type, 0, P), IndexType::Spatial);
+    Expr q = Index::make(index_type, "q", Dom::make(index_type, 0, Q), IndexType::Spatial);
+    Expr c = Index::make(index_type, "c", Dom::make(index_type, 0, C), IndexType::Reduce);
+    Expr r = Index::make(index_type, "r", Dom::make(index_type, 0, R), IndexType::Reduce);
+    Expr s = Index::make(index_type, "s", Dom::make(index_type, 0, S), IndexType::Reduce);
+
+    Expr expr_I = Var::make(data_type, "I",
+        {n, c, Binary::make(index_type, BinaryOpType::Add, p, r),
+               Binary::make(index_type, BinaryOpType::Add, q, s)},
+        {N, C, H, W});
+    Expr expr_W = Var::make(data_type, "W", {k, c, r, s}, {K, C, R, S});
+    Expr expr_O = Var::make(data_type, "O", {n, k, p, q}, {N, K, P, Q});
+    Expr expr_O_rhs = Var::make(data_type, "O", {n, k, p, q}, {N, K, P, Q});
+
+    // bounds guards rebuild the same index expressions, as Parse::buildIfStmt does
+    Expr cond = Binary::make(index_type, BinaryOpType::And,
+        Compare::make(index_type, CompareOpType::LT,
+            Binary::make(index_type, BinaryOpType::Add, p, r), H),
+        Compare::make(index_type, CompareOpType::LT,
+            Binary::make(index_type, BinaryOpType::Add, q, s), W));
+
+    Stmt main_stmt = Move::make(
+        expr_O,
+        Binary::make(data_type, BinaryOpType::Add, expr_O_rhs,
+            Binary::make(data_type, BinaryOpType::Mul, expr_I, expr_W)),
+        MoveType::MemToMem
+    );
+    Stmt loop_nest = LoopNest::make({n, k, p, q, c, r, s}, {If::make(cond, main_stmt)});
+    return Kernel::make("simple_conv2d", {expr_I, expr_W}, {expr_O}, {loop_nest}, KernelType::CPU);
+}
+
+
+bool report(const std::string &name, Group (*build)()) {
+    IRPrinter printer;
+    std::string before_code, after_code, arena_code;
+    IRContext before(false), after(true);
+    {
+        IRContext::Scope scope(before);
+        Group kernel = build();
+        IRMutator mutator;
+        before_code = printer.print(mutator.mutate(kernel));
+    }
+    {
+        IRContext::Scope scope(after);
+        Group kernel = build();
+        IRMutator mutator;
+        after_code = IRPrinter().print(mutator.mutate(kernel));
+    }
+    {
+        IRContext arena(true, true);
+        IRContext::Scope scope(arena);
+        Group kernel = build();
+        IRMutator mutator;
+        arena_code = IRPrinter().print(mutator.mutate(kernel));
+    }
+    std::cout << name << ": nodes " << before.allocated_nodes() << " -> " << after.allocated_nodes()
+              << ", bytes " << before.allocated_bytes() << " -> " << after.allocated_bytes() << "\n";
+    return before_code == after_code && before_code == arena_code;
+}
+
+
+/**
+ * compile the same kernel many times, one context per compilation
+ */ 
+double batch(Group (*build)(), int times, bool use_context, bool use_arena) {
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < times; ++t) {
+        IRContext ctx(false, use_arena);
+        if (use_context) {
+            IRContext::Scope scope(ctx);
+            IRMutator().mutate(build());
+        } else {
+            IRMutator().mutate(build());
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+
+int main() {
+    Type index_type = Type::int_scalar(32);
+    IRContext ctx;
+    {
+        IRContext::Scope scope(ctx);
+        Expr p = Index::make(index_type, "p", Dom::make(index_type, 0, 7), IndexType::Spatial);
+        Expr r = Index::make(index_type, "r", Dom::make(index_type, 0, 3), IndexType::Reduce);
+        Expr a = Binary::make(index_type, BinaryOpType::Add, p, r);
+        Expr b = Binary::make(index_type, BinaryOpType::Add, p, r);
+        Expr c = Binary::make(index_type, BinaryOpType::Add, r, p);
+        if (a.get() != b.get() || a.get() == c.get()) {
+            std::cout << "Hash consing failed!\n";
+            return 1;
+        }
+    }
+
+    if (!report("gemm", build_gemm) || !report("conv2d", build_conv2d)) {
+        std::cout << "Interned IR prints differently!\n";
+        return 1;
+    }
+
+    const int times = 2000;
+    std::cout << "conv2d x" << times << ": heap " << batch(build_conv2d, times, false, false)
+              << " ms, arena " << batch(build_conv2d, times, true, true) << " ms\n";
+
+    std::cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <cmath>
+#include <string>
+#include <iostream>
+#include <unordered_set>
+
+#include "IR.h"
+#include "IREquality.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+Group build_gemm(const std::string &name, size_t M, size_t N, size_t K) {
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, static_cast<int>(M)), IndexType::Spatial);
+    Expr j = Index::make(index_type, "j", Dom::make(index_type, 0, static_cast<int>(N)), IndexType::Spatial);
+    Expr k = Index::make(index_type, "k", Dom::make(index_type, 0, static_cast<int>(K)), IndexType::Reduce);
+
+    Expr expr_A = Var::make(data_type, "A", {i, k}, {M, K});
+    Expr expr_B = Var::make(data_type, "B", {k, j}, {K, N});
+    Expr expr_C = Var::make(data_type, "C", {i, j}, {M, N});
+
+    Stmt main_stmt = Move::make(
+        expr_C,
+        Binary::make(data_type, BinaryOpType::Add, expr_C,
+            Binary::make(data_type, BinaryOpType::Mul, expr_A, expr_B)),
+        MoveType::MemToMem
+    );
+    Stmt loop_nest = LoopNest::make({i, j, k}, {main_stmt});
+    return Kernel::make(name, {expr_A, expr_B}, {expr_C}, {loop_nest}, KernelType::CPU);
+}
+
+
+int main() {
+    // independently built trees are equal and hash alike
+    Group a = build_gemm("gemm", 64, 32, 16);
+    Group b = build_gemm("gemm", 64, 32, 16);
+    if (a.get() == b.get() || !deep_equal(a, b)
+        || a->structural_hash() != b->structural_hash()) {
+        std::cout << "Equal kernels compare unequal!\n";
+        return 1;
+    }
+
+    // differences in name, Dom extent or Var::args are detected
+    if (deep_equal(a, build_gemm("gemm2", 64, 32, 16))
+        || deep_equal(a, build_gemm("gemm", 64, 32, 8))) {
+        std::cout << "Different kernels compare equal!\n";
+        return 1;
+    }
+    Type index_type = Type::int_scalar(32);
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, 4), IndexType::Spatial);
+    Expr j = Index::make(index_type, "j", Dom::make(index_type, 0, 4), IndexType::Spatial);
+    Expr x = Var::make(Type::float_scalar(32), "X", {i, j}, {4, 4});
+    Expr y = Var::make(Type::float_scalar(32), "X", {j, i}, {4, 4});
+    Expr z = Var::make(Type::float_scalar(64), "X", {i, j}, {4, 4});
+    if (deep_equal(x, y) || deep_equal(x, z)) {
+        std::cout << "Var args or type ignored!\n";
+        return 1;
+    }
+
+    // usable as keys of unordered containers
+    std::unordered_set<Group, StructuralHash, StructuralEqual> kernels;
+    kernels.insert(a);
+    kernels.insert(b);
+    kernels.insert(build_gemm("gemm", 64, 32, 8));
+    if (kernels.size() != 2) {
+        std::cout << "Structural set has " << kernels.size() << " kernels, expected 2\n";
+        return 1;
+    }
+
+    // deep chains are compared without recursion
+    Expr chain_a = IntImm::make(index_type, 0);
+    Expr chain_b = IntImm::make(index_type, 0);
+    for (int n = 0; n < 10000; ++n) {
+        chain_a = Binary::make(index_type, BinaryOpType::Add, chain_a, IntImm::make(index_type, n));
+        chain_b = Binary::make(index_type, BinaryOpType::Add, chain_b, IntImm::make(index_type, n));
+    }
+    if (!deep_equal(chain_a, chain_b)) {
+        std::cout << "Deep chains compare unequal!\n";
+        return 1;
+    }
+
+    // float literals compare by their bits, as they hash
+    Type float_type = Type::float_scalar(32);
+    Expr zero = FloatImm::make(float_type, 0.0);
+    Expr negative_zero = FloatImm::make(float_type, -0.0);
+    Expr nan = FloatImm::make(float_type, std::nan(""));
+    if (deep_equal(zero, negative_zero) || !deep_equal(nan, FloatImm::make(float_type, std::nan("")))) {
+        std::cout << "Float literals compare by value!\n";
+        return 1;
+    }
+
+    // unshared copies of a DAG of 2^64 paths compare in linear time
+    Expr dag_a = i;
+    Expr dag_b = Index::make(index_type, "i", Dom::make(index_type, 0, 4), IndexType::Spatial);
+    for (int n = 0; n < 64; ++n) {
+        dag_a = Binary::make(index_type, BinaryOpType::Add, dag_a, dag_a);
+        dag_b = Binary::make(index_type, BinaryOpType::Add, dag_b, dag_b);
+    }
+    if (!deep_equal(dag_a, dag_b)) {
+        std::cout << "DAGs compare unequal!\n";
+        return 1;
+    }
+
+    std::cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <string>
+#include <iostream>
+#include <chrono>
+
+#include "IR.h"
+#include "IRVisitor.h"
+#include "IRFunctor.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+/**
+ * counts Var accesses, dynamic dispatch
+ */ 
+class VarCounter : public IRVisitor {
+ public:
+    int count = 0;
+    void visit(Ref<const Var> op) override {
+        count += 1;
+        IRVisitor::visit(op);
+    }
+};
+
+
+/**
+ * the same pass migrated to static dispatch
+ */ 
+class StaticVarCounter : public IRTreeVisitor<StaticVarCounter> {
+ public:
+    using IRTreeVisitor<StaticVarCounter>::visit;
+    int count = 0;
+    void visit(const Var &op) {
+        count += 1;
+        visit_default(op);
+    }
+};
+
+
+/**
+ * expression depth, functor with a result
+ */ 
+class Depth : public IRFunctor<Depth, int> {
+ public:
+    using IRFunctor<Depth, int>::visit;
+    int visit(const Binary &op) {
+        return 1 + std::max((*this)(op.a), (*this)(op.b));
+    }
+    int visit_default(const IRNode &) {
+        return 1;
+    }
+};
+
+
+int main() {
+    const int M = 1024;
+    const int N = 512;
+    const int K = 256;
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, M), IndexType::Spatial);
+    Expr j = Index::make(index_type, "j", Dom::make(index_type, 0, N), IndexType::Spatial);
+    Expr k = Index::make(index_type, "k", Dom::make(index_type, 0, K), IndexType::Reduce);
+    Expr expr_A = Var::make(data_type, "A", {i, k}, {M, K});
+    Expr expr_B = Var::make(data_type, "B", {k, j}, {K, N});
+    Expr expr_C = Var::make(data_type, "C", {i, j}, {M, N});
+    Expr src = Binary::make(data_type, BinaryOpType::Add, expr_C,
+        Binary::make(data_type, BinaryOpType::Mul, expr_A, expr_B));
+    Stmt main_stmt = Move::make(expr_C, src, MoveType::MemToMem);
+    Stmt loop_nest = LoopNest::make({i, j, k}, {main_stmt});
+    Group kernel = Kernel::make("simple_gemm", {expr_A, expr_B}, {expr_C}, {loop_nest}, KernelType::CPU);
+
+    VarCounter dynamic_counter;
+    kernel.visit_group(&dynamic_counter);
+    StaticVarCounter static_counter;
+    static_counter(kernel);
+    if (dynamic_counter.count != static_counter.count || Depth()(src) != 3) {
+        std::cout << "Static dispatch disagrees with IRVisitor!\n";
+        return 1;
+    }
+
+    // explicit-stack traversals
+    int pre = 0, post = 0;
+    pre_order_visit(kernel.get(), [&pre](const IRNode *) { pre += 1; });
+    post_order_visit(kernel.get(), [&post](const IRNode *) { post += 1; });
+    Expr chain = i;
+    for (int t = 0; t < 10000; ++t) {
+        chain = Binary::make(index_type, BinaryOpType::Add, chain, 1);
+    }
+    int chain_nodes = 0;
+    post_order_visit(chain.get(), [&chain_nodes](const IRNode *) { chain_nodes += 1; });
+    if (pre != post || chain_nodes != 10000 * 2 + 4) {
+        std::cout << "Iterative traversal miscounted!\n";
+        return 1;
+    }
+
+    const int times = 20000;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < times; ++t) {
+        kernel.visit_group(&dynamic_counter);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int t = 0; t < times; ++t) {
+        static_counter(kernel);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "gemm x" << times << ": IRVisitor "
+              << std::chrono::duration<double, std::milli>(middle - start).count() << " ms, IRTreeVisitor "
+              << std::chrono::duration<double, std::milli>(end - middle).count() << " ms\n";
+
+    std::cout << "Success!\n";
+    return 0;
+}
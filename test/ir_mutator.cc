@@ -63,10 +63,25 @@ int main() {
     // kernel
     Group kernel = Kernel::make("simple_gemm", {expr_A, expr_B}, {expr_C}, {loop_nest}, KernelType::CPU);
 
+    // an identity mutation keeps the original tree
+    IRMutator identity;
+    if (identity.mutate(kernel).get() != kernel.get()) {
+        std::cout << "Identity mutation rebuilt the kernel!\n";
+        return 1;
+    }
+
     // mutator
     MyMutator mutator;
     kernel = mutator.mutate(kernel);
 
+    // only the path to A is rebuilt, B keeps its node
+    auto stmt = kernel.as<Kernel>()->stmt_list[0].as<LoopNest>()->body_list[0].as<Move>();
+    auto mul = stmt->src.as<Binary>()->b.as<Binary>();
+    if (mul->a.as<Var>()->name != "modified_A" || mul->b.get() != expr_B.get()) {
+        std::cout << "Unchanged subtree was rebuilt!\n";
+        return 1;
+    }
+
     // printer
     IRPrinter printer;
     std::string code = printer.print(kernel);
@@ -0,0 +1,113 @@
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+
+#include "IR.h"
+#include "IRPrinter.h"
+#include "IREquality.h"
+#include "IRSerialize.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+Group build_gemm(size_t M, size_t N, size_t K) {
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, static_cast<int>(M)), IndexType::Spatial);
+    Expr j = Index::make(index_type, "j", Dom::make(index_type, 0, static_cast<int>(N)), IndexType::Spatial);
+    Expr k = Index::make(index_type, "k", Dom::make(index_type, 0, static_cast<int>(K)), IndexType::Reduce);
+
+    Expr expr_A = Var::make(data_type, "A", {i, k}, {M, K});
+    Expr expr_B = Var::make(data_type, "B", {k, j}, {K, N});
+    Expr expr_C = Var::make(data_type, "C", {i, j}, {M, N});
+
+    Stmt main_stmt = Move::make(
+        expr_C,
+        Binary::make(data_type, BinaryOpType::Add, expr_C,
+            Binary::make(data_type, BinaryOpType::Mul, expr_A, expr_B, true)),
+        MoveType::MemToMem
+    );
+    Stmt loop_nest = LoopNest::make({i, j, k}, {main_stmt});
+    return Kernel::make("simple_gemm", {expr_A, expr_B}, {expr_C}, {loop_nest}, KernelType::CPU);
+}
+
+
+Group build_guarded(size_t H) {
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    Expr h = Index::make(index_type, "h", Dom::make(index_type, 0, static_cast<int>(H)), IndexType::Spatial);
+    Expr r = Index::make(index_type, "r", Dom::make(index_type, 0, 3), IndexType::Reduce);
+    Expr pos = Binary::make(index_type, BinaryOpType::Add, h, r);
+    Expr expr_X = Var::make(data_type, "X", {pos}, {H + 2});
+    Expr expr_Y = Var::make(data_type, "Y", {h}, {H});
+
+    Expr scaled = Binary::make(data_type, BinaryOpType::Mul, expr_X, FloatImm::make(data_type, 0.25));
+    Expr cond = Compare::make(Type::uint_scalar(1), CompareOpType::LT, pos,
+        IntImm::make(index_type, static_cast<int64_t>(H)));
+    Stmt guarded = IfThenElse::make(cond,
+        Move::make(expr_Y, scaled, MoveType::MemToMem),
+        Move::make(expr_Y, Unary::make(data_type, UnaryOpType::Neg, scaled), MoveType::MemToMem));
+    Stmt loop_nest = LoopNest::make({h, r}, {guarded});
+    return Kernel::make("guarded", {expr_X}, {expr_Y}, {loop_nest}, KernelType::CPU);
+}
+
+
+std::string print(const Group &group) {
+    // IRPrinter keeps appending to its stream, use a fresh one each time
+    IRPrinter printer;
+    return printer.print(group);
+}
+
+
+int main() {
+    std::vector<Group> kernels = {build_gemm(64, 32, 16), build_guarded(30)};
+
+    std::string bytes = serialize_ir(kernels);
+    std::vector<Group> loaded = deserialize_ir(bytes.data(), bytes.size());
+    if (loaded.size() != kernels.size()) {
+        std::cout << "Loaded " << loaded.size() << " kernels, expected " << kernels.size() << "\n";
+        return 1;
+    }
+    for (size_t i = 0; i < kernels.size(); ++i) {
+        if (print(kernels[i]) != print(loaded[i]) || !deep_equal(kernels[i], loaded[i])) {
+            std::cout << "Kernel " << i << " does not round-trip!\n";
+            return 1;
+        }
+    }
+
+    // shared nodes stay shared: C is both the destination and an operand
+    auto move = loaded[0].as<Kernel>()->stmt_list[0].as<LoopNest>()->body_list[0].as<Move>();
+    if (move->dst.get() != move->src.as<Binary>()->a.get()) {
+        std::cout << "Sharing was lost!\n";
+        return 1;
+    }
+
+    // through a mapped file
+    std::string path = "ir_serialize.bin";
+    if (!save_ir(path, kernels)) {
+        std::cout << "Can't write " << path << "\n";
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    const int rounds = 1000;
+    for (int n = 0; n < rounds; ++n) {
+        loaded = load_ir(path);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::remove(path.c_str());
+    for (size_t i = 0; i < kernels.size(); ++i) {
+        if (print(kernels[i]) != print(loaded[i])) {
+            std::cout << "Kernel " << i << " does not round-trip through a file!\n";
+            return 1;
+        }
+    }
+
+    std::cout << bytes.size() << " bytes, load "
+              << std::chrono::duration<double, std::micro>(end - start).count() / rounds << " us\n";
+    std::cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <string>
+#include <iostream>
+
+#include "IR.h"
+#include "IRMutator.h"
+#include "IRStats.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+class RenameA : public IRMutator {
+ public:
+    RenameA() : IRMutator(true) {}
+
+    const char *name() const override {
+        return "RenameA";
+    }
+
+    Expr visit(Ref<const Var> op) override {
+        if (op->name == "A") {
+            return Var::make(op->type(), "A2", op->args, op->shape);
+        }
+        return IRMutator::visit(op);
+    }
+};
+
+
+Group build_gemm() {
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, 64), IndexType::Spatial);
+    Expr j = Index::make(index_type, "j", Dom::make(index_type, 0, 32), IndexType::Spatial);
+    Expr k = Index::make(index_type, "k", Dom::make(index_type, 0, 16), IndexType::Reduce);
+
+    Expr expr_A = Var::make(data_type, "A", {i, k}, {64, 16});
+    Expr expr_B = Var::make(data_type, "B", {k, j}, {16, 32});
+    Expr expr_C = Var::make(data_type, "C", {i, j}, {64, 32});
+
+    Stmt main_stmt = Move::make(
+        expr_C,
+        Binary::make(data_type, BinaryOpType::Add, expr_C,
+            Binary::make(data_type, BinaryOpType::Mul, expr_A, expr_B)),
+        MoveType::MemToMem
+    );
+    Stmt loop_nest = LoopNest::make({i, j, k}, {main_stmt});
+    return Kernel::make("simple_gemm", {expr_A, expr_B}, {expr_C}, {loop_nest}, KernelType::CPU);
+}
+
+
+int main() {
+    IRStats::enable();
+    IRStats::reset();
+    {
+        Group kernel = build_gemm();
+        if (IRStats::live_nodes(IRNodeType::Var) != 3 || IRStats::live_nodes(IRNodeType::Kernel) != 1) {
+            std::cout << "Wrong live counts!\n";
+            return 1;
+        }
+        RenameA mutator;
+        kernel = mutator.mutate(kernel);
+        // A, the product, the sum, the move, the loop nest and the kernel
+        auto passes = IRStats::passes();
+        if (passes.size() != 1 || passes[0].name != "RenameA" || passes[0].rebuilt != 6) {
+            std::cout << "Wrong pass record!\n";
+            return 1;
+        }
+        if (IRStats::shared_from_this_calls() == 0 || IRStats::allocated_bytes() == 0) {
+            std::cout << "Missing counters!\n";
+            return 1;
+        }
+    }
+    // everything is freed, the peak stays
+    if (IRStats::live_nodes() != 0 || IRStats::peak_nodes(IRNodeType::Var) != 4) {
+        std::cout << "Wrong counts after release!\n";
+        return 1;
+    }
+    IRStats::dump(std::cout);
+    std::cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <string>
+#include <iostream>
+#include <vector>
+
+#include "IR.h"
+#include "IRPrinter.h"
+#include "LoopPermutation.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+std::string loop_names(Ref<const LoopNest> nest, const std::vector<size_t> &order) {
+    std::string names;
+    for (auto l : order) {
+        names += nest->index_list[l].as<Index>()->name;
+    }
+    return names;
+}
+
+
+bool check(const std::string &what, const Stmt &stmt, const std::string &expected) {
+    auto nest = stmt.as<LoopNest>();
+    std::string chosen = loop_names(nest, LoopPermutation().choose(nest));
+    if (chosen != expected) {
+        std::cout << what << ": chose " << chosen << ", expected " << expected << "\n" << IRPrinter().print(stmt);
+        return false;
+    }
+    return true;
+}
+
+
+int main() {
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+    auto index = [&](const std::string &name, int extent, IndexType index_type_ = IndexType::Spatial) {
+        return Index::make(index_type, name, Dom::make(index_type, 0, extent), index_type_);
+    };
+    auto mul = [&](const Expr &a, const Expr &b) {
+        return Binary::make(data_type, BinaryOpType::Mul, a, b);
+    };
+    auto move = [&](const Expr &dst, const Expr &src) {
+        return Move::make(dst, src, MoveType::MemToMem);
+    };
+
+    // grad_case4: dC[k][j] += B[i][k] * dA[i][j] with the reduction i innermost
+    // walks B and dA down their columns; k i j makes j stride 1 and keeps
+    // the parallel k outermost
+    Expr i = index("i", 16, IndexType::Reduce), j = index("j", 32), k = index("k", 32);
+    Stmt grad = LoopNest::make({k, j, i}, {move(Var::make(data_type, "dC", {k, j}, {32, 32}),
+        mul(Var::make(data_type, "B", {i, k}, {16, 32}), Var::make(data_type, "dA", {i, j}, {16, 32})))});
+
+    // gemm C[i][j] += A[i][k] * B[k][j]: i k j, i outermost as it is parallel
+    Expr gi = index("i", 256), gj = index("j", 256), gk = index("k", 256, IndexType::Reduce);
+    Stmt gemm = LoopNest::make({gi, gj, gk}, {move(Var::make(data_type, "C", {gi, gj}, {256, 256}),
+        mul(Var::make(data_type, "A", {gi, gk}, {256, 256}), Var::make(data_type, "B", {gk, gj}, {256, 256})))});
+
+    // X[j][i] += X[j + 1][i - 1]: i inside would be stride 1, but the
+    // dependence with direction (<, >) forbids the interchange
+    Expr xi = index("i", 64), xj = index("j", 64);
+    Stmt skewed = LoopNest::make({xi, xj}, {move(Var::make(data_type, "X", {xj, xi}, {65, 65}),
+        Var::make(data_type, "X", {Binary::make(index_type, BinaryOpType::Add, xj, IntImm::make(index_type, 1)),
+            Binary::make(index_type, BinaryOpType::Sub, xi, IntImm::make(index_type, 1))}, {65, 65}))});
+    // without it the interchange happens
+    Stmt transposed = LoopNest::make({xi, xj}, {move(Var::make(data_type, "Y", {xj, xi}, {64, 64}),
+        Var::make(data_type, "X", {xj, xi}, {64, 64}))});
+
+    if (!check("grad_case4", grad, "kij") || !check("gemm", gemm, "ikj") || !check("skewed", skewed, "ij")
+        || !check("transposed", transposed, "ji")) {
+        return 1;
+    }
+
+    // the pass rebuilds the nest in that order, nested LoopNests included
+    LoopPermutation permutation;
+    Stmt split = LoopNest::make({k}, {LoopNest::make({j, i}, grad.as<LoopNest>()->body_list)});
+    std::string code = IRPrinter().print(permutation.mutate(split));
+    if (code.find("for(int k") > code.find("for(int i") || code.find("for(int i") > code.find("for(int j")) {
+        std::cout << "not reordered:\n" << code;
+        return 1;
+    }
+    std::cout << code;
+    std::cout << "Success!\n";
+    return 0;
+}
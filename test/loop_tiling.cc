@@ -0,0 +1,81 @@
+#include <string>
+#include <iostream>
+#include <vector>
+
+#include "IR.h"
+#include "IRPrinter.h"
+#include "LoopTiling.h"
+#include "interpreter.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+/**
+ * tiles the nest, checks the results and returns the code
+ */ 
+bool check(const std::string &what, const LoopTiling &tiling, const Stmt &before, std::string &code) {
+    LoopTiling pass = tiling;
+    Stmt after = pass.mutate(before);
+    code = IRPrinter().print(after);
+    Interpreter expected, actual;
+    expected.run(before);
+    actual.run(after);
+    if (expected.arrays != actual.arrays) {
+        std::cout << what << ": wrong results\n" << code;
+        return false;
+    }
+    return true;
+}
+
+
+int main() {
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+    auto index = [&](const std::string &name, int extent) {
+        return Index::make(index_type, name, Dom::make(index_type, 0, extent), IndexType::Spatial);
+    };
+    auto gemm = [&](int M, int N, int K) {
+        Expr i = index("i", M), j = index("j", N), k = index("k", K);
+        return LoopNest::make({i, k, j}, {Move::make(Var::make(data_type, "C", {i, j}, {size_t(M), size_t(N)}),
+            Binary::make(data_type, BinaryOpType::Mul, Var::make(data_type, "A", {i, k}, {size_t(M), size_t(K)}),
+                Var::make(data_type, "B", {k, j}, {size_t(K), size_t(N)})), MoveType::MemToMem)});
+    };
+
+    // 1K and 8K caches: a 70 x 50 x 40 gemm gets both levels, with remainders
+    LoopTiling small_caches(CostModel({CacheLevel{1, 1024, 64}, CacheLevel{2, 8192, 64}}));
+    Stmt big = gemm(70, 50, 40);
+    auto tilings = small_caches.choose(big.as<LoopNest>());
+    if (tilings.size() != 2 || tilings[0].cache_level != 2 || tilings[1].cache_level != 1) {
+        std::cout << tilings.size() << " tilings for the gemm\n";
+        return 1;
+    }
+    for (size_t l = 0; l < 3; ++l) {
+        std::cout << "loop " << l << ": L2 tile " << tilings[0].sizes[l] << ", L1 tile " << tilings[1].sizes[l] << "\n";
+        if (tilings[1].sizes[l] > tilings[0].sizes[l]) {
+            std::cout << "L1 tile larger than the L2 tile\n";
+            return 1;
+        }
+    }
+    std::string code;
+    if (!check("gemm", small_caches, big, code)) {
+        return 1;
+    }
+    if (code.find("if (") != std::string::npos || code.find("_L1") == std::string::npos
+        || code.find("_L2") == std::string::npos || code.find("_p") == std::string::npos) {
+        std::cout << "expected two levels of tiles and no guards:\n" << code;
+        return 1;
+    }
+
+    // data that fits the host's L1, and a copy with nothing to reuse, stay as they are
+    Expr i = index("i", 64), j = index("j", 64);
+    Stmt copy = LoopNest::make({i, j}, {Move::make(Var::make(data_type, "D", {i, j}, {64, 64}),
+        Var::make(data_type, "E", {i, j}, {64, 64}), MoveType::MemToMem)});
+    if (!LoopTiling().choose(gemm(16, 16, 16).as<LoopNest>()).empty() || !small_caches.choose(copy.as<LoopNest>()).empty()) {
+        std::cout << "tiled a nest that fits or has no reuse\n";
+        return 1;
+    }
+
+    std::cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <string>
+#include <iostream>
+
+#include "IR.h"
+#include "IRPrinter.h"
+#include "IREquality.h"
+#include "IRSerialize.h"
+#include "ReductionDetection.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+int main() {
+    const int M = 64;
+    const int N = 32;
+    const int K = 16;
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    // every index Spatial, as Parse builds them
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, M), IndexType::Spatial);
+    Expr j = Index::make(index_type, "j", Dom::make(index_type, 0, N), IndexType::Spatial);
+    Expr k = Index::make(index_type, "k", Dom::make(index_type, 0, K), IndexType::Spatial);
+
+    // C[i, j] = C[i, j] + A[i, k] * B[k, j]
+    Expr expr_A = Var::make(data_type, "A", {i, k}, {M, K});
+    Expr expr_B = Var::make(data_type, "B", {k, j}, {K, N});
+    Expr expr_C = Var::make(data_type, "C", {i, j}, {M, N});
+    Stmt gemm = Move::make(expr_C, Binary::make(data_type, BinaryOpType::Add, expr_C,
+        Binary::make(data_type, BinaryOpType::Mul, expr_A, expr_B)), MoveType::MemToMem);
+    // D[i, j] = C[i, j], nothing reduced
+    Expr expr_D = Var::make(data_type, "D", {i, j}, {M, N});
+    Stmt copy = LoopNest::make({i, j}, {Move::make(expr_D, expr_C, MoveType::MemToMem)});
+
+    Group kernel = Kernel::make("reduction", {expr_A, expr_B}, {expr_C, expr_D},
+        {LoopNest::make({i, j, k}, {gemm}), copy}, KernelType::CPU);
+    std::string before = IRPrinter().print(kernel);
+
+    ReductionDetection detection;
+    Group detected = detection.mutate(kernel);
+    auto op = detected.as<Kernel>();
+
+    auto nest = op->stmt_list[0].as<LoopNest>();
+    if (nest->index_list[0].as<Index>()->index_type != IndexType::Spatial
+        || nest->index_list[1].as<Index>()->index_type != IndexType::Spatial
+        || nest->index_list[2].as<Index>()->index_type != IndexType::Reduce) {
+        std::cout << "k should be the only reduce index!\n";
+        return 1;
+    }
+    auto reduce = nest->body_list[0].as<Reduce>();
+    if (reduce == nullptr || reduce->combiner != BinaryOpType::Add || reduce->axes.size() != 1
+        || reduce->axes[0].get() != nest->index_list[2].get()
+        || reduce->identity.as<FloatImm>() == nullptr || reduce->identity.as<FloatImm>()->value() != 0.0) {
+        std::cout << "the gemm statement should be a sum over k!\n";
+        return 1;
+    }
+    if (op->stmt_list[1].get() != copy.get()) {
+        std::cout << "a nest without reduction should be left alone!\n";
+        return 1;
+    }
+
+    // the printed code does not change, a Reduce round trips
+    std::string after = IRPrinter().print(detected);
+    if (after != before) {
+        std::cout << "printed code changed:\n" << after;
+        return 1;
+    }
+    std::string bytes = serialize_ir({detected});
+    std::vector<Group> loaded = deserialize_ir(bytes.data(), bytes.size());
+    if (!deep_equal(loaded[0], detected) || deep_equal(detected, kernel)) {
+        std::cout << "Reduce did not round trip through serialization!\n";
+        return 1;
+    }
+
+    // a local load under a reduce loop stays a Move, the accumulation is a sum over k
+    Expr a_reg = Var::make(data_type, "a", {}, {1});
+    Stmt load = Move::make(a_reg, expr_A, MoveType::MemToLocal);
+    Stmt update = Move::make(expr_C, Binary::make(data_type, BinaryOpType::Mul, a_reg, expr_B),
+        MoveType::MemToMem);
+    // for i { float x = A[i][0]; E = x; } assigns, nothing is reduced
+    Expr x = Var::make(data_type, "x", {}, {1});
+    Expr expr_E = Var::make(data_type, "E", {}, {1});
+    Expr first = Var::make(data_type, "A", {i, IntImm::make(index_type, 0)}, {M, K});
+    Stmt last = LoopNest::make({i}, {Move::make(x, first, MoveType::MemToLocal),
+        Move::make(expr_E, x, MoveType::LocalToMem)});
+    Group locals = Kernel::make("locals", {expr_A, expr_B}, {expr_C, expr_E},
+        {LoopNest::make({i, j, k}, {load, update}), last}, KernelType::CPU);
+    before = IRPrinter().print(locals);
+    auto local_op = ReductionDetection().mutate(locals).as<Kernel>();
+    nest = local_op->stmt_list[0].as<LoopNest>();
+    if (nest->index_list[2].as<Index>()->index_type != IndexType::Reduce
+        || nest->body_list[0].as<Move>() == nullptr || nest->body_list[1].as<Reduce>() == nullptr) {
+        std::cout << "a local load should stay a Move under the reduce loop k!\n";
+        return 1;
+    }
+    if (local_op->stmt_list[1].get() != last.get()) {
+        std::cout << "local moves should not be reduced!\n";
+        return 1;
+    }
+    if (IRPrinter().print(local_op) != before) {
+        std::cout << "printed code of local moves changed:\n" << IRPrinter().print(local_op);
+        return 1;
+    }
+
+    Stmt product = Reduce::make(expr_D, expr_A, BinaryOpType::Mul,
+        reduction_identity(data_type, BinaryOpType::Mul), {k});
+    std::cout << after << IRPrinter().print(product);
+    std::cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <string>
+#include <iostream>
+
+#include "IR.h"
+#include "IRPrinter.h"
+#include "ScalarReplacement.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+bool contains(const std::string &code, const std::string &line) {
+    if (code.find(line) == std::string::npos) {
+        std::cout << "missing \"" << line << "\" in:\n" << code;
+        return false;
+    }
+    return true;
+}
+
+
+int main() {
+    const int M = 16;
+    const int N = 32;
+    const int K = 8;
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, M), IndexType::Spatial);
+    Expr j = Index::make(index_type, "j", Dom::make(index_type, 0, N), IndexType::Spatial);
+    Expr k = Index::make(index_type, "k", Dom::make(index_type, 0, K), IndexType::Reduce);
+
+    // A[i, j] += alpha * B[i, k] * C[k, j] in i, j, k order
+    Expr expr_alpha = Var::make(data_type, "alpha", {}, {1});
+    Expr expr_A = Var::make(data_type, "A", {i, j}, {M, N});
+    Expr expr_B = Var::make(data_type, "B", {i, k}, {M, K});
+    Expr expr_C = Var::make(data_type, "C", {k, j}, {K, N});
+    Stmt gemm = Move::make(expr_A, Binary::make(data_type, BinaryOpType::Mul,
+        Binary::make(data_type, BinaryOpType::Mul, expr_alpha, expr_B), expr_C), MoveType::MemToMem);
+    // D[i, j] += B[i, k] + D[i, k] in i, k, j order: D is read at other elements,
+    // only B[i, k] can move out of the j loop
+    Expr expr_D = Var::make(data_type, "D", {i, j}, {M, N});
+    Expr expr_D_ik = Var::make(data_type, "D", {i, k}, {M, N});
+    Stmt update = Move::make(expr_D, Binary::make(data_type, BinaryOpType::Add, expr_B, expr_D_ik),
+        MoveType::MemToMem);
+
+    Group kernel = Kernel::make("scalars", {expr_alpha, expr_B, expr_C}, {expr_A, expr_D},
+        {LoopNest::make({i, j, k}, {gemm}), LoopNest::make({i, k, j}, {update})}, KernelType::CPU);
+    ScalarReplacement replacement;
+    Group replaced = replacement.mutate(kernel);
+    std::string code = IRPrinter().print(replaced);
+
+    if (!contains(code, "float A_acc = A[i][j];") || !contains(code, "float alpha_val = alpha;")
+        || !contains(code, "A_acc += alpha_val * B[i][k] * C[k][j];") || !contains(code, "A[i][j] = A_acc;")
+        || !contains(code, "float B_val = B[i][k];") || !contains(code, "D[i][j] += B_val + D[i][k];")) {
+        return 1;
+    }
+    if (code.find("D_acc") != std::string::npos) {
+        std::cout << "D is read at other elements, it can't be an accumulator:\n" << code;
+        return 1;
+    }
+    // the accumulator is stored after the k loop, inside the j loop
+    auto nest = replaced.as<Kernel>()->stmt_list[0].as<LoopNest>();
+    if (nest->index_list.size() != 2 || nest->body_list.size() != 4
+        || nest->body_list[2].as<LoopNest>()->index_list.size() != 1) {
+        std::cout << "wrong loop structure:\n" << code;
+        return 1;
+    }
+    // running it again changes nothing
+    std::string again = IRPrinter().print(replacement.mutate(replaced));
+    if (again != code) {
+        std::cout << "not idempotent:\n" << again;
+        return 1;
+    }
+
+    // the same nest twice, as hash-consing shares identical statements,
+    // declares its locals apart in each copy
+    Expr expr_s = Var::make(data_type, "s", {}, {1});
+    Expr expr_E = Var::make(data_type, "E", {k}, {K});
+    Stmt sum = LoopNest::make({k}, {Move::make(expr_s, expr_E, MoveType::MemToMem)});
+    Group twice = Kernel::make("twice", {expr_E}, {expr_s}, {sum, sum}, KernelType::CPU);
+    std::string shared = IRPrinter().print(ScalarReplacement().mutate(twice));
+    if (!contains(shared, "float s_acc = s;") || !contains(shared, "float s_acc1 = s;")) {
+        return 1;
+    }
+
+    std::cout << code;
+    std::cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <string>
+#include <iostream>
+#include <vector>
+
+#include "IR.h"
+#include "IRPrinter.h"
+#include "GuardElimination.h"
+#include "Schedule.h"
+#include "interpreter.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+bool contains(const std::string &code, const std::string &line) {
+    if (code.find(line) == std::string::npos) {
+        std::cout << "missing \"" << line << "\" in:\n" << code;
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * the scheduled kernel computes what the original one does
+ */ 
+bool same_results(const std::string &what, const Group &before, const Group &after) {
+    Interpreter expected, actual;
+    for (auto &stmt : before.as<Kernel>()->stmt_list) {
+        expected.run(stmt);
+    }
+    for (auto &stmt : after.as<Kernel>()->stmt_list) {
+        actual.run(stmt);
+    }
+    std::string code = IRPrinter().print(after);
+    if (expected.arrays != actual.arrays) {
+        std::cout << what << ": wrong results\n" << code;
+        return false;
+    }
+    std::cout << what << ":\n" << code;
+    return true;
+}
+
+
+int main() {
+    const int M = 10;
+    const int N = 12;
+    const int K = 6;
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+    auto index = [&](const std::string &name, int extent) {
+        return Index::make(index_type, name, Dom::make(index_type, 0, extent), IndexType::Spatial);
+    };
+    auto mul = [&](const Expr &a, const Expr &b) {
+        return Binary::make(data_type, BinaryOpType::Mul, a, b);
+    };
+
+    // C[i][j] += A[i][k] * B[k][j], tiled 4 x 8 with tails in both
+    Expr i = index("i", M), j = index("j", N), k = index("k", K);
+    Expr expr_A = Var::make(data_type, "A", {i, k}, {M, K});
+    Expr expr_B = Var::make(data_type, "B", {k, j}, {K, N});
+    Expr expr_C = Var::make(data_type, "C", {i, j}, {M, N});
+    Group gemm = Kernel::make("gemm", {expr_A, expr_B}, {expr_C},
+        {LoopNest::make({i, j, k}, {Move::make(expr_C, mul(expr_A, expr_B), MoveType::MemToMem)})},
+        KernelType::CPU);
+    Schedule tiled(gemm);
+    tiled.tile("i", "j", "i_o", "j_o", "i_i", "j_i", 4, 8).reorder({"k", "i_i", "j_i"}).vectorize("j_i").parallel("i_o");
+    std::string code = IRPrinter().print(tiled.kernel());
+    if (!same_results("tiled gemm", gemm, tiled.kernel()) || !contains(code, "#pragma omp parallel for")
+        || !contains(code, "#pragma GCC ivdep") || !contains(code, "C[i_o * 4 + i_i][j_o * 8 + j_i]")
+        || !contains(code, "if (i_o * 4 + i_i < 10 && j_o * 8 + j_i < 12)")) {
+        return 1;
+    }
+    // the guards become remainder loops
+    GuardElimination guards;
+    Group peeled = guards.mutate(tiled.kernel());
+    if (!same_results("peeled", gemm, peeled)) {
+        return 1;
+    }
+    if (IRPrinter().print(peeled).find("if (") != std::string::npos) {
+        std::cout << "guards left\n";
+        return 1;
+    }
+
+    // E[i][j] += A[i][j] over one fused loop, split by 4 and unrolled
+    Expr i2 = index("i", 3), j2 = index("j", 4);
+    Expr expr_E = Var::make(data_type, "E", {i2, j2}, {3, 4});
+    Group copy = Kernel::make("copy", {}, {expr_E},
+        {LoopNest::make({i2, j2}, {Move::make(expr_E, Var::make(data_type, "A", {i2, j2}, {3, 4}),
+            MoveType::MemToMem)})}, KernelType::CPU);
+    Schedule fused(copy);
+    fused.fuse("i", "j", "ij").split("ij", 4, "ij_o", "ij_i").unroll("ij_i");
+    code = IRPrinter().print(fused.kernel());
+    if (!same_results("fused", copy, fused.kernel()) || !contains(code, "E[(ij_o * 4 + 3) / 4][(ij_o * 4 + 3) % 4] += A[(ij_o * 4 + 3) / 4][(ij_o * 4 + 3) % 4];")) {
+        return 1;
+    }
+
+    // T[i][j] += 2 * A[i][j]; D[i][j] += T[i][j] * B[j][i], T computed inside the i loop of D
+    Expr i3 = index("i", 4), j3 = index("j", 5), ti = index("ti", 4), tj = index("tj", 5);
+    Expr expr_T = Var::make(data_type, "T", {ti, tj}, {4, 5});
+    Stmt produce = LoopNest::make({ti, tj}, {Move::make(expr_T,
+        mul(FloatImm::make(data_type, 2.0), Var::make(data_type, "A", {ti, tj}, {4, 5})), MoveType::MemToMem)});
+    Expr expr_D = Var::make(data_type, "D", {i3, j3}, {4, 5});
+    Stmt consume = LoopNest::make({i3, j3}, {Move::make(expr_D,
+        mul(Var::make(data_type, "T", {i3, j3}, {4, 5}), Var::make(data_type, "B", {j3, i3}, {5, 4})),
+        MoveType::MemToMem)});
+    Group pipeline = Kernel::make("pipeline", {}, {expr_D}, {produce, consume}, KernelType::CPU);
+    Schedule inlined(pipeline);
+    inlined.compute_at("T", "i");
+    auto kernel = inlined.kernel().as<Kernel>();
+    if (!same_results("compute_at", pipeline, inlined.kernel()) || kernel->stmt_list.size() != 1
+        || !contains(IRPrinter().print(inlined.kernel()), "T[i][tj] += 2 * A[i][tj];")) {
+        return 1;
+    }
+
+    std::cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <iostream>
+
+#include "IR.h"
+#include "IRPrinter.h"
+#include "Simplifier.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+bool expect(Simplifier &simplifier, const Expr &e, const std::string &expected) {
+    std::string before = IRPrinter().print(e);
+    std::string after = IRPrinter().print(simplifier.simplify(e));
+    if (after != expected) {
+        std::cout << before << " simplified to " << after << ", expected " << expected << "\n";
+        return false;
+    }
+    return true;
+}
+
+
+int main() {
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+    Expr i = Index::make(index_type, "i", Dom::make(index_type, 0, 64), IndexType::Spatial);
+    Expr j = Index::make(index_type, "j", Dom::make(index_type, 0, 64), IndexType::Spatial);
+    Expr x = Var::make(data_type, "x", {i}, {64});
+    Expr y = Var::make(data_type, "y", {j}, {64});
+    auto bin = [](Type t, BinaryOpType op, Expr a, Expr b, bool bracket = false) {
+        return Binary::make(t, op, a, b, bracket);
+    };
+    auto add = [&](Expr a, Expr b) { return bin(index_type, BinaryOpType::Add, a, b); };
+    auto sub = [&](Expr a, Expr b) { return bin(index_type, BinaryOpType::Sub, a, b); };
+    auto mul = [&](Expr a, Expr b) { return bin(index_type, BinaryOpType::Mul, a, b); };
+    auto fadd = [&](Expr a, Expr b) { return bin(data_type, BinaryOpType::Add, a, b); };
+    auto fmul = [&](Expr a, Expr b) { return bin(data_type, BinaryOpType::Mul, a, b); };
+    Expr f0 = FloatImm::make(data_type, 0.0);
+    Expr f1 = FloatImm::make(data_type, 1.0);
+
+    Simplifier simplifier;
+    bool ok = true;
+    // constant folding with C semantics
+    ok = ok && expect(simplifier, add(2, mul(3, 4)), "14");
+    ok = ok && expect(simplifier, bin(index_type, BinaryOpType::Div, 7, 2), "3");
+    ok = ok && expect(simplifier, bin(index_type, BinaryOpType::Mod, -7, 3), "-1");
+    // folds that overflow the type stay for the C compiler
+    Expr int_max = IntImm::make(index_type, 2147483647);
+    Expr int_min = IntImm::make(index_type, -2147483647 - 1);
+    ok = ok && expect(simplifier, add(int_max, 1), "2147483647 + 1");
+    ok = ok && expect(simplifier, mul(65536, 65536), "65536 * 65536");
+    ok = ok && expect(simplifier, Unary::make(index_type, UnaryOpType::Neg, int_min), "--2147483648");
+    ok = ok && expect(simplifier, add(i, int_min), "i + -2147483648");
+    Type long_type = Type::int_scalar(64);
+    Expr long_min = IntImm::make(long_type, INT64_MIN);
+    ok = ok && expect(simplifier, bin(long_type, BinaryOpType::Div, long_min, IntImm::make(long_type, -1)),
+        "-9223372036854775808 / -1");
+    ok = ok && expect(simplifier, fmul(FloatImm::make(data_type, 1.5), FloatImm::make(data_type, 0.5)), "0.75");
+    // 1.0 / 3.0 would not print back exactly
+    ok = ok && expect(simplifier, bin(data_type, BinaryOpType::Div, f1, FloatImm::make(data_type, 3.0)), "1 / 3");
+    // integer identities and constant chains
+    ok = ok && expect(simplifier, mul(add(i, 0), 1), "i");
+    ok = ok && expect(simplifier, add(add(i, 2), 3), "i + 5");
+    ok = ok && expect(simplifier, add(sub(i, 3), 1), "i - 2");
+    ok = ok && expect(simplifier, mul(mul(i, 2), 4), "i * 8");
+    ok = ok && expect(simplifier, bin(index_type, BinaryOpType::Div, mul(i, 16), 16), "i");
+    ok = ok && expect(simplifier, bin(index_type, BinaryOpType::Mod, mul(i, 16), 16), "0");
+    ok = ok && expect(simplifier, sub(add(i, j), add(i, j)), "0");
+    ok = ok && expect(simplifier, mul(j, mul(i, 0)), "0");
+    // canonical operand order
+    ok = ok && expect(simplifier, add(mul(2, j), i), "j * 2 + i");
+    ok = ok && expect(simplifier, add(i, add(j, 1)), "j + 1 + i");
+    ok = ok && expect(simplifier, fmul(y, x), "x[i] * y[j]");
+    // exact float rules only
+    ok = ok && expect(simplifier, fmul(x, f1), "x[i]");
+    ok = ok && expect(simplifier, fadd(x, f0), "x[i] + 0");
+    ok = ok && expect(simplifier, fadd(fadd(x, FloatImm::make(data_type, 1.25)), FloatImm::make(data_type, 2.0)),
+        "x[i] + 1.25 + 2");
+    Simplifier fast(true);
+    ok = ok && expect(fast, fadd(x, f0), "x[i]");
+    ok = ok && expect(fast, fadd(fadd(x, FloatImm::make(data_type, 1.25)), FloatImm::make(data_type, 2.0)),
+        "x[i] + 3.25");
+    // parentheses from precedence, not from the parser
+    ok = ok && expect(simplifier, fmul(fadd(x, y), x), "(x[i] + y[j]) * x[i]");
+    ok = ok && expect(simplifier, bin(data_type, BinaryOpType::Sub, x, bin(data_type, BinaryOpType::Mul, x, y, true)),
+        "x[i] - x[i] * y[j]");
+    ok = ok && expect(simplifier, bin(data_type, BinaryOpType::Sub, x, fadd(x, y)), "x[i] - (x[i] + y[j])");
+    if (!ok) {
+        return 1;
+    }
+
+    // a shared DAG of depth 64 has 2^64 paths, each node is simplified once
+    Expr e = i;
+    for (int level = 0; level < 64; ++level) {
+        e = add(mul(e, 1), sub(e, e));
+    }
+    auto start = std::chrono::steady_clock::now();
+    Expr simplified = simplifier.simplify(e);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    if (simplified.get() != i.get()) {
+        std::cout << "deep DAG did not simplify to i\n";
+        return 1;
+    }
+    std::cout << "depth 64 DAG: " << elapsed.count() << " ms\n";
+
+    std::cout << "Success!\n";
+    return 0;
+}
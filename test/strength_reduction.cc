@@ -0,0 +1,128 @@
+#include <string>
+#include <iostream>
+#include <vector>
+
+#include "IR.h"
+#include "IREquality.h"
+#include "IRPrinter.h"
+#include "IRVisitor.h"
+#include "StrengthReduction.h"
+#include "interpreter.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+/**
+ * counts the integer multiplications, divisions and remainders
+ * in innermost loop bodies
+ */ 
+class InnerArithmetic : public IRVisitor {
+ public:
+    int count = 0;
+
+    void visit(Ref<const LoopNest> op) override {
+        bool innermost = true;
+        for (auto &body : op->body_list) {
+            innermost = innermost && body.as<LoopNest>() == nullptr;
+        }
+        inside = innermost && !op->index_list.empty();
+        IRVisitor::visit(op);
+        inside = false;
+    }
+
+    void visit(Ref<const Binary> op) override {
+        if (inside && op->type().is_int() && op->op_type != BinaryOpType::Add && op->op_type != BinaryOpType::Sub) {
+            ++count;
+        }
+        IRVisitor::visit(op);
+    }
+
+ private:
+    bool inside = false;
+};
+
+
+bool check(const std::string &what, const Stmt &before, bool reduced) {
+    Group kernel = Kernel::make(what, {}, {}, {before}, KernelType::CPU);
+    StrengthReduction pass;
+    Group after = pass.mutate(kernel);
+    Stmt stmt = after.as<Kernel>()->stmt_list[0];
+    std::string code = IRPrinter().print(stmt);
+    Interpreter expected, actual;
+    expected.run(before);
+    actual.run(stmt);
+    InnerArithmetic arithmetic;
+    stmt.visit_stmt(&arithmetic);
+    bool changed = !deep_equal(stmt, before);
+    if (expected.arrays != actual.arrays || (reduced && arithmetic.count != 0) || changed != reduced) {
+        std::cout << what << ": " << (expected.arrays != actual.arrays ? "wrong results, " : "")
+                  << arithmetic.count << " multiplications left\n" << code;
+        return false;
+    }
+    std::cout << what << ":\n" << code;
+    return true;
+}
+
+
+int main() {
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+    auto index = [&](const std::string &name, int begin, int extent) {
+        return Index::make(index_type, name, Dom::make(index_type, begin, extent), IndexType::Spatial);
+    };
+    auto binary = [&](BinaryOpType op, const Expr &a, const Expr &b) {
+        return Binary::make(index_type, op, a, b);
+    };
+    auto c = [&](int value) {
+        return Expr(IntImm::make(index_type, value));
+    };
+
+    // B[i] += A[i / 16][i % 16]
+    Expr i = index("i", 0, 64);
+    Stmt split = LoopNest::make({i}, {Move::make(Var::make(data_type, "B", {i}, {64}),
+        Var::make(data_type, "A", {binary(BinaryOpType::Div, i, c(16)), binary(BinaryOpType::Mod, i, c(16))}, {4, 16}),
+        MoveType::MemToMem)});
+
+    // O[n][k][p][q] += I[n][c][p + r][q + s] * W[k][c][r][s]
+    Expr n = index("n", 0, 2), k = index("k", 0, 3), p = index("p", 0, 4), q = index("q", 0, 4);
+    Expr ch = index("c", 0, 2), r = index("r", 0, 3), s = index("s", 0, 3);
+    Stmt conv = LoopNest::make({n, k, p, q, ch, r, s}, {Move::make(
+        Var::make(data_type, "O", {n, k, p, q}, {2, 3, 4, 4}),
+        Binary::make(data_type, BinaryOpType::Mul,
+            Var::make(data_type, "I", {n, ch, binary(BinaryOpType::Add, p, r), binary(BinaryOpType::Add, q, s)},
+                {2, 2, 6, 6}),
+            Var::make(data_type, "W", {k, ch, r, s}, {3, 2, 3, 3})), MoveType::MemToMem)});
+
+    // C[2 * i + j - 1] += A[i][j], i from 1
+    Expr i1 = index("i", 1, 5), j = index("j", 0, 2);
+    Stmt linear = LoopNest::make({i1, j}, {Move::make(
+        Var::make(data_type, "C", {binary(BinaryOpType::Sub,
+            binary(BinaryOpType::Add, binary(BinaryOpType::Mul, c(2), i1), j), c(1))}, {12}),
+        Var::make(data_type, "A", {i1, j}, {6, 2}), MoveType::MemToMem)});
+
+    // B[i][j] += A[(8 * i + j) / 4][(8 * i + j) % 4] with j alone in the inner nest
+    Expr i2 = index("i", 0, 3), j2 = index("j", 0, 8);
+    Expr flat = binary(BinaryOpType::Add, binary(BinaryOpType::Mul, c(8), i2), j2);
+    Stmt outer = LoopNest::make({i2}, {LoopNest::make({j2}, {Move::make(
+        Var::make(data_type, "B", {i2, j2}, {3, 8}),
+        Var::make(data_type, "A", {binary(BinaryOpType::Div, flat, c(4)), binary(BinaryOpType::Mod, flat, c(4))},
+            {6, 4}), MoveType::MemToMem)})});
+
+    // a step larger than the divisor: D[i] += A[(5 * i) / 3]
+    Expr i3 = index("i", 0, 9);
+    Stmt coarse = LoopNest::make({i3}, {Move::make(Var::make(data_type, "D", {i3}, {9}),
+        Var::make(data_type, "A", {binary(BinaryOpType::Div, binary(BinaryOpType::Mul, c(5), i3), c(3))}, {15}),
+        MoveType::MemToMem)});
+
+    // nothing to reduce: A[i][j] and A[i + 1][j]
+    Stmt plain = LoopNest::make({i2, j2}, {Move::make(Var::make(data_type, "E", {i2, j2}, {3, 8}),
+        Var::make(data_type, "A", {binary(BinaryOpType::Add, i2, c(1)), j2}, {4, 8}), MoveType::MemToMem)});
+
+    if (!check("split", split, true) || !check("conv", conv, true) || !check("linear", linear, true)
+        || !check("outer", outer, true) || !check("coarse", coarse, true) || !check("plain", plain, false)) {
+        return 1;
+    }
+    std::cout << "Success!\n";
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <string>
+#include <iostream>
+#include <vector>
+
+#include "IR.h"
+#include "IREquality.h"
+#include "IRPrinter.h"
+#include "IRVisitor.h"
+#include "UnrollAndJam.h"
+#include "interpreter.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+/**
+ * counts the memory accesses of the updates in innermost loop bodies,
+ * and their loads into locals
+ */ 
+class InnerAccesses : public IRVisitor {
+ public:
+    int accesses = 0;
+    int loads = 0;
+
+    void visit(Ref<const LoopNest> op) override {
+        bool innermost = !op->index_list.empty();
+        for (auto &body : op->body_list) {
+            innermost = innermost && body.as<LoopNest>() == nullptr;
+        }
+        if (!innermost) {
+            IRVisitor::visit(op);
+            return;
+        }
+        for (auto &body : op->body_list) {
+            auto move = body.as<Move>();
+            if (move != nullptr && move->move_type == MoveType::MemToLocal) {
+                ++loads;
+            } else {
+                inside = true;
+                body.visit_stmt(this);
+                inside = false;
+            }
+        }
+    }
+
+    void visit(Ref<const Var> op) override {
+        if (inside && !op->args.empty()) {
+            ++accesses;
+        }
+        IRVisitor::visit(op);
+    }
+
+ private:
+    bool inside = false;
+};
+
+
+/**
+ * finds loops with a single iteration
+ */ 
+class SingleTrips : public IRVisitor {
+ public:
+    bool found = false;
+
+    void visit(Ref<const Index> op) override {
+        auto extent = op->dom.as<Dom>()->extent.as<IntImm>();
+        found = found || (extent != nullptr && extent->value() == 1);
+    }
+};
+
+
+/**
+ * runs the pass with the given registers; tile_size is the expected
+ * MR x NR, 0 when the nest must be left alone
+ */ 
+bool check(const std::string &what, const Stmt &before, int registers, int64_t tile_size, int loads) {
+    UnrollAndJam pass(registers);
+    UnrollAndJam::Tile tile;
+    bool chosen = pass.choose(before.as<LoopNest>(), tile);
+    Group kernel = Kernel::make(what, {}, {}, {before}, KernelType::CPU);
+    Stmt stmt = pass.mutate(kernel).as<Kernel>()->stmt_list[0];
+    std::string code = IRPrinter().print(stmt);
+    Interpreter expected(7), actual(7);
+    expected.run(before);
+    actual.run(stmt);
+    if (tile_size == 0) {
+        if (chosen || !deep_equal(stmt, before)) {
+            std::cout << what << ": should not change\n" << code;
+            return false;
+        }
+        std::cout << what << ": unchanged\n";
+        return true;
+    }
+    // the first nest is the register tile, the others are remainders;
+    // a tile without outer loops is a block itself
+    Stmt main = stmt;
+    auto split = stmt.as<LoopNest>();
+    while (split != nullptr && split->index_list.empty() && split->body_list[0].as<LoopNest>() != nullptr) {
+        main = split->body_list[0];
+        split = main.as<LoopNest>();
+    }
+    InnerAccesses inner;
+    main.visit_stmt(&inner);
+    SingleTrips trips;
+    stmt.visit_stmt(&trips);
+    if (expected.arrays != actual.arrays || !chosen || tile.mr * tile.nr != tile_size
+        || inner.accesses != 0 || inner.loads != loads || trips.found) {
+        std::cout << what << ": " << (expected.arrays != actual.arrays ? "wrong results, " : "")
+                  << (trips.found ? "single iteration loops, " : "")
+                  << "tile " << tile.mr << " x " << tile.nr << ", " << inner.accesses << " accesses and "
+                  << inner.loads << " loads in the updates\n" << code;
+        return false;
+    }
+    std::cout << what << ": " << tile.mr << " x " << tile.nr << "\n" << code;
+    return true;
+}
+
+
+int main() {
+    Type index_type = Type::int_scalar(32);
+    Type data_type = Type::float_scalar(32);
+    auto loop = [&](const std::string &name, int begin, int extent, IndexType type) {
+        return Index::make(index_type, name, Dom::make(index_type, begin, extent), type);
+    };
+    Expr i = loop("i", 0, 7, IndexType::Spatial);
+    Expr j = loop("j", 1, 10, IndexType::Spatial);
+    Expr k = loop("k", 0, 6, IndexType::Reduce);
+    Expr a = Var::make(data_type, "A", {i, k}, {7, 6});
+    Expr b = Var::make(data_type, "B", {k, Binary::make(index_type, BinaryOpType::Sub, j, IntImm::make(index_type, 1))},
+        {6, 10});
+    Expr c = Var::make(data_type, "C", {i, j}, {7, 11});
+    Expr product = Binary::make(data_type, BinaryOpType::Mul, a, b);
+    Stmt gemm = LoopNest::make({i, k, j}, {Move::make(c, product, MoveType::MemToMem)});
+
+    Expr x = Var::make(data_type, "x", {k}, {6});
+    Expr y = Var::make(data_type, "y", {i}, {7});
+    Expr matvec_value = Binary::make(data_type, BinaryOpType::Mul, Var::make(data_type, "A", {i, k}, {7, 6}), x);
+    Stmt matvec = LoopNest::make({i, k}, {Reduce::make(y, matvec_value, BinaryOpType::Add,
+        FloatImm::make(data_type, 0), {k})});
+
+    Expr add = Binary::make(data_type, BinaryOpType::Add, a, Var::make(data_type, "D", {i, k}, {7, 6}));
+    Stmt elementwise = LoopNest::make({i, k}, {Move::make(Var::make(data_type, "E", {i, k}, {7, 6}), add,
+        MoveType::MemToMem)});
+
+    Expr z = Var::make(data_type, "z", {i}, {7});
+    Stmt reads_dst = LoopNest::make({i, k}, {Move::make(z, Binary::make(data_type, BinaryOpType::Mul, z, x),
+        MoveType::MemToMem)});
+
+    // 4 rows: a 4 x 2 tile covers i in one step and leaves no remainder
+    Expr i4 = loop("i", 0, 4, IndexType::Spatial);
+    Expr a4 = Var::make(data_type, "A", {i4, k}, {4, 6});
+    Expr c4 = Var::make(data_type, "C", {i4, j}, {4, 11});
+    Stmt rows = LoopNest::make({i4, k, j}, {Move::make(c4, Binary::make(data_type, BinaryOpType::Mul, a4, b),
+        MoveType::MemToMem)});
+
+    bool ok = true;
+    // 7 x 1 accumulators and 7 + 1 loads per k, k unrolled by 2: a 3 x 3 tile
+    // loads less per update but leaves a row and a column to the remainder
+    ok = check("gemm, 16 registers", gemm, 16, 7, 16) && ok;
+    ok = check("gemm, 32 registers", gemm, 32, 14, 18) && ok;
+    ok = check("4 rows", rows, 16, 8, 12) && ok;
+    // 7 accumulators, 7 rows of A and one x per k
+    ok = check("matrix vector product", matvec, 16, 7, 16) && ok;
+    ok = check("elementwise", elementwise, 16, 0, 0) && ok;
+    ok = check("reads its destination", reads_dst, 16, 0, 0) && ok;
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Success!\n";
+    return 0;
+}
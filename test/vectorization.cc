@@ -0,0 +1,152 @@
+#include <string>
+#include <iostream>
+#include <vector>
+
+#include "IR.h"
+#include "IREquality.h"
+#include "IRPrinter.h"
+#include "IRVisitor.h"
+#include "Vectorization.h"
+#include "interpreter.h"
+#include "type.h"
+
+using namespace Boost::Internal;
+
+
+/**
+ * counts the stores of scalar and of vector values
+ */ 
+class Stores : public IRVisitor {
+ public:
+    int scalar = 0;
+    int vector = 0;
+
+    void visit(Ref<const Move> op) override {
+        if (op->move_type != MoveType::MemToLocal) {
+            ++(op->dst->type().lanes() > 1 ? vector : scalar);
+        }
+        IRVisitor::visit(op);
+    }
+};
+
+
+/**
+ * runs the pass on a kernel of one statement; lanes is the expected
+ * vector width, 0 when the statement must be left alone
+ */ 
+bool check(const std::string &what, const Stmt &before, int vector_bytes, int lanes, int tail,
+    const std::vector<std::string> &printed) {
+    Vectorization pass(vector_bytes);
+    Group kernel = Kernel::make(what, {}, {}, {before}, KernelType::CPU);
+    Group after = pass.mutate(kernel);
+    Stmt stmt = after.as<Kernel>()->stmt_list[0];
+    std::string code = IRPrinter().print(after);
+    // the nest of the innermost loop
+    auto nest = before.as<LoopNest>();
+    std::vector<Expr> enclosing;
+    while (nest->body_list.back().as<LoopNest>() != nullptr) {
+        enclosing.insert(enclosing.end(), nest->index_list.begin(), nest->index_list.end());
+        nest = nest->body_list.back().as<LoopNest>();
+    }
+    int chosen = pass.choose(nest, enclosing);
+    if (lanes == 0) {
+        if (chosen != 0 || !deep_equal(stmt, before)) {
+            std::cout << what << ": should not change\n" << code;
+            return false;
+        }
+        std::cout << what << ": unchanged\n";
+        return true;
+    }
+    Interpreter expected(11), actual(11);
+    expected.run(before);
+    actual.run(stmt);
+    Stores stores;
+    stmt.visit_stmt(&stores);
+    bool ok = expected.arrays == actual.arrays && chosen == lanes && stores.scalar == tail && stores.vector > 0;
+    for (auto &text : printed) {
+        if (code.find(text) == std::string::npos) {
+            std::cout << "missing " << text << "\n";
+            ok = false;
+        }
+    }
+    if (!ok) {
+        std::cout << what << ": " << (expected.arrays != actual.arrays ? "wrong results, " : "")
+                  << chosen << " lanes, " << stores.scalar << " scalar stores\n" << code;
+        return false;
+    }
+    std::cout << what << ": " << chosen << " lanes\n" << code;
+    return true;
+}
+
+
+int main() {
+    Type index_type = Type::int_scalar(32);
+    Type int_type = Type::int_scalar(32);
+    Type float_type = Type::float_scalar(32);
+    auto loop = [&](const std::string &name, int begin, int extent) {
+        return Index::make(index_type, name, Dom::make(index_type, begin, extent), IndexType::Spatial);
+    };
+    auto binary = [](BinaryOpType op, const Expr &a, const Expr &b) {
+        return Binary::make(a->type(), op, a, b);
+    };
+    Expr i = loop("i", 0, 16);
+    Expr j = loop("j", 0, 32);
+
+    // kernel_case3: A = B + C on ints
+    Expr sum = binary(BinaryOpType::Add, Var::make(int_type, "B", {i, j}, {16, 32}),
+        Var::make(int_type, "C", {i, j}, {16, 32}));
+    Stmt add = LoopNest::make({i, j}, {Move::make(Var::make(int_type, "A", {i, j}, {16, 32}), sum,
+        MoveType::MemToMem)});
+
+    // grad_case1 on a loop whose extent is not a multiple of the lanes
+    Expr jt = loop("j", 1, 15);
+    Expr product = binary(BinaryOpType::Mul, Var::make(float_type, "B", {i, jt}, {16, 16}),
+        Var::make(float_type, "dC", {i, jt}, {16, 16}));
+    Stmt grad = LoopNest::make({i, jt}, {Move::make(Var::make(float_type, "dA", {i, jt}, {16, 16}), product,
+        MoveType::MemToMem)});
+
+    // gemm after scalar replacement, A_val is broadcast
+    Expr k = loop("k", 0, 8);
+    Expr a_val = Var::make(float_type, "A_val", {}, {1});
+    Expr scaled = binary(BinaryOpType::Mul, a_val, Var::make(float_type, "B", {k, j}, {8, 32}));
+    Stmt gemm = LoopNest::make({i, k}, {Move::make(a_val, Var::make(float_type, "A", {i, k}, {16, 8}),
+        MoveType::MemToLocal), LoopNest::make({j}, {Move::make(Var::make(float_type, "C", {i, j}, {16, 32}),
+        scaled, MoveType::MemToMem)})});
+
+    Stmt transposed = LoopNest::make({i, j}, {Move::make(Var::make(int_type, "A", {i, j}, {16, 32}),
+        Var::make(int_type, "T", {j, i}, {32, 16}), MoveType::MemToMem)});
+    Expr previous = binary(BinaryOpType::Sub, jt, IntImm::make(index_type, 1));
+    Stmt recurrence = LoopNest::make({i, jt}, {Move::make(Var::make(float_type, "S", {i, jt}, {16, 16}),
+        Var::make(float_type, "S", {i, previous}, {16, 16}), MoveType::MemToMem)});
+    Stmt row_sum = LoopNest::make({i, j}, {Move::make(Var::make(int_type, "R", {i}, {16}),
+        Var::make(int_type, "B", {i, j}, {16, 32}), MoveType::MemToMem)});
+
+    // marked by a Schedule but not vectorized, the mark must go
+    Expr jm = Index::make(index_type, "j", Dom::make(index_type, 1, 15), IndexType::Vectorized);
+    Stmt marked = LoopNest::make({i, jm}, {Move::make(Var::make(float_type, "S", {i, jm}, {16, 16}),
+        Var::make(float_type, "S", {i, binary(BinaryOpType::Sub, jm, IntImm::make(index_type, 1))}, {16, 16}),
+        MoveType::MemToMem)});
+    std::string unmarked = IRPrinter().print(Vectorization(16).mutate(
+        Kernel::make("marked", {}, {}, {marked}, KernelType::CPU)));
+
+    bool ok = true;
+    if (unmarked.find("ivdep") != std::string::npos) {
+        std::cout << "the recurrence keeps its Vectorized mark\n" << unmarked;
+        ok = false;
+    }
+    ok = check("kernel_case3", add, 16, 4, 0,
+        {"typedef int intx4", "store_intx4(&A[i][j_v * 4], load_intx4(&A[i][j_v * 4]) + (load_intx4"}) && ok;
+    ok = check("kernel_case3, 32 byte vectors", add, 32, 8, 0, {"load_intx8(&B[i][j_v * 8])"}) && ok;
+    ok = check("grad_case1, peeled tail", grad, 16, 4, 1,
+        {"for(int j_v = 0; j_v < 3; ++j_v)", "for(int j = 13; j < 16; ++j)"}) && ok;
+    ok = check("gemm, broadcast", gemm, 16, 4, 0,
+        {"broadcast_floatx4(A_val) * load_floatx4(&B[k][j_v * 4])"}) && ok;
+    ok = check("transposed", transposed, 16, 0, 0, {}) && ok;
+    ok = check("recurrence", recurrence, 16, 0, 0, {}) && ok;
+    ok = check("row sum", row_sum, 16, 0, 0, {}) && ok;
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Success!\n";
+    return 0;
+}